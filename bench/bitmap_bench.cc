@@ -0,0 +1,202 @@
+// Microbenchmarks of utils::Bitmap, compared with the previous implementation
+// (32-bit words, bounds-checked access, bit-by-bit cnt()).
+// usage: bitmap_bench [max_bits]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+#include "bitmap.h"
+
+using compiler::utils::Bitmap;
+
+namespace
+{
+
+// The previous Bitmap implementation, kept here as the baseline.
+class LegacyBitmap
+{
+  protected:
+	std::vector<uint32_t> _bits;
+	size_t _size;
+
+	inline static size_t _ceil_div32(size_t x) { return (x + 31) >> 5; }
+	inline static size_t _div32(size_t x) { return x >> 5; }
+	inline static int _remain_div32(size_t x) { return static_cast<int>(x & 31); }
+
+  public:
+	LegacyBitmap(int size): _bits(_ceil_div32(size), 0), _size(size) {}
+
+	inline size_t size() const { return _size; }
+	inline bool get(size_t idx) const
+		{ return (_bits.at(_div32(idx)) >> _remain_div32(idx)) & 1; }
+	inline void set(size_t idx)
+		{ _bits.at(_div32(idx)) |= 1 << _remain_div32(idx); }
+
+	void clear()
+	{
+		for(auto &data : _bits)
+			data = 0;
+	}
+	size_t cnt() const
+	{
+		size_t res = 0;
+		for(int i = 0; i < _size; i++)
+			res += get(i);
+		return res;
+	}
+	void union_with(const LegacyBitmap &other)
+	{
+		for(size_t i = 0; i < _bits.size(); i++)
+			_bits.at(i) |= other._bits.at(i);
+	}
+	void diff_with(const LegacyBitmap &other)
+	{
+		for(size_t i = 0; i < _bits.size(); i++)
+			_bits.at(i) &= ~(other._bits.at(i));
+	}
+};
+
+volatile size_t sink;
+
+// Runs func repeatedly for about 0.2s, returns the average ns per call.
+double time_ns(const std::function<void()> &func)
+{
+	using clock = std::chrono::steady_clock;
+	size_t reps = 1;
+	while(true)
+	{
+		auto start = clock::now();
+		for(size_t i = 0; i < reps; i++)
+			func();
+		double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+		if(ns > 2e8)
+			return ns / reps;
+		reps *= 2;
+	}
+}
+
+template<class BitmapType>
+BitmapType random_bitmap(int size, double density, std::mt19937 &rng)
+{
+	BitmapType res(size);
+	std::bernoulli_distribution dist(density);
+	for(int i = 0; i < size; i++)
+		if(dist(rng))
+			res.set(i);
+	return res;
+}
+
+void report(const char *name, int bits, double legacy_ns, double scalar_ns, double avx2_ns)
+{
+	std::printf("%-18s %8d %12.1f %12.1f", name, bits, legacy_ns, scalar_ns);
+	if(avx2_ns >= 0)
+		std::printf(" %12.1f %8.1fx\n", avx2_ns, legacy_ns / avx2_ns);
+	else
+		std::printf(" %12s %8.1fx\n", "n/a", legacy_ns / scalar_ns);
+}
+
+// Times func under each supported isa of Bitmap.
+void time_isas(const std::function<void()> &func, double &scalar_ns, double &avx2_ns)
+{
+	Bitmap::Isa prev_isa = Bitmap::isa();
+	Bitmap::set_isa(Bitmap::Isa::SCALAR);
+	scalar_ns = time_ns(func);
+	avx2_ns = -1;
+	if(Bitmap::isa_supported(Bitmap::Isa::AVX2))
+	{
+		Bitmap::set_isa(Bitmap::Isa::AVX2);
+		avx2_ns = time_ns(func);
+	}
+	Bitmap::set_isa(prev_isa);
+}
+
+void bench(int bits)
+{
+	std::mt19937 rng(bits);
+	double legacy_ns, scalar_ns, avx2_ns;
+
+	// cnt()
+	{
+		auto legacy = random_bitmap<LegacyBitmap>(bits, 0.3, rng);
+		auto bitmap = random_bitmap<Bitmap>(bits, 0.3, rng);
+		legacy_ns = time_ns([&] { sink = legacy.cnt(); });
+		time_isas([&] { sink = bitmap.cnt(); }, scalar_ns, avx2_ns);
+		report("cnt", bits, legacy_ns, scalar_ns, avx2_ns);
+	}
+
+	// union_with(), with change detection through cnt() in the legacy one,
+	// as the previous liveness solver did.
+	{
+		auto legacy_dst = random_bitmap<LegacyBitmap>(bits, 0.3, rng);
+		auto legacy_src = random_bitmap<LegacyBitmap>(bits, 0.3, rng);
+		auto dst = random_bitmap<Bitmap>(bits, 0.3, rng);
+		auto src = random_bitmap<Bitmap>(bits, 0.3, rng);
+		legacy_ns = time_ns([&]
+		{
+			size_t prev_cnt = legacy_dst.cnt();
+			legacy_dst.union_with(legacy_src);
+			sink = legacy_dst.cnt() != prev_cnt;
+		});
+		time_isas([&] { sink = dst.union_with(src); }, scalar_ns, avx2_ns);
+		report("union_changed", bits, legacy_ns, scalar_ns, avx2_ns);
+	}
+
+	// The liveness transfer function: in = gen | (out & ~kill).
+	{
+		auto legacy_gen = random_bitmap<LegacyBitmap>(bits, 0.05, rng);
+		auto legacy_kill = random_bitmap<LegacyBitmap>(bits, 0.05, rng);
+		auto legacy_out = random_bitmap<LegacyBitmap>(bits, 0.3, rng);
+		LegacyBitmap legacy_in(bits);
+		auto gen = random_bitmap<Bitmap>(bits, 0.05, rng);
+		auto kill = random_bitmap<Bitmap>(bits, 0.05, rng);
+		auto out = random_bitmap<Bitmap>(bits, 0.3, rng);
+		Bitmap in(bits);
+		legacy_ns = time_ns([&]
+		{
+			size_t prev_cnt = legacy_in.cnt();
+			legacy_in.clear();
+			legacy_in.union_with(legacy_out);
+			legacy_in.diff_with(legacy_kill);
+			legacy_in.union_with(legacy_gen);
+			sink = legacy_in.cnt() != prev_cnt;
+		});
+		time_isas([&] { sink = in.assign_transfer(gen, out, kill); }, scalar_ns, avx2_ns);
+		report("transfer_changed", bits, legacy_ns, scalar_ns, avx2_ns);
+	}
+
+	// Iteration over set bits.
+	{
+		auto legacy = random_bitmap<LegacyBitmap>(bits, 0.05, rng);
+		auto bitmap = random_bitmap<Bitmap>(bits, 0.05, rng);
+		legacy_ns = time_ns([&]
+		{
+			size_t sum = 0;
+			for(int i = 0; i < legacy.size(); i++)
+				if(legacy.get(i))
+					sum += i;
+			sink = sum;
+		});
+		time_isas([&]
+		{
+			size_t sum = 0;
+			bitmap.for_each_set_bit([&](size_t i) { sum += i; });
+			sink = sum;
+		}, scalar_ns, avx2_ns);
+		report("iterate_5%", bits, legacy_ns, scalar_ns, avx2_ns);
+	}
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	int max_bits = argc > 1? std::atoi(argv[1]) : 65536;
+	std::printf("%-18s %8s %12s %12s %12s %9s\n",
+		"benchmark", "bits", "legacy(ns)", "scalar(ns)", "avx2(ns)", "speedup");
+	for(int bits = 64; bits <= max_bits; bits *= 8)
+		bench(bits);
+	return 0;
+}
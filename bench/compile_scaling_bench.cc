@@ -0,0 +1,190 @@
+// Compile-time scaling benchmark. Doubles one parameter of the synthetic SysY
+// programs (see sysy_gen.h) at each step, compiles them with -fmem-report, and
+// prints the wall time of every phase with its growth exponent, so that a
+// phase growing faster than its input stands out.
+// The report of each step is kept in out_dir as <param>_<value>.{sy,txt,json}.
+// usage: compile_scaling_bench <compiler> [param] [steps] [out_dir]
+//   param: funcs, stmts, depth, temps, globals, inits or calls (default stmts)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "sysy_gen.h"
+
+using compiler::bench::SysyGenParams;
+
+namespace
+{
+
+// A phase whose time grows with a larger exponent is marked superlinear,
+// unless it takes too little time to be measured.
+constexpr double SUPERLINEAR_EXPONENT = 1.3;
+constexpr double MIN_MEASURED_SEC = 1e-3;
+
+struct PhaseResult
+{
+	double wall_sec;
+	double rss_kib;
+};
+
+// The phases of a report by their paths ("tigger gen/liveness").
+struct Report
+{
+	std::vector<std::string> names; // In the order of the report.
+	std::map<std::string, PhaseResult> phases;
+};
+
+int *param_of(SysyGenParams &params, const std::string &name)
+{
+	static const std::pair<const char *, int SysyGenParams::*> params_by_name[] = {
+		{"funcs", &SysyGenParams::func_cnt},
+		{"stmts", &SysyGenParams::stmts_per_func},
+		{"depth", &SysyGenParams::max_depth},
+		{"temps", &SysyGenParams::temp_cnt},
+		{"globals", &SysyGenParams::global_array_size},
+		{"inits", &SysyGenParams::init_size},
+		{"calls", &SysyGenParams::call_percent},
+	};
+	for(const auto &[param_name, member] : params_by_name)
+		if(name == param_name)
+			return &(params.*member);
+	return nullptr;
+}
+
+// Reads the table printed by -fmem-report. A phase line is the name, indented
+// by its depth, followed by 8 numbers; the lines of sizes start with "- ".
+bool read_report(const std::string &filename, Report &report)
+{
+	std::ifstream fin(filename);
+	std::string line;
+	if(!std::getline(fin, line) || line.compare(0, 5, "phase") != 0)
+		return false;
+
+	std::vector<std::string> path;
+	while(std::getline(fin, line))
+	{
+		size_t indent = line.find_first_not_of(' ');
+		if(indent == std::string::npos || line[indent] == '-' || line[indent] == '(')
+			continue;
+
+		std::istringstream words(line);
+		std::vector<std::string> tokens;
+		for(std::string word; words >> word; )
+			tokens.push_back(word);
+		if(tokens.size() < 9)
+			continue;
+		std::string name = tokens[0];
+		for(size_t i = 1; i + 8 < tokens.size(); i++)
+			name += " " + tokens[i];
+		const auto *numbers = &tokens[tokens.size() - 8];
+
+		path.resize(indent / 2);
+		path.push_back(name);
+		std::string full_name = path[0];
+		for(size_t i = 1; i < path.size(); i++)
+			full_name += "/" + path[i];
+		report.names.push_back(full_name);
+		report.phases[full_name] = {std::atof(numbers[1].c_str()), std::atof(numbers[7].c_str())};
+	}
+	return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	if(argc < 2)
+	{
+		std::fprintf(stderr, "usage: %s <compiler> [param] [steps] [out_dir]\n", argv[0]);
+		return 1;
+	}
+	std::string compiler = argv[1];
+	std::string param_name = argc > 2? argv[2] : "stmts";
+	int step_cnt = argc > 3? std::atoi(argv[3]) : 6;
+	std::string out_dir = argc > 4? argv[4] : ".";
+
+	SysyGenParams params;
+	int *param = param_of(params, param_name);
+	if(param == nullptr)
+	{
+		std::fprintf(stderr, "unknown parameter %s\n", param_name.c_str());
+		return 1;
+	}
+
+	std::vector<int> values;
+	std::vector<Report> reports;
+	for(int step = 0; step < step_cnt; step++, *param *= 2)
+	{
+		if(param_name == "calls" && *param > 100)
+			break;
+		auto prefix = out_dir + "/" + param_name + "_" + std::to_string(*param);
+		{
+			std::ofstream fout(prefix + ".sy");
+			compiler::bench::generate_sysy(fout, params);
+		}
+
+		// One thread, so that the wall times of the phases are comparable.
+		auto command = compiler + " -j 1 -fmem-report -ftime-report-json " + prefix + ".json "
+			+ prefix + ".sy -o " + prefix + ".s 2> " + prefix + ".txt";
+		Report report;
+		if(std::system(command.c_str()) != 0 || !read_report(prefix + ".txt", report))
+		{
+			std::fprintf(stderr, "failed to compile %s.sy, see %s.txt\n", prefix.c_str(), prefix.c_str());
+			break;
+		}
+		values.push_back(*param);
+		reports.push_back(std::move(report));
+	}
+	if(values.empty())
+		return 1;
+
+	// Wall time of the phases in ms, in the order of the last report, since
+	// the first one may miss some phases.
+	std::printf("%-40s", param_name.c_str());
+	for(int value : values)
+		std::printf(" %10d", value);
+	std::printf(" %9s\n", "exponent");
+	const auto &last = reports.back();
+	const auto &prev = reports.size() >= 2? reports[reports.size() - 2] : last;
+	for(const auto &name : last.names)
+	{
+		std::printf("%-40s", name.c_str());
+		for(const auto &report : reports)
+		{
+			auto iter = report.phases.find(name);
+			if(iter == report.phases.end())
+				std::printf(" %10s", "-");
+			else
+				std::printf(" %10.3f", iter->second.wall_sec * 1e3);
+		}
+
+		// The growth exponent of the last step: time ~ value ^ exponent.
+		auto prev_iter = prev.phases.find(name);
+		double curr_sec = last.phases.at(name).wall_sec;
+		if(reports.size() >= 2 && prev_iter != prev.phases.end()
+			&& prev_iter->second.wall_sec > 0 && curr_sec >= MIN_MEASURED_SEC)
+		{
+			double exponent = std::log(curr_sec / prev_iter->second.wall_sec)
+				/ std::log(double(values.back()) / values[values.size() - 2]);
+			std::printf(" %9.2f%s", exponent, exponent > SUPERLINEAR_EXPONENT? " superlinear" : "");
+		}
+		std::printf("\n");
+	}
+
+	std::printf("%-40s", "peak rss (KiB)");
+	for(const auto &report : reports)
+	{
+		double rss_kib = 0;
+		for(const auto &[name, result] : report.phases)
+			rss_kib = std::max(rss_kib, result.rss_kib);
+		std::printf(" %10.0f", rss_kib);
+	}
+	std::printf("\n");
+	return 0;
+}
@@ -0,0 +1,102 @@
+// Scaling benchmark of the linear-scan register allocator on synthetic
+// functions with a large number of temporaries.
+// usage: regalloc_bench [max_temps] [window]
+//   window: how many temporaries are live at the same time.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "eeyore_gen.h"
+#include "reg_alloc.h"
+
+using namespace compiler::backend;
+using BinOp = compiler::frontend::BinaryOpNode;
+
+namespace
+{
+
+// The code of a program, with its functions.
+struct SyntheticCode
+{
+	eeyore::EeyoreCode code;
+	std::vector<eeyore::EeyoreFunc> funcs;
+};
+
+// Builds a function with temp_cnt temporaries, where about window of them are
+// live at the same time, and a function call every 256 statements.
+//   f_main [0]
+//     var t0 ... var tN
+//     t0 = 0 ... t(w-1) = w-1
+//     ti = t(i-1) + t(i-w)   for i >= w
+//     return t(N-1)
+//   end f_main
+void synthetic_func(SyntheticCode &res, int temp_cnt, int window)
+{
+	eeyore::EeyoreGenerator::CodeBuilder builder(res.code, res.funcs);
+	std::vector<eeyore::TempVar> temps;
+	for(int i = 0; i < temp_cnt; i++)
+		temps.emplace_back(i, i);
+
+	builder.emit(eeyore::FuncDefStmt(compiler::utils::Symbol("f_main"), 0));
+	for(const auto &temp : temps)
+		builder.emit(eeyore::DeclStmt(temp));
+	for(int i = 0; i < temp_cnt; i++)
+	{
+		if(i < window)
+			builder.emit(eeyore::MoveStmt(temps[i], i));
+		else
+			builder.emit(eeyore::BinaryOpStmt(
+				temps[i], temps[i - 1], BinOp::ADD, temps[i - window]));
+		if(i % 256 == 255)
+			builder.emit(eeyore::FuncCallStmt(compiler::utils::Symbol("f_getint")));
+	}
+	builder.emit(eeyore::RetStmt(temps.back()));
+	builder.emit(eeyore::EndFuncDefStmt(compiler::utils::Symbol("f_main")));
+	builder.finish();
+}
+
+double ms_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	int max_temps = argc > 1? std::atoi(argv[1]) : 204800;
+	int window = argc > 2? std::atoi(argv[2]) : 64;
+
+	std::printf("%10s %8s %14s %14s %12s %10s\n",
+		"temps", "window", "intervals(ms)", "allocate(ms)", "ns/stmt", "changes");
+	const std::vector<bool> no_globals;
+	for(int temp_cnt = 800; temp_cnt <= max_temps; temp_cnt *= 4)
+	{
+		SyntheticCode synthetic;
+		synthetic_func(synthetic, temp_cnt, std::min(window, temp_cnt));
+
+		double interval_ms = 0, allocate_ms = 0;
+		int stmt_cnt = 0;
+		size_t change_cnt = 0;
+		for(const auto &func : synthetic.funcs)
+		{
+			auto start = std::chrono::steady_clock::now();
+			tigger::RegAllocator allocator;
+			allocator.initialize(synthetic.code, func, no_globals, tigger::ALL_CALLEE_SAVED_REG,
+				std::vector<tigger::CallerSavedReg>(
+					tigger::ALL_CALLER_SAVED_REG.begin() + 3, tigger::ALL_CALLER_SAVED_REG.end()));
+			interval_ms += ms_since(start);
+
+			start = std::chrono::steady_clock::now();
+			for(int stmt_id = func.begin_stmt_id; stmt_id < func.end_stmt_id; stmt_id++)
+				change_cnt += allocator.allocate_for(synthetic.code[stmt_id], stmt_id).size();
+			allocate_ms += ms_since(start);
+			stmt_cnt += func.end_stmt_id - func.begin_stmt_id;
+		}
+
+		std::printf("%10d %8d %14.2f %14.2f %12.1f %10zu\n", temp_cnt, std::min(window, temp_cnt),
+			interval_ms, allocate_ms, allocate_ms * 1e6 / stmt_cnt, change_cnt);
+	}
+	return 0;
+}
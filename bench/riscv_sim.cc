@@ -0,0 +1,869 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <tuple>
+#include "riscv_sim.h"
+
+namespace
+{
+
+using compiler::bench::RiscvSimulator;
+using Op = RiscvSimulator::Op;
+using SimError = RiscvSimulator::SimError;
+
+const char *REG_NAMES[] = {
+	"zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2", "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+	"a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"
+};
+constexpr int RA = 1, SP = 2, A0 = 10, A1 = 11;
+
+const char *BUILTIN_NAMES[] = {
+	"getint", "getch", "getarray", "putint", "putch", "putarray", "_sysy_starttime", "_sysy_stoptime"
+};
+
+// The functions printed by print_stats.
+constexpr int TOP_FUNC_CNT = 20;
+
+std::string at_line(int lineno)
+{
+	return " at line " + std::to_string(lineno);
+}
+
+std::string hex_of(uint32_t val)
+{
+	std::ostringstream out;
+	out << "0x" << std::hex << val;
+	return out.str();
+}
+
+std::string trim(const std::string &str)
+{
+	size_t begin = str.find_first_not_of(" \t\r");
+	if(begin == std::string::npos)
+		return "";
+	size_t end = str.find_last_not_of(" \t\r");
+	return str.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> split_operands(const std::string &str)
+{
+	std::vector<std::string> oprs;
+	if(trim(str).empty())
+		return oprs;
+	std::istringstream in(str);
+	for(std::string opr; std::getline(in, opr, ','); )
+		oprs.push_back(trim(opr));
+	return oprs;
+}
+
+bool is_12bit(int64_t x)
+{
+	return -2048 <= x && x < 2048;
+}
+
+int reg_of(const std::string &name, int lineno)
+{
+	for(int reg = 0; reg < 32; reg++)
+		if(name == REG_NAMES[reg])
+			return reg;
+	if(name == "fp")
+		return 8;
+	if(name.size() >= 2 && name[0] == 'x' && std::isdigit(name[1]))
+	{
+		int reg = std::atoi(name.c_str() + 1);
+		if(reg < 32 && std::to_string(reg) == name.substr(1))
+			return reg;
+	}
+	throw SimError("invalid register " + name + at_line(lineno));
+}
+
+bool parse_int(const std::string &str, int64_t &val)
+{
+	if(str.empty())
+		return false;
+	char *end;
+	errno = 0;
+	val = std::strtoll(str.c_str(), &end, 0);
+	return errno == 0 && *end == '\0' && val >= INT_MIN && val <= UINT_MAX;
+}
+
+int64_t int_of(const std::string &str, int lineno)
+{
+	int64_t val;
+	if(!parse_int(str, val))
+		throw SimError("invalid immediate " + str + at_line(lineno));
+	return val;
+}
+
+// Splits "%hi(sym)" or "%lo(sym)" into the function and the symbol.
+bool parse_reloc(const std::string &str, std::string &func, std::string &symbol)
+{
+	if(str.size() < 6 || str[0] != '%' || str.back() != ')')
+		return false;
+	size_t paren = str.find('(');
+	if(paren == std::string::npos)
+		return false;
+	func = str.substr(1, paren - 1);
+	symbol = trim(str.substr(paren + 1, str.size() - paren - 2));
+	return func == "hi" || func == "lo";
+}
+
+// The upper 20 bits and the lower 12 bits of an address, like %hi and %lo.
+int32_t hi_of(uint32_t addr)
+{
+	return (addr + 0x800) >> 12;
+}
+int32_t lo_of(uint32_t addr)
+{
+	return int32_t(addr - (uint32_t(hi_of(addr)) << 12));
+}
+
+// Arithmetic follows the RISC-V spec, including division by zero and
+// overflow, which do not trap.
+uint32_t alu(Op op, uint32_t a, uint32_t b)
+{
+	int32_t sa = a, sb = b;
+	switch(op)
+	{
+	case Op::ADD: case Op::ADDI: return a + b;
+	case Op::SUB: return a - b;
+	case Op::SLL: case Op::SLLI: return a << (b & 31);
+	case Op::SLT: case Op::SLTI: return sa < sb;
+	case Op::SLTU: case Op::SLTIU: return a < b;
+	case Op::XOR: case Op::XORI: return a ^ b;
+	case Op::SRL: case Op::SRLI: return a >> (b & 31);
+	case Op::SRA: case Op::SRAI: return uint32_t(sa >> (b & 31));
+	case Op::OR: case Op::ORI: return a | b;
+	case Op::AND: case Op::ANDI: return a & b;
+	case Op::MUL: return a * b;
+	case Op::MULH: return uint32_t((int64_t(sa) * int64_t(sb)) >> 32);
+	case Op::MULHSU: return uint32_t((int64_t(sa) * int64_t(uint64_t(b))) >> 32);
+	case Op::MULHU: return uint32_t((uint64_t(a) * uint64_t(b)) >> 32);
+	case Op::DIV:
+		if(b == 0)
+			return UINT32_MAX;
+		return sa == INT_MIN && sb == -1? a : uint32_t(sa / sb);
+	case Op::DIVU: return b == 0? UINT32_MAX : a / b;
+	case Op::REM:
+		if(b == 0)
+			return a;
+		return sa == INT_MIN && sb == -1? 0 : uint32_t(sa % sb);
+	case Op::REMU: return b == 0? a : a % b;
+	default: return 0;
+	}
+}
+
+bool branch_taken(Op op, uint32_t a, uint32_t b)
+{
+	switch(op)
+	{
+	case Op::BEQ: return a == b;
+	case Op::BNE: return a != b;
+	case Op::BLT: return int32_t(a) < int32_t(b);
+	case Op::BGE: return int32_t(a) >= int32_t(b);
+	case Op::BLTU: return a < b;
+	case Op::BGEU: return a >= b;
+	default: return false;
+	}
+}
+
+} // namespace
+
+namespace compiler::bench
+{
+
+RiscvSimulator::RiscvSimulator(std::istream &in, std::ostream &out, const PipelineModel &model,
+	uint32_t memory_size)
+  : _model(model), _in(in), _out(out), _mem(memory_size, 0), _data_end(DATA_BASE), _entry(-1)
+{
+}
+
+uint32_t RiscvSimulator::_allocate_data(uint32_t size, uint32_t align, int lineno)
+{
+	if(align > 1)
+		_data_end = (_data_end + align - 1) / align * align;
+	uint32_t addr = _data_end;
+	if(uint64_t(addr) + size > _mem.size())
+		throw SimError("data out of memory" + at_line(lineno));
+	_data_end += size;
+	return addr;
+}
+
+void RiscvSimulator::_assemble_directive(const std::vector<std::string> &tokens, int lineno,
+	bool &in_text)
+{
+	const auto &name = tokens[0];
+	std::vector<std::string> args(tokens.begin() + 1, tokens.end());
+	if(name == ".text")
+		in_text = true;
+	else if(name == ".data" || name == ".sdata" || name == ".bss" || name == ".sbss"
+		|| name == ".rodata")
+		in_text = false;
+	else if(name == ".section")
+		in_text = !args.empty() && args[0].compare(0, 5, ".text") == 0;
+	else if(name == ".align" || name == ".p2align" || name == ".balign")
+	{
+		if(args.empty())
+			throw SimError("missing alignment" + at_line(lineno));
+		int64_t align = int_of(args[0], lineno);
+		if(name != ".balign")
+			align = int64_t(1) << align;
+		// Instructions are always aligned.
+		if(!in_text)
+			_allocate_data(0, align, lineno);
+	}
+	else if(name == ".word" || name == ".half" || name == ".byte")
+	{
+		if(in_text)
+			throw SimError("data in text" + at_line(lineno));
+		int size = name == ".word"? 4 : name == ".half"? 2 : 1;
+		for(const auto &arg : args)
+		{
+			uint32_t val = int_of(arg, lineno);
+			uint32_t addr = _allocate_data(size, 1, lineno);
+			for(int i = 0; i < size; i++)
+				_mem[addr + i] = val >> (i * 8);
+		}
+	}
+	else if(name == ".zero" || name == ".space")
+	{
+		if(args.empty())
+			throw SimError("missing size" + at_line(lineno));
+		_allocate_data(int_of(args[0], lineno), 1, lineno);
+	}
+	else if(name == ".comm" || name == ".lcomm")
+	{
+		if(args.size() < 2)
+			throw SimError("missing size of common symbol" + at_line(lineno));
+		uint32_t align = args.size() >= 3? int_of(args[2], lineno) : 4;
+		if(_data_symbols.count(args[0]) != 0)
+			throw SimError("redefined symbol " + args[0] + at_line(lineno));
+		_data_symbols[args[0]] = _allocate_data(int_of(args[1], lineno), align, lineno);
+	}
+	else if(name != ".global" && name != ".globl" && name != ".local" && name != ".type"
+		&& name != ".size" && name != ".file" && name != ".ident" && name != ".option"
+		&& name != ".attribute")
+		throw SimError("unknown directive " + name + at_line(lineno));
+}
+
+void RiscvSimulator::_assemble_inst(const std::string &mnemonic, const std::vector<std::string> &oprs,
+	int lineno)
+{
+	auto expect_oprs = [&](size_t cnt) {
+		if(oprs.size() != cnt)
+			throw SimError(mnemonic + " takes " + std::to_string(cnt) + " operands" + at_line(lineno));
+	};
+	auto emit = [&](Op op, int rd, int rs1, int rs2, int64_t imm,
+		const std::string &symbol = "", decltype(PendingInst::reloc) reloc = PendingInst::NONE) {
+		_pending.push_back({op, uint8_t(rd), uint8_t(rs1), uint8_t(rs2), int32_t(imm), symbol, reloc,
+			lineno, int(_funcs.size()) - 1});
+	};
+	auto reg = [&](size_t i) { return reg_of(oprs[i], lineno); };
+	auto imm12 = [&](size_t i) {
+		int64_t val = int_of(oprs[i], lineno);
+		if(!is_12bit(val))
+			throw SimError("immediate out of range " + oprs[i] + at_line(lineno));
+		return val;
+	};
+	// "offset(reg)", where offset may be %lo(symbol).
+	auto emit_mem = [&](Op op, int rd, int rs2) {
+		const auto &opr = oprs[1];
+		size_t paren = opr.rfind('(');
+		if(paren == std::string::npos || opr.back() != ')')
+			throw SimError("invalid memory operand " + opr + at_line(lineno));
+		int base = reg_of(trim(opr.substr(paren + 1, opr.size() - paren - 2)), lineno);
+		auto offset = trim(opr.substr(0, paren));
+		std::string func, symbol;
+		if(parse_reloc(offset, func, symbol))
+		{
+			if(func != "lo")
+				throw SimError("invalid relocation " + offset + at_line(lineno));
+			emit(op, rd, base, rs2, 0, symbol, PendingInst::LO);
+		}
+		else
+		{
+			int64_t val = offset.empty()? 0 : int_of(offset, lineno);
+			if(!is_12bit(val))
+				throw SimError("offset out of range " + offset + at_line(lineno));
+			emit(op, rd, base, rs2, val);
+		}
+	};
+	auto emit_li = [&](int rd, int64_t val) {
+		if(is_12bit(int32_t(val)))
+			emit(Op::ADDI, rd, 0, 0, int32_t(val));
+		else
+		{
+			uint32_t uval = val;
+			emit(Op::LUI, rd, 0, 0, hi_of(uval) & 0xfffff);
+			if(lo_of(uval) != 0)
+				emit(Op::ADDI, rd, rd, 0, lo_of(uval));
+		}
+	};
+
+	static const std::pair<const char *, Op> r_ops[] = {
+		{"add", Op::ADD}, {"sub", Op::SUB}, {"sll", Op::SLL}, {"slt", Op::SLT}, {"sltu", Op::SLTU},
+		{"xor", Op::XOR}, {"srl", Op::SRL}, {"sra", Op::SRA}, {"or", Op::OR}, {"and", Op::AND},
+		{"mul", Op::MUL}, {"mulh", Op::MULH}, {"mulhsu", Op::MULHSU}, {"mulhu", Op::MULHU},
+		{"div", Op::DIV}, {"divu", Op::DIVU}, {"rem", Op::REM}, {"remu", Op::REMU},
+	};
+	static const std::pair<const char *, Op> i_ops[] = {
+		{"addi", Op::ADDI}, {"slti", Op::SLTI}, {"sltiu", Op::SLTIU}, {"xori", Op::XORI},
+		{"ori", Op::ORI}, {"andi", Op::ANDI}, {"slli", Op::SLLI}, {"srli", Op::SRLI},
+		{"srai", Op::SRAI},
+	};
+	static const std::pair<const char *, Op> load_ops[] = {
+		{"lb", Op::LB}, {"lh", Op::LH}, {"lw", Op::LW}, {"lbu", Op::LBU}, {"lhu", Op::LHU},
+	};
+	static const std::pair<const char *, Op> store_ops[] = {
+		{"sb", Op::SB}, {"sh", Op::SH}, {"sw", Op::SW},
+	};
+	// The pseudo-instructions swap the operands of the branches.
+	static const std::tuple<const char *, Op, bool> branch_ops[] = {
+		{"beq", Op::BEQ, false}, {"bne", Op::BNE, false}, {"blt", Op::BLT, false},
+		{"bge", Op::BGE, false}, {"bltu", Op::BLTU, false}, {"bgeu", Op::BGEU, false},
+		{"bgt", Op::BLT, true}, {"ble", Op::BGE, true}, {"bgtu", Op::BLTU, true},
+		{"bleu", Op::BGEU, true},
+	};
+	// Branches comparing with zero: (op, whether zero is the first operand).
+	static const std::tuple<const char *, Op, bool> branch_zero_ops[] = {
+		{"beqz", Op::BEQ, false}, {"bnez", Op::BNE, false}, {"bltz", Op::BLT, false},
+		{"bgez", Op::BGE, false}, {"blez", Op::BGE, true}, {"bgtz", Op::BLT, true},
+	};
+
+	for(const auto &[name, op] : r_ops)
+		if(mnemonic == name)
+		{
+			expect_oprs(3);
+			emit(op, reg(0), reg(1), reg(2), 0);
+			return;
+		}
+	for(const auto &[name, op] : i_ops)
+		if(mnemonic == name)
+		{
+			expect_oprs(3);
+			int64_t val = imm12(2);
+			if((op == Op::SLLI || op == Op::SRLI || op == Op::SRAI) && (val < 0 || val >= 32))
+				throw SimError("invalid shift amount" + at_line(lineno));
+			emit(op, reg(0), reg(1), 0, val);
+			return;
+		}
+	for(const auto &[name, op] : load_ops)
+		if(mnemonic == name)
+		{
+			expect_oprs(2);
+			emit_mem(op, reg(0), 0);
+			return;
+		}
+	for(const auto &[name, op] : store_ops)
+		if(mnemonic == name)
+		{
+			expect_oprs(2);
+			emit_mem(op, 0, reg(0));
+			return;
+		}
+	for(const auto &[name, op, swapped] : branch_ops)
+		if(mnemonic == name)
+		{
+			expect_oprs(3);
+			if(swapped)
+				emit(op, 0, reg(1), reg(0), 0, oprs[2], PendingInst::TARGET);
+			else
+				emit(op, 0, reg(0), reg(1), 0, oprs[2], PendingInst::TARGET);
+			return;
+		}
+	for(const auto &[name, op, swapped] : branch_zero_ops)
+		if(mnemonic == name)
+		{
+			expect_oprs(2);
+			if(swapped)
+				emit(op, 0, 0, reg(0), 0, oprs[1], PendingInst::TARGET);
+			else
+				emit(op, 0, reg(0), 0, 0, oprs[1], PendingInst::TARGET);
+			return;
+		}
+
+	if(mnemonic == "lui")
+	{
+		expect_oprs(2);
+		std::string func, symbol;
+		if(parse_reloc(oprs[1], func, symbol))
+		{
+			if(func != "hi")
+				throw SimError("invalid relocation " + oprs[1] + at_line(lineno));
+			emit(Op::LUI, reg(0), 0, 0, 0, symbol, PendingInst::HI);
+		}
+		else
+		{
+			int64_t val = int_of(oprs[1], lineno);
+			if(val < 0 || val >= (1 << 20))
+				throw SimError("immediate out of range " + oprs[1] + at_line(lineno));
+			emit(Op::LUI, reg(0), 0, 0, val);
+		}
+	}
+	else if(mnemonic == "li")
+	{
+		expect_oprs(2);
+		emit_li(reg(0), int_of(oprs[1], lineno));
+	}
+	else if(mnemonic == "la")
+	{
+		expect_oprs(2);
+		emit(Op::LUI, reg(0), 0, 0, 0, oprs[1], PendingInst::HI);
+		emit(Op::ADDI, reg(0), reg(0), 0, 0, oprs[1], PendingInst::LO);
+	}
+	else if(mnemonic == "mv")
+	{
+		expect_oprs(2);
+		emit(Op::ADDI, reg(0), reg(1), 0, 0);
+	}
+	else if(mnemonic == "not")
+	{
+		expect_oprs(2);
+		emit(Op::XORI, reg(0), reg(1), 0, -1);
+	}
+	else if(mnemonic == "neg")
+	{
+		expect_oprs(2);
+		emit(Op::SUB, reg(0), 0, reg(1), 0);
+	}
+	else if(mnemonic == "seqz")
+	{
+		expect_oprs(2);
+		emit(Op::SLTIU, reg(0), reg(1), 0, 1);
+	}
+	else if(mnemonic == "snez")
+	{
+		expect_oprs(2);
+		emit(Op::SLTU, reg(0), 0, reg(1), 0);
+	}
+	else if(mnemonic == "sltz")
+	{
+		expect_oprs(2);
+		emit(Op::SLT, reg(0), reg(1), 0, 0);
+	}
+	else if(mnemonic == "sgtz")
+	{
+		expect_oprs(2);
+		emit(Op::SLT, reg(0), 0, reg(1), 0);
+	}
+	else if(mnemonic == "sgt" || mnemonic == "sgtu")
+	{
+		expect_oprs(3);
+		emit(mnemonic == "sgt"? Op::SLT : Op::SLTU, reg(0), reg(2), reg(1), 0);
+	}
+	else if(mnemonic == "nop")
+	{
+		expect_oprs(0);
+		emit(Op::ADDI, 0, 0, 0, 0);
+	}
+	else if(mnemonic == "j" || mnemonic == "call" || mnemonic == "tail")
+	{
+		expect_oprs(1);
+		emit(Op::JAL, mnemonic == "call"? RA : 0, 0, 0, 0, oprs[0], PendingInst::TARGET);
+	}
+	else if(mnemonic == "jal")
+	{
+		if(oprs.size() == 1)
+			emit(Op::JAL, RA, 0, 0, 0, oprs[0], PendingInst::TARGET);
+		else
+		{
+			expect_oprs(2);
+			emit(Op::JAL, reg(0), 0, 0, 0, oprs[1], PendingInst::TARGET);
+		}
+	}
+	else if(mnemonic == "jr" || mnemonic == "ret")
+	{
+		expect_oprs(mnemonic == "jr"? 1 : 0);
+		emit(Op::JALR, 0, mnemonic == "jr"? reg(0) : RA, 0, 0);
+	}
+	else if(mnemonic == "jalr")
+	{
+		if(oprs.size() == 1)
+			emit(Op::JALR, RA, reg(0), 0, 0);
+		else if(oprs.size() == 2)
+			emit_mem(Op::JALR, reg(0), 0);
+		else
+		{
+			expect_oprs(3);
+			emit(Op::JALR, reg(0), reg(1), 0, imm12(2));
+		}
+	}
+	else
+		throw SimError("unknown instruction " + mnemonic + at_line(lineno));
+}
+
+void RiscvSimulator::_assemble_line(const std::string &raw_line, int lineno, bool &in_text)
+{
+	std::string line = trim(raw_line.substr(0, raw_line.find('#')));
+	// Labels, maybe followed by a statement.
+	for(size_t colon; (colon = line.find(':')) != std::string::npos; )
+	{
+		auto label = trim(line.substr(0, colon));
+		if(label.empty() || label.find_first_of(" \t(,") != std::string::npos)
+			break;
+		if(_data_symbols.count(label) != 0 || _text_symbols.count(label) != 0)
+			throw SimError("redefined symbol " + label + at_line(lineno));
+		if(in_text)
+		{
+			// Local labels begin with a dot, and others begin functions.
+			if(label[0] != '.')
+				_funcs.push_back({label, 0, 0, 0});
+			_text_symbols[label] = _pending.size();
+		}
+		else
+			_data_symbols[label] = _data_end;
+		line = trim(line.substr(colon + 1));
+	}
+	if(line.empty())
+		return;
+
+	size_t space = line.find_first_of(" \t");
+	std::string mnemonic = line.substr(0, space);
+	auto oprs = split_operands(space == std::string::npos? "" : line.substr(space));
+	if(mnemonic[0] == '.')
+	{
+		oprs.insert(oprs.begin(), mnemonic);
+		_assemble_directive(oprs, lineno, in_text);
+	}
+	else if(!in_text)
+		throw SimError("instruction out of text" + at_line(lineno));
+	else
+	{
+		if(_funcs.empty())
+			_funcs.push_back({"(text)", 0, 0, 0});
+		_assemble_inst(mnemonic, oprs, lineno);
+	}
+}
+
+void RiscvSimulator::_resolve()
+{
+	auto addr_of = [&](const std::string &symbol, int lineno) -> uint32_t {
+		auto data_iter = _data_symbols.find(symbol);
+		if(data_iter != _data_symbols.end())
+			return data_iter->second;
+		auto text_iter = _text_symbols.find(symbol);
+		if(text_iter != _text_symbols.end())
+			return TEXT_BASE + text_iter->second * 4;
+		throw SimError("undefined symbol " + symbol + at_line(lineno));
+	};
+
+	_insts.clear();
+	for(const auto &pending : _pending)
+	{
+		Inst inst = {pending.op, pending.rd, pending.rs1, pending.rs2, pending.imm, pending.line,
+			pending.func_id};
+		switch(pending.reloc)
+		{
+		case PendingInst::NONE:
+			break;
+		case PendingInst::HI:
+			inst.imm = hi_of(addr_of(pending.symbol, pending.line)) & 0xfffff;
+			break;
+		case PendingInst::LO:
+			inst.imm = lo_of(addr_of(pending.symbol, pending.line));
+			break;
+		case PendingInst::TARGET:
+		{
+			auto iter = _text_symbols.find(pending.symbol);
+			if(iter != _text_symbols.end())
+			{
+				inst.imm = iter->second;
+				break;
+			}
+			// A call of the runtime library.
+			auto builtin = std::find(std::begin(BUILTIN_NAMES), std::end(BUILTIN_NAMES), pending.symbol);
+			if(pending.op != Op::JAL || pending.rd != RA || builtin == std::end(BUILTIN_NAMES))
+				throw SimError("undefined label " + pending.symbol + at_line(pending.line));
+			inst = {Op::BUILTIN, A0, A0, A1, int32_t(builtin - std::begin(BUILTIN_NAMES)), pending.line,
+				pending.func_id};
+			break;
+		}
+		}
+		_insts.push_back(inst);
+	}
+	_pending.clear();
+
+	auto main_iter = _text_symbols.find("main");
+	if(main_iter == _text_symbols.end())
+		throw SimError("no main function");
+	_entry = main_iter->second;
+}
+
+void RiscvSimulator::load(std::istream &asm_in)
+{
+	// The data are assembled in place, and copied to the memory of each run.
+	std::fill(_mem.begin(), _mem.end(), 0);
+	_data_end = DATA_BASE;
+	_data_symbols.clear();
+	_text_symbols.clear();
+	_funcs.clear();
+
+	bool in_text = true;
+	std::string line;
+	for(int lineno = 1; std::getline(asm_in, line); lineno++)
+		_assemble_line(line, lineno, in_text);
+	_resolve();
+	_data.assign(_mem.begin() + DATA_BASE, _mem.begin() + _data_end);
+}
+
+uint32_t RiscvSimulator::_load(uint32_t addr, int size, int pc)
+{
+	if(addr % size != 0 || addr < DATA_BASE || uint64_t(addr) + size > _mem.size())
+		throw SimError("invalid load from " + hex_of(addr)
+			+ at_line(_insts[pc].line));
+	uint32_t val = 0;
+	for(int i = 0; i < size; i++)
+		val |= uint32_t(_mem[addr + i]) << (i * 8);
+	return val;
+}
+
+void RiscvSimulator::_store(uint32_t addr, int size, uint32_t val, int pc)
+{
+	if(addr % size != 0 || addr < DATA_BASE || uint64_t(addr) + size > _mem.size())
+		throw SimError("invalid store to " + hex_of(addr)
+			+ at_line(_insts[pc].line));
+	for(int i = 0; i < size; i++)
+		_mem[addr + i] = val >> (i * 8);
+}
+
+void RiscvSimulator::_call_builtin(Builtin builtin, int pc)
+{
+	int32_t a0 = _regs[A0], a1 = _regs[A1];
+	switch(builtin)
+	{
+	case Builtin::GETINT:
+	{
+		int val = 0;
+		if(!(_in >> val))
+			val = 0;
+		_regs[A0] = val;
+		break;
+	}
+	case Builtin::GETCH:
+		_regs[A0] = _in.get();
+		break;
+	case Builtin::GETARRAY:
+	{
+		int cnt = 0;
+		if(!(_in >> cnt))
+			cnt = 0;
+		for(int i = 0; i < cnt; i++)
+		{
+			int val = 0;
+			_in >> val;
+			_store(a0 + i * 4, 4, val, pc);
+		}
+		_regs[A0] = cnt;
+		break;
+	}
+	case Builtin::PUTINT:
+		_out << a0;
+		break;
+	case Builtin::PUTCH:
+		_out << char(a0);
+		break;
+	case Builtin::PUTARRAY:
+		_out << a0 << ':';
+		for(int i = 0; i < a0; i++)
+			_out << ' ' << int32_t(_load(a1 + i * 4, 4, pc));
+		_out << '\n';
+		break;
+	case Builtin::STARTTIME:
+		_timer_start = _stats.cycle_cnt;
+		_timer_start_lineno = a0;
+		break;
+	case Builtin::STOPTIME:
+		_timers.push_back({_timer_start_lineno, a0, _stats.cycle_cnt - _timer_start});
+		break;
+	}
+}
+
+int RiscvSimulator::run()
+{
+	if(_entry < 0)
+		throw SimError("no program loaded");
+	std::fill(_mem.begin(), _mem.end(), 0);
+	std::copy(_data.begin(), _data.end(), _mem.begin() + DATA_BASE);
+	std::fill(std::begin(_regs), std::end(_regs), 0);
+	std::fill(std::begin(_ready), std::end(_ready), 0);
+	// Returning to address 0 ends the program.
+	_regs[RA] = 0;
+	_regs[SP] = _mem.size() & ~uint32_t(15);
+	_stats = Stats();
+	_timers.clear();
+	_timer_start = 0;
+	_timer_start_lineno = 0;
+	for(auto &func : _funcs)
+		func.inst_cnt = func.cycle_cnt = func.call_cnt = 0;
+	_funcs[_insts[_entry].func_id].call_cnt++;
+
+	uint64_t cycle = 0;
+	int pc = _entry;
+	while(true)
+	{
+		const Inst &inst = _insts[pc];
+		uint64_t issue = std::max({cycle, _ready[inst.rs1], _ready[inst.rs2]});
+		_stats.data_stall_cycles += issue - cycle;
+		uint64_t begin_cycle = cycle;
+		cycle = issue + 1;
+		_stats.cycle_cnt = cycle;
+		_stats.inst_cnt++;
+
+		uint32_t a = _regs[inst.rs1], b = _regs[inst.rs2];
+		int latency = 1, next_pc = pc + 1, penalty = 0;
+		uint32_t result = 0;
+		switch(inst.op)
+		{
+		case Op::LUI:
+			result = uint32_t(inst.imm) << 12;
+			break;
+		case Op::JAL:
+			result = TEXT_BASE + (pc + 1) * 4;
+			next_pc = inst.imm;
+			penalty = _model.jump_penalty;
+			_stats.jump_cnt++;
+			if(inst.rd == RA)
+				_funcs[_insts[next_pc].func_id].call_cnt++;
+			break;
+		case Op::JALR:
+		{
+			result = TEXT_BASE + (pc + 1) * 4;
+			uint32_t target = (a + inst.imm) & ~uint32_t(1);
+			penalty = _model.indirect_jump_penalty;
+			_stats.jump_cnt++;
+			if(target == 0)
+			{
+				next_pc = -1;
+				break;
+			}
+			if(target % 4 != 0 || target < TEXT_BASE || (target - TEXT_BASE) / 4 >= _insts.size())
+				throw SimError("invalid jump to " + hex_of(target)
+					+ at_line(inst.line));
+			next_pc = (target - TEXT_BASE) / 4;
+			break;
+		}
+		case Op::BEQ: case Op::BNE: case Op::BLT: case Op::BGE: case Op::BLTU: case Op::BGEU:
+			_stats.branch_cnt++;
+			if(branch_taken(inst.op, a, b))
+			{
+				_stats.taken_branch_cnt++;
+				next_pc = inst.imm;
+				penalty = _model.taken_branch_penalty;
+			}
+			break;
+		case Op::LB: case Op::LH: case Op::LW: case Op::LBU: case Op::LHU:
+		{
+			uint32_t addr = a + inst.imm;
+			if(inst.op == Op::LB)
+				result = int8_t(_load(addr, 1, pc));
+			else if(inst.op == Op::LH)
+				result = int16_t(_load(addr, 2, pc));
+			else
+				result = _load(addr, inst.op == Op::LW? 4 : inst.op == Op::LBU? 1 : 2, pc);
+			latency = _model.load_latency;
+			_stats.load_cnt++;
+			break;
+		}
+		case Op::SB: case Op::SH: case Op::SW:
+			_store(a + inst.imm, inst.op == Op::SW? 4 : inst.op == Op::SH? 2 : 1, b, pc);
+			_stats.store_cnt++;
+			break;
+		case Op::ADDI: case Op::SLTI: case Op::SLTIU: case Op::XORI: case Op::ORI: case Op::ANDI:
+		case Op::SLLI: case Op::SRLI: case Op::SRAI:
+			result = alu(inst.op, a, inst.imm);
+			break;
+		case Op::MUL: case Op::MULH: case Op::MULHSU: case Op::MULHU:
+			result = alu(inst.op, a, b);
+			latency = _model.mul_latency;
+			_stats.mul_cnt++;
+			break;
+		case Op::DIV: case Op::DIVU: case Op::REM: case Op::REMU:
+			result = alu(inst.op, a, b);
+			latency = _model.div_latency;
+			_stats.div_cnt++;
+			break;
+		case Op::BUILTIN:
+			_call_builtin(Builtin(inst.imm), pc);
+			result = _regs[A0];
+			penalty = _model.jump_penalty;
+			_stats.jump_cnt++;
+			break;
+		default:
+			result = alu(inst.op, a, b);
+			break;
+		}
+
+		if(inst.rd != 0)
+		{
+			_regs[inst.rd] = result;
+			_ready[inst.rd] = issue + latency;
+		}
+		cycle += penalty;
+		_stats.control_stall_cycles += penalty;
+		_stats.cycle_cnt = cycle;
+		auto &func = _funcs[inst.func_id];
+		func.inst_cnt++;
+		func.cycle_cnt += cycle - begin_cycle;
+
+		if(next_pc < 0)
+			break;
+		if(next_pc >= int(_insts.size()))
+			throw SimError("running out of text" + at_line(inst.line));
+		pc = next_pc;
+	}
+
+	return int32_t(_regs[A0]);
+}
+
+void RiscvSimulator::print_stats(std::ostream &out) const
+{
+	const auto &s = _stats;
+	auto flags = out.flags();
+	out << "instructions retired: " << s.inst_cnt << '\n';
+	out << "cycles: " << s.cycle_cnt << " (CPI " << std::fixed << std::setprecision(3)
+		<< (s.inst_cnt == 0? 0.0 : double(s.cycle_cnt) / s.inst_cnt) << ")\n";
+	out.flags(flags);
+	out << "loads: " << s.load_cnt << ", stores: " << s.store_cnt << '\n';
+	out << "branches: " << s.branch_cnt << ", taken: " << s.taken_branch_cnt << '\n';
+	out << "jumps (with calls and returns): " << s.jump_cnt << '\n';
+	out << "mul: " << s.mul_cnt << ", div/rem: " << s.div_cnt << '\n';
+	out << "stall cycles: data " << s.data_stall_cycles << ", control " << s.control_stall_cycles << '\n';
+
+	std::vector<int> func_ids(_funcs.size());
+	for(size_t i = 0; i < func_ids.size(); i++)
+		func_ids[i] = i;
+	int top_cnt = std::min(int(func_ids.size()), TOP_FUNC_CNT);
+	std::partial_sort(func_ids.begin(), func_ids.begin() + top_cnt, func_ids.end(),
+		[&](int a, int b) { return _funcs[a].cycle_cnt > _funcs[b].cycle_cnt; });
+	out << '\n' << std::left << std::setw(20) << "function" << std::right << std::setw(16) << "calls"
+		<< std::setw(16) << "instructions" << std::setw(16) << "cycles" << '\n';
+	for(int i = 0; i < top_cnt; i++)
+	{
+		const auto &func = _funcs[func_ids[i]];
+		out << std::left << std::setw(20) << func.name << std::right << std::setw(16) << func.call_cnt
+			<< std::setw(16) << func.inst_cnt << std::setw(16) << func.cycle_cnt << '\n';
+	}
+	out.flags(flags);
+}
+
+void RiscvSimulator::print_timers(std::ostream &out) const
+{
+	uint64_t total = 0;
+	auto fill = out.fill();
+	for(const auto &timer : _timers)
+	{
+		out << "Timer@" << std::setfill('0') << std::setw(4) << timer.start_lineno << '-'
+			<< std::setw(4) << timer.stop_lineno << std::setfill(fill) << ": " << timer.cycles
+			<< " cycles\n";
+		total += timer.cycles;
+	}
+	if(!_timers.empty())
+		out << "TOTAL: " << total << " cycles\n";
+}
+
+} // namespace compiler::bench
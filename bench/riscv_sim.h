@@ -0,0 +1,169 @@
+#ifndef RISCV_SIM_H
+#define RISCV_SIM_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace compiler::bench
+{
+
+// The timing of an in-order, single-issue pipeline with full forwarding. An
+// instruction issues when its source registers are ready, and its result is
+// ready the given cycles after it issues, so a latency of 1 never stalls.
+// Branches are predicted not taken, and the penalties are the cycles lost
+// when the control flow changes.
+struct PipelineModel
+{
+	int load_latency = 2;
+	int mul_latency = 3;
+	int div_latency = 20; // Also of rem.
+	int taken_branch_penalty = 2;
+	int jump_penalty = 1; // jal, with the label known in decode.
+	int indirect_jump_penalty = 2; // jalr, including ret.
+};
+
+// Runs the RV32IM assembly printed by the compiler, i.e. the subset of gas
+// syntax used by riscv_printer.cc and the common pseudo-instructions, which
+// are expanded like gas does (li and la may take two instructions; call is
+// relaxed to one jal).
+// The SysY runtime library is a stub: calling getint, putarray ... jumps to
+// a builtin on the given streams, which costs only the call instruction.
+// The time of _sysy_starttime/_sysy_stoptime is in simulated cycles.
+// Memory is flat and little-endian: the data from DATA_BASE, and the stack
+// growing down from the end. Text is out of the memory, from TEXT_BASE.
+class RiscvSimulator
+{
+  public:
+	// An error of the assembly, or of the program being run.
+	class SimError
+	{
+	  protected:
+		std::string _what;
+
+	  public:
+		SimError(const std::string &what_arg): _what(what_arg) {}
+		const std::string &what() const { return _what; }
+	};
+
+	static constexpr uint32_t DATA_BASE = 0x10000;
+	static constexpr uint32_t TEXT_BASE = 0x80000000;
+	static constexpr uint32_t DEFAULT_MEMORY_SIZE = 64 << 20;
+
+	enum class Op : uint8_t
+	{
+		LUI, JAL, JALR, BEQ, BNE, BLT, BGE, BLTU, BGEU,
+		LB, LH, LW, LBU, LHU, SB, SH, SW,
+		ADDI, SLTI, SLTIU, XORI, ORI, ANDI, SLLI, SRLI, SRAI,
+		ADD, SUB, SLL, SLT, SLTU, XOR, SRL, SRA, OR, AND,
+		MUL, MULH, MULHSU, MULHU, DIV, DIVU, REM, REMU,
+		BUILTIN // A call of the runtime library, imm is the Builtin.
+	};
+
+	struct Stats
+	{
+		uint64_t inst_cnt = 0; // Retired instructions.
+		uint64_t cycle_cnt = 0;
+		uint64_t load_cnt = 0, store_cnt = 0;
+		uint64_t branch_cnt = 0, taken_branch_cnt = 0; // Conditional branches.
+		uint64_t jump_cnt = 0; // Including calls and returns.
+		uint64_t mul_cnt = 0, div_cnt = 0;
+		uint64_t data_stall_cycles = 0; // Waiting for the source registers.
+		uint64_t control_stall_cycles = 0; // Taken branches and jumps.
+	};
+
+  protected:
+	enum class Builtin
+	{
+		GETINT, GETCH, GETARRAY, PUTINT, PUTCH, PUTARRAY, STARTTIME, STOPTIME
+	};
+
+	struct Inst
+	{
+		Op op;
+		uint8_t rd, rs1, rs2; // 0 if not used.
+		int32_t imm; // The target instruction index for jal and branches.
+		int line; // In the source.
+		int func_id;
+	};
+
+	// An instruction before its symbols are resolved.
+	struct PendingInst
+	{
+		Op op;
+		uint8_t rd, rs1, rs2;
+		int32_t imm;
+		std::string symbol; // Of %hi, %lo, or the target of a jump.
+		enum { NONE, HI, LO, TARGET } reloc;
+		int line;
+		int func_id;
+	};
+
+	struct Function
+	{
+		std::string name;
+		uint64_t inst_cnt, cycle_cnt, call_cnt;
+	};
+
+	struct Timer
+	{
+		int start_lineno, stop_lineno;
+		uint64_t cycles;
+	};
+
+	PipelineModel _model;
+	std::istream &_in;
+	std::ostream &_out;
+
+	std::vector<Inst> _insts;
+	std::vector<Function> _funcs;
+	std::vector<uint8_t> _mem;
+	std::vector<uint8_t> _data; // The initial memory from DATA_BASE.
+	uint32_t _data_end;
+	int _entry; // The instruction index of main.
+
+	// The state of the program.
+	uint32_t _regs[32];
+	uint64_t _ready[32]; // The cycle when each register can be used.
+	Stats _stats;
+	std::vector<Timer> _timers;
+	uint64_t _timer_start;
+	int _timer_start_lineno;
+
+	// Assembling.
+	std::unordered_map<std::string, uint32_t> _data_symbols;
+	std::unordered_map<std::string, int> _text_symbols;
+	std::vector<PendingInst> _pending;
+
+	void _assemble_line(const std::string &line, int lineno, bool &in_text);
+	void _assemble_directive(const std::vector<std::string> &tokens, int lineno, bool &in_text);
+	void _assemble_inst(const std::string &mnemonic, const std::vector<std::string> &oprs, int lineno);
+	void _resolve();
+	uint32_t _allocate_data(uint32_t size, uint32_t align, int lineno);
+
+	uint32_t _load(uint32_t addr, int size, int pc);
+	void _store(uint32_t addr, int size, uint32_t val, int pc);
+	void _call_builtin(Builtin builtin, int pc);
+
+  public:
+	RiscvSimulator(std::istream &in, std::ostream &out, const PipelineModel &model = PipelineModel(),
+		uint32_t memory_size = DEFAULT_MEMORY_SIZE);
+
+	// Assembles the program, throws SimError.
+	void load(std::istream &asm_in);
+	// Runs main, returns its return value. Throws SimError.
+	int run();
+
+	const Stats &stats() const { return _stats; }
+	// Prints the stats of the last run, with the instructions and cycles of
+	// each function.
+	void print_stats(std::ostream &out) const;
+	// Prints the timers of _sysy_starttime and _sysy_stoptime.
+	void print_timers(std::ostream &out) const;
+};
+
+} // namespace compiler::bench
+
+#endif
@@ -0,0 +1,82 @@
+// Runs the RV32IM assembly printed by the compiler on stdin/stdout, and prints
+// the counts of the run and the estimated cycles to stderr. The exit code is
+// the return value of main.
+// usage: riscv_sim [-load cycles] [-mul cycles] [-div cycles] [-branch cycles]
+//                  [-jump cycles] [-ijump cycles] [-mem MiB] <file.s>
+//   The cycles are the latencies and the penalties of PipelineModel.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "riscv_sim.h"
+
+using compiler::bench::PipelineModel;
+using compiler::bench::RiscvSimulator;
+
+int main(int argc, char *argv[])
+{
+	PipelineModel model;
+	uint32_t memory_size = RiscvSimulator::DEFAULT_MEMORY_SIZE;
+	const char *asm_filename = nullptr;
+	static const std::pair<const char *, int PipelineModel::*> options[] = {
+		{"-load", &PipelineModel::load_latency},
+		{"-mul", &PipelineModel::mul_latency},
+		{"-div", &PipelineModel::div_latency},
+		{"-branch", &PipelineModel::taken_branch_penalty},
+		{"-jump", &PipelineModel::jump_penalty},
+		{"-ijump", &PipelineModel::indirect_jump_penalty},
+	};
+	for(int i = 1; i < argc; i++)
+	{
+		bool found = false;
+		for(const auto &[name, member] : options)
+			if(std::strcmp(argv[i], name) == 0 && i < argc - 1)
+			{
+				model.*member = std::max(std::atoi(argv[++i]), 0);
+				found = true;
+			}
+		if(found)
+			continue;
+		if(std::strcmp(argv[i], "-mem") == 0 && i < argc - 1)
+			memory_size = uint32_t(std::atoi(argv[++i])) << 20;
+		else if(argv[i][0] == '-')
+		{
+			std::cerr << "unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+		else
+			asm_filename = argv[i];
+	}
+	if(asm_filename == nullptr)
+	{
+		std::cerr << "usage: " << argv[0] << " [options] <file.s>" << std::endl;
+		return 1;
+	}
+	std::ifstream fin(asm_filename);
+	if(!fin)
+	{
+		std::cerr << "cannot open " << asm_filename << std::endl;
+		return 1;
+	}
+
+	std::ios::sync_with_stdio(false);
+	RiscvSimulator sim(std::cin, std::cout, model, memory_size);
+	int ret;
+	try
+	{
+		sim.load(fin);
+		ret = sim.run();
+	}
+	catch(RiscvSimulator::SimError &e)
+	{
+		std::cout.flush();
+		std::cerr << "error: " << e.what() << std::endl;
+		return 1;
+	}
+	std::cout.flush();
+	sim.print_timers(std::cerr);
+	sim.print_stats(std::cerr);
+	return ret & 0xff;
+}
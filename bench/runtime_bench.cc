@@ -0,0 +1,317 @@
+// Runtime benchmark of the SysY kernels in the corpus directory. Each <name>.sy
+// is run on <name>.in, and its output followed by the exit code must match
+// <name>.out. For every program it
+// - compiles it in every output mode, recording the size of the code and the
+//   instruction mix of each function (in out_dir/<name>.mix.txt);
+// - runs the eeyore code by the interpreter of the compiler (-r);
+// - runs the assembly by riscv_sim, recording instructions and cycles;
+// - if RISCV_CC and RISCV_EMU are set, links the assembly by $RISCV_CC (which
+//   must link the SysY runtime library) and runs it by $RISCV_EMU, e.g.
+//   qemu-riscv32, recording the wall time.
+// The sizes, instructions and cycles are compared with corpus_dir/baseline.txt,
+// and growing by more than REGRESSION_TOLERANCE fails the benchmark, as well
+// as any wrong output. -u writes the results as the new baseline instead.
+// usage: runtime_bench <compiler> <riscv_sim> <corpus_dir> <out_dir> [-u]
+
+#include <sys/wait.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr double REGRESSION_TOLERANCE = 0.01;
+
+// The metrics compared with the baseline, in the order of the report.
+const char *METRICS[] = {"eeyore_stmts", "tigger_stmts", "riscv_insts", "sim_insts", "sim_cycles"};
+
+// Classes of the instruction mix, by mnemonics of the printed assembly.
+const char *MIX_CLASSES[] = {"alu", "mul", "div", "load", "store", "branch", "jump"};
+
+int mix_class_of(const std::string &mnemonic)
+{
+	if(mnemonic == "mul" || mnemonic.compare(0, 4, "mulh") == 0)
+		return 1;
+	if(mnemonic.compare(0, 3, "div") == 0 || mnemonic.compare(0, 3, "rem") == 0)
+		return 2;
+	if(mnemonic == "lw" || mnemonic == "lh" || mnemonic == "lb" || mnemonic == "lhu"
+		|| mnemonic == "lbu")
+		return 3;
+	if(mnemonic == "sw" || mnemonic == "sh" || mnemonic == "sb")
+		return 4;
+	if(mnemonic[0] == 'b')
+		return 5;
+	if(mnemonic == "j" || mnemonic == "jal" || mnemonic == "jalr" || mnemonic == "jr"
+		|| mnemonic == "call" || mnemonic == "ret" || mnemonic == "tail")
+		return 6;
+	return 0;
+}
+
+constexpr int MIX_CLASS_CNT = sizeof(MIX_CLASSES) / sizeof(MIX_CLASSES[0]);
+using Mix = std::vector<long>;
+
+struct Result
+{
+	std::string name;
+	std::map<std::string, double> metrics;
+	Mix mix;
+	bool interp_ok, sim_ok;
+	double emu_ms; // -1 if not run.
+	bool emu_ok;
+	std::string error; // Of the compilation.
+};
+
+std::string read_file(const std::string &filename)
+{
+	std::ifstream fin(filename, std::ios::binary);
+	std::ostringstream content;
+	content << fin.rdbuf();
+	return content.str();
+}
+
+// Runs the command by the shell, returns the exit code, or -1 if it is killed.
+int run(const std::string &command)
+{
+	int status = std::system(command.c_str());
+	return WIFEXITED(status)? WEXITSTATUS(status) : -1;
+}
+
+// Whether the output file followed by the exit code is the expected output.
+bool check_output(const std::string &output_filename, int exit_code, const std::string &expected)
+{
+	auto output = read_file(output_filename);
+	if(!output.empty() && output.back() != '\n')
+		output += '\n';
+	return output + std::to_string(exit_code) + "\n" == expected;
+}
+
+long count_lines(const std::string &filename)
+{
+	std::ifstream fin(filename);
+	long cnt = 0;
+	for(std::string line; std::getline(fin, line); )
+		if(line.find_first_not_of(" \t") != std::string::npos)
+			cnt++;
+	return cnt;
+}
+
+// Counts the instructions of the assembly, and writes the mix of each
+// function to mix_filename. Returns the mix of the whole program.
+Mix count_mix(const std::string &asm_filename, const std::string &mix_filename)
+{
+	std::ifstream fin(asm_filename);
+	std::vector<std::pair<std::string, Mix>> funcs;
+	for(std::string line; std::getline(fin, line); )
+	{
+		size_t begin = line.find_first_not_of(" \t");
+		if(begin == std::string::npos)
+			continue;
+		if(line.back() == ':')
+		{
+			// Local labels begin with a dot, and others begin functions or data.
+			if(line[0] != '.')
+				funcs.emplace_back(line.substr(0, line.size() - 1), Mix(MIX_CLASS_CNT, 0));
+			continue;
+		}
+		if(line[begin] == '.' || funcs.empty())
+			continue;
+		auto mnemonic = line.substr(begin, line.find_first_of(" \t", begin) - begin);
+		funcs.back().second[mix_class_of(mnemonic)]++;
+	}
+
+	Mix total(MIX_CLASS_CNT, 0);
+	std::ofstream fout(mix_filename);
+	fout << "function";
+	for(const char *mix_class : MIX_CLASSES)
+		fout << ' ' << mix_class;
+	fout << '\n';
+	for(const auto &[name, mix] : funcs)
+	{
+		long sum = 0;
+		for(int i = 0; i < MIX_CLASS_CNT; i++)
+		{
+			sum += mix[i];
+			total[i] += mix[i];
+		}
+		if(sum == 0) // Data.
+			continue;
+		fout << name;
+		for(long cnt : mix)
+			fout << ' ' << cnt;
+		fout << '\n';
+	}
+	return total;
+}
+
+// Reads "<key>: <number>" from the stats of riscv_sim.
+double read_stat(const std::string &stats, const std::string &key)
+{
+	size_t pos = stats.find(key + ": ");
+	return pos == std::string::npos? -1 : std::atof(stats.c_str() + pos + key.size() + 2);
+}
+
+Result bench_program(const std::string &compiler, const std::string &riscv_sim,
+	const std::string &corpus_dir, const std::string &out_dir, const std::string &name)
+{
+	Result result = {name, {}, Mix(MIX_CLASS_CNT, 0), false, false, -1, false, ""};
+	auto src = corpus_dir + "/" + name + ".sy";
+	auto in = corpus_dir + "/" + name + ".in";
+	if(!std::filesystem::exists(in))
+		in = "/dev/null";
+	auto expected = read_file(corpus_dir + "/" + name + ".out");
+	auto prefix = out_dir + "/" + name;
+
+	static const std::pair<const char *, const char *> modes[] = {
+		{"-e", ".e"}, {"-t", ".t"}, {"", ".s"}
+	};
+	for(const auto &[flag, ext] : modes)
+		if(run(compiler + " " + flag + " " + src + " -o " + prefix + ext + " 2> " + prefix + ".log") != 0)
+		{
+			result.error = std::string("failed to compile, see ") + prefix + ".log";
+			return result;
+		}
+	result.metrics["eeyore_stmts"] = count_lines(prefix + ".e");
+	result.metrics["tigger_stmts"] = count_lines(prefix + ".t");
+	result.mix = count_mix(prefix + ".s", prefix + ".mix.txt");
+	long insts = 0;
+	for(long cnt : result.mix)
+		insts += cnt;
+	result.metrics["riscv_insts"] = insts;
+
+	int exit_code = run(compiler + " -r " + src + " < " + in + " > " + prefix + ".r.out 2> /dev/null");
+	result.interp_ok = check_output(prefix + ".r.out", exit_code, expected);
+
+	exit_code = run(riscv_sim + " " + prefix + ".s < " + in + " > " + prefix + ".sim.out 2> "
+		+ prefix + ".sim.txt");
+	result.sim_ok = check_output(prefix + ".sim.out", exit_code, expected);
+	auto stats = read_file(prefix + ".sim.txt");
+	result.metrics["sim_insts"] = read_stat(stats, "instructions retired");
+	result.metrics["sim_cycles"] = read_stat(stats, "cycles");
+
+	const char *riscv_cc = std::getenv("RISCV_CC"), *riscv_emu = std::getenv("RISCV_EMU");
+	if(riscv_cc != nullptr && riscv_emu != nullptr
+		&& run(std::string(riscv_cc) + " " + prefix + ".s -o " + prefix + ".elf") == 0)
+	{
+		auto start_time = std::chrono::steady_clock::now();
+		exit_code = run(std::string(riscv_emu) + " " + prefix + ".elf < " + in + " > " + prefix
+			+ ".emu.out 2> /dev/null");
+		result.emu_ms = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start_time).count();
+		result.emu_ok = check_output(prefix + ".emu.out", exit_code, expected);
+	}
+	return result;
+}
+
+// The baseline is "<program> <metric> <value>" per line.
+std::map<std::string, double> read_baseline(const std::string &filename)
+{
+	std::map<std::string, double> baseline;
+	std::ifstream fin(filename);
+	std::string program, metric;
+	double value;
+	while(fin >> program >> metric >> value)
+		baseline[program + " " + metric] = value;
+	return baseline;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	if(argc < 5)
+	{
+		std::fprintf(stderr, "usage: %s <compiler> <riscv_sim> <corpus_dir> <out_dir> [-u]\n", argv[0]);
+		return 1;
+	}
+	std::string compiler = argv[1], riscv_sim = argv[2], corpus_dir = argv[3], out_dir = argv[4];
+	bool update_baseline = argc > 5 && std::strcmp(argv[5], "-u") == 0;
+	std::filesystem::create_directories(out_dir);
+
+	std::vector<std::string> names;
+	for(const auto &entry : std::filesystem::directory_iterator(corpus_dir))
+		if(entry.path().extension() == ".sy")
+			names.push_back(entry.path().stem().string());
+	std::sort(names.begin(), names.end());
+
+	bool failed = false;
+	std::vector<Result> results;
+	std::printf("%-10s", "program");
+	for(const char *metric : METRICS)
+		std::printf(" %13s", metric);
+	std::printf(" %10s %s\n", "emu_ms", "outputs (interp, sim, emu)");
+	for(const auto &name : names)
+	{
+		auto result = bench_program(compiler, riscv_sim, corpus_dir, out_dir, name);
+		std::printf("%-10s", name.c_str());
+		if(!result.error.empty())
+		{
+			std::printf(" %s\n", result.error.c_str());
+			failed = true;
+			continue;
+		}
+		for(const char *metric : METRICS)
+			std::printf(" %13.0f", result.metrics[metric]);
+		if(result.emu_ms < 0)
+			std::printf(" %10s", "-");
+		else
+			std::printf(" %10.1f", result.emu_ms);
+		std::printf(" %s %s %s\n", result.interp_ok? "ok" : "WRONG", result.sim_ok? "ok" : "WRONG",
+			result.emu_ms < 0? "-" : result.emu_ok? "ok" : "WRONG");
+		failed |= !result.interp_ok || !result.sim_ok || (result.emu_ms >= 0 && !result.emu_ok);
+		results.push_back(std::move(result));
+	}
+
+	std::printf("\n%-10s", "mix");
+	for(const char *mix_class : MIX_CLASSES)
+		std::printf(" %8s", mix_class);
+	std::printf("\n");
+	for(const auto &result : results)
+	{
+		std::printf("%-10s", result.name.c_str());
+		for(long cnt : result.mix)
+			std::printf(" %8ld", cnt);
+		std::printf("\n");
+	}
+
+	auto baseline_filename = corpus_dir + "/baseline.txt";
+	if(update_baseline)
+	{
+		std::ofstream fout(baseline_filename);
+		for(const auto &result : results)
+			for(const char *metric : METRICS)
+				fout << result.name << ' ' << metric << ' ' << long(result.metrics.at(metric)) << '\n';
+		std::printf("\nbaseline written to %s\n", baseline_filename.c_str());
+		return failed? 1 : 0;
+	}
+
+	auto baseline = read_baseline(baseline_filename);
+	std::printf("\n");
+	for(const auto &result : results)
+		for(const char *metric : METRICS)
+		{
+			auto iter = baseline.find(result.name + " " + metric);
+			if(iter == baseline.end())
+				continue;
+			double base = iter->second, curr = result.metrics.at(metric);
+			if(curr > base * (1 + REGRESSION_TOLERANCE))
+			{
+				std::printf("regression: %s %s %.0f -> %.0f (%+.1f%%)\n", result.name.c_str(), metric,
+					base, curr, (curr / base - 1) * 100);
+				failed = true;
+			}
+			else if(curr < base)
+				std::printf("improved: %s %s %.0f -> %.0f (%+.1f%%)\n", result.name.c_str(), metric,
+					base, curr, (curr / base - 1) * 100);
+		}
+	std::printf("%s\n", failed? "FAILED" : "passed");
+	return failed? 1 : 0;
+}
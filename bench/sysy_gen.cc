@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "sysy_gen.h"
+
+namespace compiler::bench
+{
+
+namespace
+{
+
+// The columns of the 2-dimensional global array.
+constexpr int MATRIX_COLS = 8;
+// Maximum trip count of a generated while loop.
+constexpr int MAX_TRIP_CNT = 4;
+// Calls allowed for each call from main.
+constexpr int CALL_BUDGET = 64;
+
+// The generated program:
+//   int budget;
+//   int g0[G] = {...}; int g1[G]; int gm[G / 8][8] = {{...}, ...};
+//   int f<k>(int a, int b, int arr[]) {
+//     if (budget <= 0) return a - b;
+//     budget = budget - 1;
+//     int t0 = a + 0; ... int l[I + 8] = {...};
+//     <statements>
+//     return ...;
+//   }
+//   int main() { calls every function once with a new budget, prints the sum }
+class SysyGenerator
+{
+  protected:
+	struct Array
+	{
+		std::string name;
+		int size;
+	};
+
+	const SysyGenParams &_params;
+	std::ostream &_out;
+	std::mt19937 _rng;
+	int _func_id;
+	int _loop_depth; // The while loops around the current statement.
+	int _loop_cnt; // The while loops of the function, naming the counters.
+	int _matrix_rows;
+	std::vector<Array> _arrays; // The 1-dimensional arrays visible in the function.
+
+	inline int _rand(int n) { return static_cast<int>(_rng() % n); }
+	inline bool _chance(int percent) { return _rand(100) < percent; }
+	inline void _indent(int depth) { _out << std::string(depth + 1, '\t'); }
+
+	std::string _temp();
+	std::string _index(int size);
+	std::string _operand();
+	std::string _expr(int level = 0);
+	std::string _cond();
+	std::string _initializer(int size);
+
+	void _gen_globals();
+	void _gen_func();
+	void _gen_main();
+	void _gen_stmts(int depth, int &budget);
+	void _gen_stmt(int depth, int &budget);
+
+  public:
+	SysyGenerator(std::ostream &out, const SysyGenParams &params)
+	  : _params(params), _out(out), _rng(params.seed), _func_id(0), _loop_depth(0), _loop_cnt(0),
+		_matrix_rows(std::max(params.global_array_size / MATRIX_COLS, 1)) {}
+
+	void generate();
+};
+
+std::string SysyGenerator::_temp()
+{
+	return "t" + std::to_string(_rand(std::max(_params.temp_cnt, 1)));
+}
+
+// An index always in [0, size).
+std::string SysyGenerator::_index(int size)
+{
+	auto size_str = std::to_string(size);
+	return "(" + _temp() + " % " + size_str + " + " + size_str + ") % " + size_str;
+}
+
+std::string SysyGenerator::_operand()
+{
+	int r = _rand(100);
+	if(r < 50)
+		return _temp();
+	if(r < 65)
+		return _rand(2) == 0? "a" : "b";
+	if(r < 80)
+		return std::to_string(_rand(100));
+	if(r < 90)
+	{
+		const auto &array = _arrays[_rand(_arrays.size())];
+		return array.name + "[" + _index(array.size) + "]";
+	}
+	return "gm[" + _index(_matrix_rows) + "][" + _index(MATRIX_COLS) + "]";
+}
+
+std::string SysyGenerator::_expr(int level)
+{
+	if(level >= 2 || _chance(40))
+		return _operand();
+	switch(_rand(5))
+	{
+	case 0:
+		return "(" + _expr(level + 1) + " + " + _expr(level + 1) + ")";
+	case 1:
+		return "(" + _expr(level + 1) + " - " + _expr(level + 1) + ")";
+	case 2:
+		return _expr(level + 1) + " * " + std::to_string(_rand(7) + 1);
+	case 3:
+		return _expr(level + 1) + " / " + std::to_string(_rand(7) + 1);
+	default:
+		return "-" + _operand();
+	}
+}
+
+std::string SysyGenerator::_cond()
+{
+	static const char *rel_ops[] = {"<", ">", "<=", ">=", "==", "!="};
+	auto rel = [&]() { return _expr(1) + " " + rel_ops[_rand(6)] + " " + _expr(1); };
+	switch(_rand(4))
+	{
+	case 0:
+		return rel() + " && " + rel();
+	case 1:
+		return rel() + " || " + rel();
+	case 2:
+		return "!(" + rel() + ")";
+	default:
+		return rel();
+	}
+}
+
+// Initializes the first init_size elements, or all if fewer.
+std::string SysyGenerator::_initializer(int size)
+{
+	std::string ret = "{";
+	int cnt = std::min(_params.init_size, size);
+	for(int i = 0; i < cnt; i++)
+		ret += (i == 0? "" : ", ") + std::to_string(_rand(1000));
+	return ret + "}";
+}
+
+void SysyGenerator::_gen_globals()
+{
+	int size = std::max(_params.global_array_size, 1);
+	_out << "int budget;\n";
+	_out << "int g0[" << size << "] = " << _initializer(size) << ";\n";
+	_out << "int g1[" << size << "];\n";
+
+	// A nested initializer, with rows of different lengths.
+	_out << "int gm[" << _matrix_rows << "][" << MATRIX_COLS << "] = {";
+	int init_rows = std::min(_matrix_rows, (_params.init_size + MATRIX_COLS - 1) / MATRIX_COLS);
+	for(int i = 0; i < init_rows; i++)
+	{
+		_out << (i == 0? "{" : ", {");
+		for(int j = 0; j < i % (MATRIX_COLS + 1); j++)
+			_out << (j == 0? "" : ", ") << _rand(1000);
+		_out << "}";
+	}
+	_out << "};\n\n";
+}
+
+void SysyGenerator::_gen_func()
+{
+	int local_size = _params.init_size + 8;
+	int global_size = std::max(_params.global_array_size, 1);
+	_arrays = {{"g0", global_size}, {"g1", global_size}, {"arr", global_size}, {"l", local_size}};
+
+	_out << "int f" << _func_id << "(int a, int b, int arr[])\n{\n";
+	_out << "\tif (budget <= 0) return a - b;\n";
+	_out << "\tbudget = budget - 1;\n";
+	for(int i = 0; i < std::max(_params.temp_cnt, 1); i++)
+		_out << "\tint t" << i << " = " << (i % 2 == 0? "a" : "b") << " + " << i << ";\n";
+	_out << "\tint l[" << local_size << "] = " << _initializer(local_size) << ";\n";
+
+	_loop_cnt = 0;
+	int budget = _params.stmts_per_func;
+	_gen_stmts(0, budget);
+
+	_out << "\treturn " << _temp() << " + " << _temp() << " + l[" << _index(local_size) << "];\n";
+	_out << "}\n\n";
+}
+
+void SysyGenerator::_gen_main()
+{
+	int global_size = std::max(_params.global_array_size, 1);
+	_out << "int main()\n{\n";
+	_out << "\tint sum = 0;\n";
+	for(int i = 0; i < _params.func_cnt; i++)
+	{
+		_out << "\tbudget = " << CALL_BUDGET << ";\n";
+		_out << "\tsum = sum + f" << i << "(" << i << ", sum, g1);\n";
+	}
+	_out << "\tputint(sum);\n";
+	_out << "\tputch(10);\n";
+	_out << "\tputarray(" << std::min(global_size, 16) << ", g1);\n";
+	_out << "\treturn 0;\n";
+	_out << "}\n";
+}
+
+void SysyGenerator::_gen_stmts(int depth, int &budget)
+{
+	while(budget > 0)
+		_gen_stmt(depth, budget);
+}
+
+void SysyGenerator::_gen_stmt(int depth, int &budget)
+{
+	budget--;
+	int r = _rand(100);
+	if(r < _params.call_percent && _func_id > 0)
+	{
+		static const char *array_args[] = {"g0", "g1", "arr"};
+		_indent(depth);
+		_out << _temp() << " = f" << _rand(_func_id) << "(" << _expr(1) << ", " << _expr(1)
+			<< ", " << array_args[_rand(3)] << ");\n";
+		return;
+	}
+
+	r = _rand(100);
+	bool can_nest = depth < _params.max_depth && budget > 0;
+	if(r < 15 && can_nest)
+	{
+		// if, with or without else.
+		int body_budget = std::min(budget, _rand(8) + 1);
+		budget -= body_budget;
+		_indent(depth);
+		_out << "if (" << _cond() << ") {\n";
+		_gen_stmts(depth + 1, body_budget);
+		_indent(depth);
+		if(budget > 0 && _chance(50))
+		{
+			int else_budget = std::min(budget, _rand(8) + 1);
+			budget -= else_budget;
+			_out << "} else {\n";
+			_gen_stmts(depth + 1, else_budget);
+			_indent(depth);
+		}
+		_out << "}\n";
+	}
+	else if(r < 27 && can_nest)
+	{
+		// A loop of at most MAX_TRIP_CNT iterations. The counter is increased
+		// first, so that continue can not skip it.
+		int body_budget = std::min(budget, _rand(8) + 1);
+		budget -= body_budget;
+		auto counter = "i" + std::to_string(_loop_cnt++);
+		_indent(depth);
+		_out << "int " << counter << " = 0;\n";
+		_indent(depth);
+		_out << "while (" << counter << " < " << _rand(MAX_TRIP_CNT) + 1 << ") {\n";
+		_indent(depth + 1);
+		_out << counter << " = " << counter << " + 1;\n";
+		_loop_depth++;
+		_gen_stmts(depth + 1, body_budget);
+		_loop_depth--;
+		_indent(depth);
+		_out << "}\n";
+	}
+	else if(r < 32 && _loop_depth > 0)
+	{
+		_indent(depth);
+		_out << "if (" << _cond() << ") " << (_rand(2) == 0? "break" : "continue") << ";\n";
+	}
+	else if(r < 55)
+	{
+		const auto &array = _arrays[_rand(_arrays.size())];
+		_indent(depth);
+		_out << array.name << "[" << _index(array.size) << "] = " << _expr() << ";\n";
+	}
+	else
+	{
+		_indent(depth);
+		_out << _temp() << " = " << _expr() << ";\n";
+	}
+}
+
+void SysyGenerator::generate()
+{
+	_gen_globals();
+	for(_func_id = 0; _func_id < _params.func_cnt; _func_id++)
+		_gen_func();
+	_gen_main();
+}
+
+} // namespace
+
+void generate_sysy(std::ostream &out, const SysyGenParams &params)
+{
+	SysyGenerator(out, params).generate();
+}
+
+} // namespace compiler::bench
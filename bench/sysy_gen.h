@@ -0,0 +1,31 @@
+#ifndef SYSY_GEN_H
+#define SYSY_GEN_H
+
+#include <iostream>
+
+namespace compiler::bench
+{
+
+// The shape of a synthetic SysY program.
+struct SysyGenParams
+{
+	int func_cnt = 16;
+	int stmts_per_func = 64; // Statements of a function, counting the nested ones.
+	int max_depth = 3; // Nesting of if and while statements.
+	int temp_cnt = 16; // Local int variables of each function.
+	int global_array_size = 256; // Elements of each global array.
+	int init_size = 64; // Initialized elements of the global and local arrays.
+	int call_percent = 10; // Chance of a statement to be a function call.
+	unsigned seed = 1;
+};
+
+// Writes a valid SysY program of the given shape. The same parameters always
+// give the same program.
+// A function only calls the functions before it, and every call takes one
+// from a global budget reset by main, so the program always terminates in
+// bounded time.
+void generate_sysy(std::ostream &out, const SysyGenParams &params);
+
+} // namespace compiler::bench
+
+#endif
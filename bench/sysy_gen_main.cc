@@ -0,0 +1,42 @@
+// Writes a synthetic SysY program to stdout.
+// usage: sysy_gen [-f funcs] [-s stmts_per_func] [-d max_depth] [-t temps]
+//                 [-g global_array_size] [-i init_size] [-c call_percent] [-r seed]
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "sysy_gen.h"
+
+using compiler::bench::SysyGenParams;
+
+int main(int argc, char *argv[])
+{
+	SysyGenParams params;
+	for(int i = 1; i < argc - 1; i += 2)
+	{
+		int value = std::atoi(argv[i + 1]);
+		if(std::strcmp(argv[i], "-f") == 0)
+			params.func_cnt = value;
+		else if(std::strcmp(argv[i], "-s") == 0)
+			params.stmts_per_func = value;
+		else if(std::strcmp(argv[i], "-d") == 0)
+			params.max_depth = value;
+		else if(std::strcmp(argv[i], "-t") == 0)
+			params.temp_cnt = value;
+		else if(std::strcmp(argv[i], "-g") == 0)
+			params.global_array_size = value;
+		else if(std::strcmp(argv[i], "-i") == 0)
+			params.init_size = value;
+		else if(std::strcmp(argv[i], "-c") == 0)
+			params.call_percent = value;
+		else if(std::strcmp(argv[i], "-r") == 0)
+			params.seed = value;
+		else
+		{
+			std::cerr << "unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+	compiler::bench::generate_sysy(std::cout, params);
+	return 0;
+}
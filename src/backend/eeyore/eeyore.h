@@ -3,8 +3,11 @@
 
 #include <string>
 #include <variant>
+#include <vector>
 #include <optional>
 #include "ast_node.h"
+#include "stmt_list.h"
+#include "symbol.h"
 
 namespace compiler::backend::eeyore
 {
@@ -17,26 +20,43 @@ struct Label
 struct VarBase
 {
 	int id;
-	VarBase(int _id): id(_id) {}
+	int uid; // The dense id of a variable among all the variables (of all kinds)
+			 // of a program, assigned by EeyoreGenerator. Used to index side
+			 // tables in the backend.
+	VarBase(int _id, int _uid): id(_id), uid(_uid) {}
 };
 struct OrigVar: public VarBase
 {
 	int size;
-	OrigVar(int _id, int _size=sizeof(int)): VarBase(_id), size(_size) {}
+	OrigVar(int _id, int _uid, int _size=sizeof(int)): VarBase(_id, _uid), size(_size) {}
 	bool operator == (const OrigVar &other) const { return id == other.id; }
 };
 struct TempVar: public VarBase
 {
-	TempVar(int _id): VarBase(_id) {}
+	TempVar(int _id, int _uid): VarBase(_id, _uid) {}
 	bool operator == (const TempVar &other) const { return id == other.id; }
 };
 struct Param: public VarBase
 {
-	Param(int _id): VarBase(_id) {}
+	// Parameters of different functions have different uids, even if they
+	// have the same id.
+	Param(int _id, int _uid): VarBase(_id, _uid) {}
 	bool operator == (const Param &other) const { return id == other.id; }
 };
 using Operand = std::variant<int, OrigVar, TempVar, Param>;
 
+// The uid of an operand, or -1 if it is an immediate number.
+inline int uid_of(const Operand &opr)
+{
+	if(std::holds_alternative<int>(opr))
+		return -1;
+	if(std::holds_alternative<OrigVar>(opr))
+		return std::get<OrigVar>(opr).uid;
+	if(std::holds_alternative<TempVar>(opr))
+		return std::get<TempVar>(opr).uid;
+	return std::get<Param>(opr).uid;
+}
+
 struct DeclStmt
 {
 	Operand var;
@@ -45,18 +65,18 @@ struct DeclStmt
 };
 struct FuncDefStmt
 {
-	std::string func_name;
+	utils::Symbol func_name; // With the "f_" prefix.
 	int arg_cnt;
 
-	FuncDefStmt(std::string _func_name, int _arg_cnt)
-	  : func_name("f_" + _func_name), arg_cnt(_arg_cnt) {}
+	FuncDefStmt(utils::Symbol _func_name, int _arg_cnt)
+	  : func_name(_func_name), arg_cnt(_arg_cnt) {}
 };
 struct EndFuncDefStmt
 {
-	std::string func_name;
+	utils::Symbol func_name;
 
-	EndFuncDefStmt(std::string _func_name)
-	  : func_name("f_" + _func_name) {}
+	EndFuncDefStmt(utils::Symbol _func_name)
+	  : func_name(_func_name) {}
 };
 
 struct ParamStmt
@@ -68,14 +88,14 @@ struct ParamStmt
 
 struct FuncCallStmt
 {
-	std::string func_name;
+	utils::Symbol func_name;
 	std::optional<Operand> retval_receiver;
 
-	FuncCallStmt(std::string _func_name)
-	  : func_name("f_" + _func_name), retval_receiver(std::nullopt)
+	FuncCallStmt(utils::Symbol _func_name)
+	  : func_name(_func_name), retval_receiver(std::nullopt)
 	{}
-	FuncCallStmt(std::string _func_name, Operand _retval_receiver)
-	  : func_name("f_" + _func_name), retval_receiver(_retval_receiver)
+	FuncCallStmt(utils::Symbol _func_name, Operand _retval_receiver)
+	  : func_name(_func_name), retval_receiver(_retval_receiver)
 	{}
 };
 struct RetStmt
@@ -167,6 +187,37 @@ using EeyoreStatement = std::variant
 	LabelStmt
 >;
 
+// Statement ids of the code are the indices in it, once it is compact.
+using EeyoreCode = utils::StmtList<EeyoreStatement>;
+
+// A basic block of a function, which is the statements with id in
+// [begin_stmt_id, end_stmt_id). It begins with a label or after a jump, and
+// only its last statement may be a jump. The EndFuncDefStmt is in the block of
+// the RetStmt before it.
+struct EeyoreBlock
+{
+	int begin_stmt_id;
+	int end_stmt_id;
+	std::vector<int> succ_ids; // Indices of the blocks in the function.
+};
+
+// A function, which is the statements with id in [begin_stmt_id, end_stmt_id)
+// from its FuncDefStmt to its EndFuncDefStmt, with its basic blocks in order.
+// The first block begins with the FuncDefStmt.
+struct EeyoreFunc
+{
+	int begin_stmt_id;
+	int end_stmt_id;
+	std::vector<EeyoreBlock> blocks;
+	// The statements initializing global variables with constants, i.e.
+	// "T0 = 1" and "T1[4] = 1", with id in [static_init_begin_stmt_id,
+	// static_init_end_stmt_id). They are in the first block of f_main, and
+	// none for the other functions. A backend may put the values in static
+	// data instead of running them.
+	int static_init_begin_stmt_id;
+	int static_init_end_stmt_id;
+};
+
 std::vector<Operand> used_vars(const EeyoreStatement &stmt);
 std::vector<Operand> defined_vars(const EeyoreStatement &stmt);
 
@@ -0,0 +1,341 @@
+#include "dbg.h"
+#include "visitor_helper.h"
+#include "eeyore_gen.h"
+
+using std::holds_alternative;
+
+namespace
+{
+
+using compiler::backend::eeyore::EeyoreStatement;
+using compiler::backend::eeyore::GotoStmt;
+using compiler::backend::eeyore::CondGotoStmt;
+using compiler::backend::eeyore::Label;
+
+compiler::utils::LambdaVisitor label_getter = {
+	[](GotoStmt &stmt) -> Label * { return &stmt.goto_label; },
+	[](CondGotoStmt &stmt) -> Label * { return &stmt.goto_label; },
+	[](auto &) -> Label * { return nullptr; }
+};
+
+// The label of a jump statement, or nullptr for other statements.
+inline Label *jump_label_of(EeyoreStatement &stmt)
+{
+	return std::visit(label_getter, stmt);
+}
+
+// Whether a global statement stores a constant to a global variable, i.e.
+// "T0 = 1" or "T0[4] = 1".
+bool is_static_init(const EeyoreStatement &stmt)
+{
+	using namespace compiler::backend::eeyore;
+	if(holds_alternative<MoveStmt>(stmt))
+	{
+		const auto &move = std::get<MoveStmt>(stmt);
+		return holds_alternative<OrigVar>(move.opr) && holds_alternative<int>(move.opr1);
+	}
+	if(holds_alternative<WriteArrStmt>(stmt))
+	{
+		const auto &write = std::get<WriteArrStmt>(stmt);
+		return holds_alternative<OrigVar>(write.arr_opr) && holds_alternative<int>(write.idx_opr)
+			&& holds_alternative<int>(write.opr);
+	}
+	return false;
+}
+
+} // namespace
+
+namespace compiler::backend::eeyore
+{
+
+void EeyoreGenerator::CodeBuilder::clear()
+{
+	_global_inits.clear();
+	_global_static_inits.clear();
+	_global_decls.clear();
+	_main_decls_back.reset();
+	_main_func_id = -1;
+	_label_parents.clear();
+	_label_uses.clear();
+	_new_label_ids.clear();
+	_new_label_cnt = 0;
+	_func_def.reset();
+	_func_decls.clear();
+	_func_body.clear();
+	_reachable = true;
+}
+
+// The root of a label in the union-find forest, with path compression. A
+// label placed in the body is always a root.
+int EeyoreGenerator::CodeBuilder::_find_label(int label_id)
+{
+	int root = label_id;
+	while(_label_parents[root] != root)
+		root = _label_parents[root];
+	while(_label_parents[label_id] != root)
+	{
+		int parent = _label_parents[label_id];
+		_label_parents[label_id] = root;
+		label_id = parent;
+	}
+	return root;
+}
+
+// Makes room for a new label. The labels are created by ResourceManager.
+void EeyoreGenerator::CodeBuilder::_add_label(int label_id)
+{
+	for(int id = _label_parents.size(); id <= label_id; id++)
+	{
+		_label_parents.push_back(id);
+		_label_uses.push_back(0);
+		_new_label_ids.push_back(-1);
+	}
+}
+
+// Whether the end of the body can be reached from the statement before it.
+bool EeyoreGenerator::CodeBuilder::_body_falls_through() const
+{
+	return _func_body.empty() || (!holds_alternative<GotoStmt>(_func_body.back())
+		&& !holds_alternative<RetStmt>(_func_body.back()));
+}
+
+void EeyoreGenerator::CodeBuilder::_place_label(int label_id)
+{
+	_add_label(label_id);
+	if(!_func_body.empty() && holds_alternative<LabelStmt>(_func_body.back()))
+	{
+		// Merged into the label right before it.
+		int root = std::get<LabelStmt>(_func_body.back()).label.id;
+		_label_parents[label_id] = root;
+		_label_uses[root] += _label_uses[label_id];
+	}
+	else if(_reachable || _label_uses[label_id] > 0)
+	{
+		_func_body.emplace_back(LabelStmt(label_id));
+		_reachable = true;
+	}
+	else
+	{
+		// Neither fallen through nor jumped to. It is never jumped to later
+		// either, since a jump back to it can only be after it, which cannot
+		// be reached.
+		DBG(std::cout << "dropping label l" << label_id << std::endl);
+		return;
+	}
+	_drop_jumps_to_next();
+}
+
+// Drops the jumps right before the label at the end of the body to it.
+void EeyoreGenerator::CodeBuilder::_drop_jumps_to_next()
+{
+	int root = std::get<LabelStmt>(_func_body.back()).label.id;
+	while(_func_body.size() >= 2)
+	{
+		auto prev = _func_body.end() - 2;
+		Label *label = jump_label_of(*prev);
+		if(label == nullptr || _find_label(label->id) != root)
+			break;
+		_label_uses[root]--;
+		_func_body.erase(prev);
+	}
+}
+
+// Emits a reachable jump. A goto right after a label is threaded: the label
+// is merged into the goto target, unless the goto jumps to itself.
+void EeyoreGenerator::CodeBuilder::_emit_jump(EeyoreStatement &&stmt)
+{
+	Label *label = jump_label_of(stmt);
+	_add_label(label->id);
+	int target = _find_label(label->id);
+	if(holds_alternative<GotoStmt>(stmt) && !_func_body.empty()
+		&& holds_alternative<LabelStmt>(_func_body.back()))
+	{
+		int root = std::get<LabelStmt>(_func_body.back()).label.id;
+		if(root != target)
+		{
+			_label_parents[root] = target;
+			_label_uses[target] += _label_uses[root];
+			_func_body.pop_back();
+			_reachable = _body_falls_through();
+			if(!_reachable) // Only jumped to, so the goto is not needed.
+				return;
+		}
+	}
+	_label_uses[target]++;
+	_reachable = !holds_alternative<GotoStmt>(stmt);
+	_func_body.push_back(std::move(stmt));
+}
+
+void EeyoreGenerator::CodeBuilder::emit(EeyoreStatement &&stmt)
+{
+	if(holds_alternative<FuncDefStmt>(stmt))
+	{
+		INTERNAL_ASSERT(!_func_def.has_value(), "nested function definition");
+		_func_def = std::get<FuncDefStmt>(stmt);
+		_reachable = true;
+	}
+	else if(holds_alternative<EndFuncDefStmt>(stmt))
+		_end_func(std::get<EndFuncDefStmt>(std::move(stmt)));
+	else if(!_func_def.has_value())
+	{
+		INTERNAL_ASSERT(!holds_alternative<LabelStmt>(stmt) && jump_label_of(stmt) == nullptr
+			&& !holds_alternative<RetStmt>(stmt), "control flow out of functions");
+		if(holds_alternative<DeclStmt>(stmt) && holds_alternative<OrigVar>(std::get<DeclStmt>(stmt).var))
+			_global_decls.push_back(std::move(stmt));
+		else if(is_static_init(stmt))
+			_global_static_inits.push_back(std::move(stmt));
+		else
+			_global_inits.push_back(std::move(stmt));
+	}
+	else if(holds_alternative<DeclStmt>(stmt))
+		_func_decls.push_back(std::move(stmt));
+	else if(holds_alternative<LabelStmt>(stmt))
+		_place_label(std::get<LabelStmt>(stmt).label.id);
+	else if(!_reachable)
+		DBG(std::cout << "dropping unreachable " << stmt);
+	else if(jump_label_of(stmt) != nullptr)
+		_emit_jump(std::move(stmt));
+	else
+	{
+		_reachable = !holds_alternative<RetStmt>(stmt);
+		_func_body.push_back(std::move(stmt));
+	}
+}
+
+// Appends the function to the code, and splits it into blocks.
+void EeyoreGenerator::CodeBuilder::_end_func(EndFuncDefStmt &&stmt)
+{
+	INTERNAL_ASSERT(_func_def.has_value(), "end of a function not defined");
+
+	// Number the labels jumped to in order, which are consecutive.
+	int first_label_id = _new_label_cnt;
+	for(const auto &body_stmt : _func_body)
+	{
+		if(!holds_alternative<LabelStmt>(body_stmt))
+			continue;
+		int label_id = std::get<LabelStmt>(body_stmt).label.id;
+		if(_label_uses[label_id] > 0)
+			_new_label_ids[label_id] = _new_label_cnt++;
+	}
+
+	EeyoreFunc func;
+	func.begin_stmt_id = _code.size();
+	func.static_init_begin_stmt_id = func.static_init_end_stmt_id = func.begin_stmt_id;
+	static const utils::Symbol main_name("f_main"); // Interned only once.
+	bool is_main = _func_def->func_name == main_name;
+	_code.emplace_back(std::move(_func_def.value()));
+	for(auto &decl : _func_decls)
+		_code.emplace_back(std::move(decl));
+	if(is_main)
+	{
+		_main_decls_back = std::prev(_code.end());
+		_main_func_id = _funcs.size();
+		func.static_init_begin_stmt_id = func.static_init_end_stmt_id = _code.size();
+	}
+
+	// A block begins with a label, or after a jump or a return.
+	std::vector<int> label_blocks; // Indexed by new label id - first_label_id.
+	func.blocks.push_back({func.begin_stmt_id, -1, {}});
+	auto begin_block = [&, this]() {
+		func.blocks.back().end_stmt_id = _code.size();
+		func.blocks.push_back({_code.size(), -1, {}});
+	};
+	bool block_ended = false;
+	for(auto &body_stmt : _func_body)
+	{
+		if(holds_alternative<LabelStmt>(body_stmt))
+		{
+			Label &label = std::get<LabelStmt>(body_stmt).label;
+			if(_label_uses[label.id] == 0)
+				continue;
+			begin_block();
+			label = Label(_new_label_ids[label.id]);
+			label_blocks.push_back(func.blocks.size() - 1);
+			block_ended = false;
+		}
+		else
+		{
+			if(block_ended)
+				begin_block();
+			if(Label *label = jump_label_of(body_stmt); label != nullptr)
+			{
+				int new_label_id = _new_label_ids[_find_label(label->id)];
+				INTERNAL_ASSERT(new_label_id >= 0, "jump to a label not placed");
+				*label = Label(new_label_id);
+				block_ended = true;
+			}
+			else
+				block_ended = holds_alternative<RetStmt>(body_stmt);
+		}
+		_code.emplace_back(std::move(body_stmt));
+	}
+	if(block_ended && !holds_alternative<RetStmt>(_code.back()))
+		begin_block();
+	_code.emplace_back(std::move(stmt));
+	func.end_stmt_id = _code.size();
+	func.blocks.back().end_stmt_id = _code.size();
+
+	// The code is still compact, since it is only appended.
+	int block_cnt = func.blocks.size();
+	for(int block_id = 0; block_id < block_cnt; block_id++)
+	{
+		auto &block = func.blocks[block_id];
+		const auto &last = _code[block.end_stmt_id - 1];
+		if(holds_alternative<GotoStmt>(last))
+			block.succ_ids.push_back(label_blocks[std::get<GotoStmt>(last).goto_label.id - first_label_id]);
+		else if(holds_alternative<CondGotoStmt>(last))
+		{
+			int goto_when_true = label_blocks[std::get<CondGotoStmt>(last).goto_label.id - first_label_id];
+			block.succ_ids.push_back(goto_when_true);
+			if(goto_when_true != block_id + 1)
+				block.succ_ids.push_back(block_id + 1);
+		}
+		else if(!holds_alternative<RetStmt>(last) && !holds_alternative<EndFuncDefStmt>(last))
+			block.succ_ids.push_back(block_id + 1);
+	}
+	DBG(std::cout << func.blocks.size() << " blocks built" << std::endl);
+	_funcs.push_back(std::move(func));
+
+	_func_def.reset();
+	_func_decls.clear();
+	_func_body.clear();
+	_reachable = true;
+}
+
+// The global declarations are put before the functions, and the inits after
+// the declarations of f_main. They are all in the first block of f_main.
+void EeyoreGenerator::CodeBuilder::finish()
+{
+	INTERNAL_ASSERT(!_func_def.has_value(), "function without end");
+	INTERNAL_ASSERT(_main_decls_back.has_value(), "no main function");
+	int global_decl_cnt = _global_decls.size();
+	int global_init_cnt = _global_static_inits.size() + _global_inits.size();
+	auto funcs_begin = _code.begin();
+	for(auto &decl : _global_decls)
+		_code.emplace(funcs_begin, std::move(decl));
+	auto main_body_begin = std::next(_main_decls_back.value());
+	for(auto &init : _global_static_inits)
+		_code.emplace(main_body_begin, std::move(init));
+	for(auto &init : _global_inits)
+		_code.emplace(main_body_begin, std::move(init));
+	_code.compact(); // So that statement ids are the indices.
+	_funcs[_main_func_id].static_init_end_stmt_id += _global_static_inits.size();
+
+	for(int func_id = 0; func_id < (int)_funcs.size(); func_id++)
+	{
+		auto &func = _funcs[func_id];
+		int begin_shift = global_decl_cnt + (func_id > _main_func_id? global_init_cnt : 0);
+		int end_shift = global_decl_cnt + (func_id >= _main_func_id? global_init_cnt : 0);
+		func.begin_stmt_id += begin_shift;
+		func.end_stmt_id += end_shift;
+		func.static_init_begin_stmt_id += begin_shift;
+		func.static_init_end_stmt_id += begin_shift;
+		for(auto &block : func.blocks)
+		{
+			block.begin_stmt_id += &block == &func.blocks.front()? begin_shift : end_shift;
+			block.end_stmt_id += end_shift;
+		}
+	}
+}
+
+} // namespace compiler::backend::eeyore
@@ -1,7 +1,9 @@
 #include "dbg.h"
+#include <algorithm>
 #include <iostream>
 #include "exceptions.h"
 #include "visitor_helper.h"
+#include "time_report.h"
 #include "eeyore_gen.h"
 
 using std::optional;
@@ -11,100 +13,6 @@ using namespace compiler::frontend;
 namespace compiler::backend::eeyore
 {
 
-void EeyoreGenerator::EeyoreRearranger::rearrange(std::list<EeyoreStatement> &eeyore_code)
-{
-	DBG(std::cout << std::endl << "rearrangement begin" << std::endl);
-	std::list<EeyoreStatement> global_assignments;
-	auto func_begin = eeyore_code.end(),
-		 main_begin = eeyore_code.end(),
-		 global_def_end = eeyore_code.end();
-	
-	auto iter = eeyore_code.begin();
-
-	// Find the end of the global definition part. All the global definitions
-	// that occurs later are moved to here.
-	if(holds_alternative<DeclStmt>(*(eeyore_code.begin())))
-	{
-		for(++iter; iter != eeyore_code.end(); ++iter)
-		{
-			DBG(std::cout << "pre-analyzing: " << *iter);
-			if(!holds_alternative<DeclStmt>(*iter))
-			{
-				global_def_end = iter;
-				--global_def_end;
-				break;
-			}
-		}
-	}
-
-	while(iter != eeyore_code.end())
-	{
-		DBG(std::cout << "analyzing: " << *iter);
-
-		const auto &stmt = *iter;
-		if(holds_alternative<FuncDefStmt>(stmt))
-		{
-			DBG(std::cout << "a func def statement" << std::endl);
-			if(std::get<FuncDefStmt>(stmt).func_name == "f_main") // main function
-				main_begin = iter;
-			func_begin = iter;
-			++iter;
-		}
-		else if(holds_alternative<EndFuncDefStmt>(stmt))
-		{
-			DBG(std::cout << "a end func def statement" << std::endl);
-			func_begin = eeyore_code.end(); // reset func_begin
-			++iter;
-		}
-		else if(holds_alternative<DeclStmt>(stmt))
-		{
-			if(func_begin != eeyore_code.end())
-			{
-				DBG(std::cout << "a local decl statement" << std::endl);
-				func_begin = eeyore_code.insert(++func_begin, stmt);
-					// We would insert DeclStmts after func_begin, but list::insert
-					// inserts an element `before` a certain position, so increase
-					// the position by 1, then insert it, and finally reset func_begin
-					// to be the statement inserted.
-			}
-			else // A global DeclStmt, move it before global_def_end. 
-			{
-				auto var = std::get<DeclStmt>(stmt).var;
-				if(holds_alternative<OrigVar>(var))
-				{
-					DBG(std::cout << "a global T var decl statement" << std::endl);
-					if(global_def_end == eeyore_code.end()) // No global declaration at the beginning.
-						global_def_end = eeyore_code.insert(eeyore_code.begin(), stmt);
-					else
-						global_def_end = eeyore_code.insert(++global_def_end, stmt);
-				}
-				else
-				{
-					DBG(std::cout << "a global t var decl statement" << std::endl);
-					global_assignments.push_back(stmt);
-				}
-			}
-			iter = eeyore_code.erase(iter);
-		}
-		else if(func_begin == eeyore_code.end()) // non-decl statement in global, it must be a global assignment statement.
-		{
-			DBG(std::cout << "a global assignment" << std::endl);
-			global_assignments.push_back(stmt);
-			iter = eeyore_code.erase(iter);
-		}
-		else
-			++iter;
-	}
-	INTERNAL_ASSERT(main_begin != eeyore_code.end(), "no main function");
-	
-	// finally, add all the global assignments to the beginning of main
-	// after DeclStmt's
-	for(++main_begin; main_begin != eeyore_code.end(); ++main_begin)
-		if(!holds_alternative<DeclStmt>(*main_begin))
-			break;
-	eeyore_code.splice(main_begin, global_assignments);
-}
-
 void EeyoreGenerator::GeneratorState::reset_all()
 {
 	cont_break_label.reset();
@@ -113,10 +21,59 @@ void EeyoreGenerator::GeneratorState::reset_all()
 	write_operand.reset();
 	array_offset.reset();
 	access_index.clear();
-	curr_type.reset();
 	_is_global = true;
 }
 
+utils::Symbol EeyoreGenerator::eeyore_func_name(utils::Symbol name)
+{
+	auto [iter, inserted] = func_names.try_emplace(name);
+	if(inserted)
+		iter->second = utils::Symbol("f_" + name.str());
+	return iter->second;
+}
+
+// Zeroes the elements with index in [begin, end) of the local array. Less
+// than ZERO_LOOP_MIN elements are zeroed one by one, and more are zeroed by a
+// loop storing ZERO_UNROLL words each time through a pointer. The example
+// code to zero T0[2..21]:
+//   var t0
+//   var t1
+//   t0 = T0 + 8
+//   t1 = t0 + 64
+// l0:
+//   t0[0] = 0
+//   ...
+//   t0[28] = 0
+//   t0 = t0 + 32
+//   if t0 != t1 goto l0
+//   t0[0] = 0
+//   ...
+//   t0[12] = 0
+void EeyoreGenerator::zero_array(OrigVar arr, int begin, int end)
+{
+	if(end - begin < ZERO_LOOP_MIN)
+	{
+		for(int i = begin; i < end; i++)
+			builder.emit(WriteArrStmt(arr, i * (int)sizeof(int), 0));
+		return;
+	}
+
+	int loop_len = (end - begin) / ZERO_UNROLL * ZERO_UNROLL;
+	auto l0 = resources.get_label();
+	auto t0 = resources.get_temp_var(), t1 = resources.get_temp_var();
+	builder.emit(DeclStmt(t0));
+	builder.emit(DeclStmt(t1));
+	builder.emit(BinaryOpStmt(t0, arr, BinaryOpNode::ADD, begin * (int)sizeof(int)));
+	builder.emit(BinaryOpStmt(t1, t0, BinaryOpNode::ADD, loop_len * (int)sizeof(int)));
+	builder.emit(LabelStmt(l0));
+	for(int i = 0; i < ZERO_UNROLL; i++)
+		builder.emit(WriteArrStmt(t0, i * (int)sizeof(int), 0));
+	builder.emit(BinaryOpStmt(t0, t0, BinaryOpNode::ADD, ZERO_UNROLL * (int)sizeof(int)));
+	builder.emit(CondGotoStmt(t0, BinaryOpNode::NE, t1, l0));
+	for(int i = 0; i < end - begin - loop_len; i++)
+		builder.emit(WriteArrStmt(t0, i * (int)sizeof(int), 0));
+}
+
 optional<Operand> EeyoreGenerator::operator() (const ProgramNodePtr &node)
 {
 	for(const AstPtr &child : node->children())
@@ -137,38 +94,46 @@ optional<Operand> EeyoreGenerator::operator() (const SingleVarDeclNodePtr &node)
 	INTERNAL_ASSERT(holds_alternative<IdNodePtr>(node->lval()),
 		"expected an IdNode as lval of SingleVarDeclNodePtr");
 	const auto &id = std::get<IdNodePtr>(node->lval());
-	const std::string &id_name = id->name();
+	utils::Symbol id_name = id->name();
 	const TypePtr &id_type = node->type();
 
 	// Generate decl code.
 	int var_size = get_size(id_type);
 	auto orig_var = resources.get_original_var(var_size);
-	eeyore_code.emplace_back(DeclStmt(orig_var));
+	builder.emit(DeclStmt(orig_var));
 	table.insert(id_name, id_type, orig_var);
 
-	// Zero the local array using a loop before initializing it with initializer list.
-	// Global variables are initialized during semantic analysis.
-	// The example code to zero T0:
-	//   var t0
-	//   t0 = 0
-	// l0:
-	//   if t0 == var_size goto l1
-	//   T0[t0] = 0
-	//   t0 = t0 + 4
-	//   goto l0
-	// l1:
-	if(!state.is_global() && !is_basic(id_type))
+	// Zero the local array before initializing it. Global variables are
+	// zero-initialized. With an initializer list, only the elements it does
+	// not set to nonzero values are zeroed, so an array fully covered by it
+	// is not zeroed at all.
+	if(!state.is_global() && !is_basic(id_type) && is_null_ast(node->init_val()))
+		zero_array(orig_var, 0, var_size / sizeof(int));
+	else if(!state.is_global() && !is_basic(id_type))
 	{
-		auto l0 = resources.get_label(), l1 = resources.get_label();
-		auto t0 = resources.get_temp_var();
-		eeyore_code.emplace_back(DeclStmt(t0));
-		eeyore_code.emplace_back(MoveStmt(t0, 0));
-		eeyore_code.emplace_back(LabelStmt(l0));
-		eeyore_code.emplace_back(CondGotoStmt(t0, BinaryOpNode::EQ, var_size, l1));
-		eeyore_code.emplace_back(WriteArrStmt(orig_var, t0, 0));
-		eeyore_code.emplace_back(BinaryOpStmt(t0, t0, BinaryOpNode::ADD, 4));
-		eeyore_code.emplace_back(GotoStmt(l0));
-		eeyore_code.emplace_back(LabelStmt(l1));
+		const auto &flat = std::get<InitializerNodePtr>(node->init_val())->flat();
+		int len = var_size / sizeof(int);
+		int set_end = flat.vals.size(); // The elements from here are not set.
+		if(!flat.exprs.empty())
+			set_end = std::max(set_end, flat.exprs.back().first + 1);
+
+		int zero_begin = 0;
+		auto expr_iter = flat.exprs.begin();
+		for(int i = 0; i < set_end; i++)
+		{
+			bool is_set = i < (int)flat.vals.size() && flat.vals[i] != 0;
+			if(expr_iter != flat.exprs.end() && expr_iter->first == i)
+			{
+				is_set = true;
+				++expr_iter;
+			}
+			if(is_set)
+			{
+				zero_array(orig_var, zero_begin, i);
+				zero_begin = i + 1;
+			}
+		}
+		zero_array(orig_var, zero_begin, len);
 	}
 
 	// Generate initial value assignment code.
@@ -178,13 +143,10 @@ optional<Operand> EeyoreGenerator::operator() (const SingleVarDeclNodePtr &node)
 									   // Here we do not save the previous write_opr, since we
 									   // are alway in read mode when calling visitor method of
 									   // VarDeclNodePtr.
-		if(!is_basic(id_type)) // initialize an array with initializer list.
-			state.set_initializer_write(id_type);
 		std::visit(*this, node->init_val());
 
 		// Reset to read mode.
 		state.reset_write_opr();
-		state.reset_initializer_write();
 	}
 	DBG(std::cout << "end decl" << std::endl);
 	return std::nullopt;
@@ -210,11 +172,11 @@ optional<Operand> EeyoreGenerator::operator() (const ConstIntNodePtr &node)
 	if(state.is_write_mode())
 	{
 		if(state.is_write_array())
-			eeyore_code.emplace_back(WriteArrStmt(
+			builder.emit(WriteArrStmt(
 				state.write_opr(), state.arr_offset(), node->val()
 			));
 		else
-			eeyore_code.emplace_back(MoveStmt(
+			builder.emit(MoveStmt(
 				state.write_opr(), node->val()
 			));
 		DBG(std::cout << "exit from const int" << std::endl);
@@ -260,7 +222,7 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 	if(state.is_arr_access()) // calculate access offset.
 	{
 		Operand offset_opr = resources.get_temp_var();
-		eeyore_code.emplace_back(DeclStmt(offset_opr));
+		builder.emit(DeclStmt(offset_opr));
 
 		TypePtr type = find_res.value().type;
 		int const_offset = 0; // all the const offset are accumulated here.
@@ -300,7 +262,7 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 				if(idx_is_const) // Generate direct move stmt instead of add for the
 								 // first offset term.
 				{
-					eeyore_code.emplace_back(BinaryOpStmt(
+					builder.emit(BinaryOpStmt(
 						offset_opr, idx, BinaryOpNode::MUL, element_size
 					));
 					idx_is_const = false;
@@ -308,11 +270,11 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 				else // accumulate the offset.
 				{
 					TempVar tmp = resources.get_temp_var();
-					eeyore_code.emplace_back(DeclStmt(tmp));
-					eeyore_code.emplace_back(BinaryOpStmt(
+					builder.emit(DeclStmt(tmp));
+					builder.emit(BinaryOpStmt(
 						tmp, idx, BinaryOpNode::MUL, element_size
 					));
-					eeyore_code.emplace_back(BinaryOpStmt(
+					builder.emit(BinaryOpStmt(
 						offset_opr, offset_opr, BinaryOpNode::ADD, tmp
 					));
 				}
@@ -327,7 +289,7 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 		}
 		else if(const_offset != 0)
 		{
-			eeyore_code.emplace_back(BinaryOpStmt(
+			builder.emit(BinaryOpStmt(
 				offset_opr, offset_opr, BinaryOpNode::ADD, const_offset
 			));
 		}
@@ -348,7 +310,7 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 				if(state.is_write_mode() && !state.is_write_array())
 				{
 					// Assigning an array element to idx, we need only one memory fetch.
-					eeyore_code.emplace_back(ReadArrStmt(
+					builder.emit(ReadArrStmt(
 						state.write_opr(), id_opr, offset_opr
 					));
 					return std::nullopt;
@@ -357,15 +319,15 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 				{
 					// We have to store the fetched element.
 					TempVar element = resources.get_temp_var();
-					eeyore_code.emplace_back(DeclStmt(element));
-					eeyore_code.emplace_back(ReadArrStmt(
+					builder.emit(DeclStmt(element));
+					builder.emit(ReadArrStmt(
 						element, id_opr, offset_opr
 					));
 
 					if(state.is_write_mode())
 					{
 						// write array
-						eeyore_code.emplace_back(WriteArrStmt(
+						builder.emit(WriteArrStmt(
 							state.write_opr(), state.arr_offset(), element
 						));
 						return std::nullopt;
@@ -384,7 +346,7 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 			{
 				INTERNAL_ASSERT(!state.is_write_array(),
 					"pointer cannot be array elements");
-				eeyore_code.emplace_back(BinaryOpStmt(
+				builder.emit(BinaryOpStmt(
 					state.write_opr(), id_opr, BinaryOpNode::ADD, offset_opr
 				));
 				return std::nullopt;
@@ -392,8 +354,8 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 			else // read mode
 			{
 				TempVar tmp = resources.get_temp_var();
-				eeyore_code.emplace_back(DeclStmt(tmp));
-				eeyore_code.emplace_back(BinaryOpStmt(
+				builder.emit(DeclStmt(tmp));
+				builder.emit(BinaryOpStmt(
 					tmp, id_opr, BinaryOpNode::ADD, offset_opr
 				));
 				return tmp;
@@ -413,13 +375,13 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 		{
 			if(state.is_write_array())
 			{
-				eeyore_code.emplace_back(WriteArrStmt(
+				builder.emit(WriteArrStmt(
 					state.write_opr(), state.arr_offset(), id_opr
 				));
 			}
 			else // write Var
 			{
-				eeyore_code.emplace_back(MoveStmt(
+				builder.emit(MoveStmt(
 					state.write_opr(), id_opr
 				));
 			}
@@ -434,24 +396,32 @@ optional<Operand> EeyoreGenerator::operator() (const IdNodePtr &node)
 
 optional<Operand> EeyoreGenerator::operator() (const InitializerNodePtr &node)
 {
-	INTERNAL_ASSERT(holds_alternative<int>(state.arr_offset()), "the offset of the initializer must be a int");
-	INTERNAL_ASSERT(holds_alternative<ArrayTypePtr>(state.arr_type()), "initializer current type should be ArrayTypePtr");
-	int base_offset = std::get<int>(state.arr_offset());
-	ArrayTypePtr curr_type = std::get<ArrayTypePtr>(state.arr_type());
-	TypePtr element_type = curr_type->element_type();
-	int element_size = curr_type->element_size();
-	DBG(std::cout << "matching array with element " << element_type << std::endl);
-	DBG(std::cout << "base_offset = " << base_offset << std::endl);
-
-	auto prev_arr_type = state.arr_type();
-	state.set_arr_type(element_type);
-	for(int i = 0; i < node->children_cnt(); i++)
+	INTERNAL_ASSERT(node->is_flattened(), "the initializer should be flattened during semantic analysis");
+	INTERNAL_ASSERT(state.is_write_mode() && !state.is_write_array(),
+		"the initializer should be written to an array");
+	Operand arr_opr = state.write_opr();
+	const FlatInitializer &flat = node->flat();
+	const int element_size = sizeof(int);
+	DBG(std::cout << "initializing with " << flat.vals.size() << " vals and "
+		<< flat.exprs.size() << " exprs" << std::endl);
+
+	// Write the elements in order. The zeros are skipped, since global arrays
+	// are zero-initialized, and local arrays are zeroed before.
+	auto write_expr = [&](const std::pair<int, AstPtr> &expr) {
+		state.set_arr_offset(expr.first * element_size);
+		visit(*this, expr.second);
+	};
+	auto expr_iter = flat.exprs.begin();
+	for(int i = 0; i < (int)flat.vals.size(); i++)
 	{
-		state.set_arr_offset(base_offset + i * element_size);
-		visit(*this, node->get(i));
+		if(expr_iter != flat.exprs.end() && expr_iter->first == i)
+			write_expr(*expr_iter++);
+		else if(flat.vals[i] != 0)
+			builder.emit(WriteArrStmt(arr_opr, i * element_size, flat.vals[i]));
 	}
-	state.set_arr_type(prev_arr_type);
-	state.set_arr_offset(base_offset);
+	for(; expr_iter != flat.exprs.end(); ++expr_iter)
+		write_expr(*expr_iter);
+	state.reset_arr_offset();
 	return std::nullopt;
 }
 
@@ -461,7 +431,7 @@ optional<Operand> EeyoreGenerator::operator() (const FuncDefNodePtr &node)
 	int arg_cnt = node->actual_params()->children_cnt();
 	const TypePtr &id_type = node->type();
 	table.insert(id->name(), node->type());
-	eeyore_code.emplace_back(FuncDefStmt(id->name(), arg_cnt));
+	builder.emit(FuncDefStmt(eeyore_func_name(id->name()), arg_cnt));
 	state.set_local();
 
 	// create a new block for parameters.
@@ -476,27 +446,27 @@ optional<Operand> EeyoreGenerator::operator() (const FuncDefNodePtr &node)
 		if(!holds_alternative<IdNodePtr>(arg->lval()))
 			INTERNAL_ERROR("exptected IdNode as lval of SingleFuncParamNode after semantic analysis");
 		table.insert(
-			std::get<IdNodePtr>(arg->lval())->name(), arg->type(), Param(i)
+			std::get<IdNodePtr>(arg->lval())->name(), arg->type(), resources.get_param(i)
 		);
 	}
 
 	std::visit(*this, node->block());
 	// We do not check if all the branches reach the return statement.
-	// Simply add an extra return statement if the last statement is not return.
-	if(!holds_alternative<RetStmt>(eeyore_code.back()))
+	// Simply add an extra return statement if the end can be reached.
+	if(builder.is_reachable())
 	{
 		if(!holds_alternative<FuncTypePtr>(node->type()))
 			INTERNAL_ERROR("expected FuncType for type of FuncDefNode");
 		TypePtr retval_type = std::get<FuncTypePtr>(node->type())->retval_type();
 		if(holds_alternative<VoidTypePtr>(retval_type))
-			eeyore_code.emplace_back(RetStmt());
+			builder.emit(RetStmt());
 		else // return int
-			eeyore_code.emplace_back(RetStmt(0));
+			builder.emit(RetStmt(0));
 	}
 
 	// end function
 	table.end_block(); // clear parameters.
-	eeyore_code.emplace_back(EndFuncDefStmt(id->name()));
+	builder.emit(EndFuncDefStmt(eeyore_func_name(id->name())));
 	state.set_global();
 	return std::nullopt;
 }
@@ -537,17 +507,17 @@ optional<Operand> EeyoreGenerator::operator() (const UnaryOpNodePtr &node)
 		if(state.is_write_array())
 		{
 			TempVar tmp = resources.get_temp_var();
-			eeyore_code.emplace_back(DeclStmt(tmp));
-			eeyore_code.emplace_back(UnaryOpStmt(
+			builder.emit(DeclStmt(tmp));
+			builder.emit(UnaryOpStmt(
 				tmp, node->op(), opr1
 			));
-			eeyore_code.emplace_back(WriteArrStmt(
+			builder.emit(WriteArrStmt(
 				state.write_opr(), state.arr_offset(), tmp
 			));
 		}
 		else // write var
 		{
-			eeyore_code.emplace_back(UnaryOpStmt(
+			builder.emit(UnaryOpStmt(
 				state.write_opr(), node->op(), opr1
 			));
 		}
@@ -556,8 +526,8 @@ optional<Operand> EeyoreGenerator::operator() (const UnaryOpNodePtr &node)
 	else
 	{
 		TempVar tmp = resources.get_temp_var();
-		eeyore_code.emplace_back(DeclStmt(tmp));
-		eeyore_code.emplace_back(UnaryOpStmt(
+		builder.emit(DeclStmt(tmp));
+		builder.emit(UnaryOpStmt(
 			tmp, node->op(), opr1
 		));
 		return tmp;
@@ -673,24 +643,24 @@ optional<Operand> EeyoreGenerator::operator() (const BinaryOpNodePtr &node)
 					if(opr1_ret.has_value()) // opr1 is an expression, generate jump instruction for it.
 					{
 						Operand opr1_opr = opr1_ret.value();
-						eeyore_code.emplace_back(CondGotoStmt(
+						builder.emit(CondGotoStmt(
 							opr1_opr, BinaryOpNode::EQ, 0, state.false_label()
 						));
 					}
 
-					eeyore_code.emplace_back(LabelStmt(first_true));
+					builder.emit(LabelStmt(first_true));
 
 					state.set_true_label(prev_true_label);
 					auto opr2_ret = visit(*this, node->operand2());
 					if(opr2_ret.has_value())
 					{
 						Operand opr2_opr = opr2_ret.value();
-						eeyore_code.emplace_back(CondGotoStmt(
+						builder.emit(CondGotoStmt(
 							opr2_opr, BinaryOpNode::EQ, 0, state.false_label()
 						));
 					}
 
-					eeyore_code.emplace_back(GotoStmt(state.true_label()));
+					builder.emit(GotoStmt(state.true_label()));
 				}
 				else if(node->op() == BinaryOpNode::OR)
 				{
@@ -701,24 +671,24 @@ optional<Operand> EeyoreGenerator::operator() (const BinaryOpNodePtr &node)
 					if(opr1_ret.has_value())
 					{
 						Operand opr1_opr = opr1_ret.value();
-						eeyore_code.emplace_back(CondGotoStmt(
+						builder.emit(CondGotoStmt(
 							opr1_opr, BinaryOpNode::NE, 0, state.true_label()
 						));
 					}
 
-					eeyore_code.emplace_back(LabelStmt(first_false));
+					builder.emit(LabelStmt(first_false));
 
 					state.set_false_label(prev_false_label);
 					auto opr2_ret = visit(*this, node->operand2());
 					if(opr2_ret.has_value())
 					{
 						Operand opr2_opr = opr2_ret.value();
-						eeyore_code.emplace_back(CondGotoStmt(
+						builder.emit(CondGotoStmt(
 							opr2_opr, BinaryOpNode::NE, 0, state.true_label()
 						));
 					}
 
-					eeyore_code.emplace_back(GotoStmt(state.false_label()));
+					builder.emit(GotoStmt(state.false_label()));
 				}
 				return std::nullopt;
 			}
@@ -751,17 +721,17 @@ optional<Operand> EeyoreGenerator::operator() (const BinaryOpNodePtr &node)
 					if(state.is_write_array())
 					{
 						TempVar tmp = resources.get_temp_var();
-						eeyore_code.emplace_back(DeclStmt(tmp));
-						eeyore_code.emplace_back(BinaryOpStmt(
+						builder.emit(DeclStmt(tmp));
+						builder.emit(BinaryOpStmt(
 							tmp, opr1_opr, node->op(), opr2_opr
 						));
-						eeyore_code.emplace_back(WriteArrStmt(
+						builder.emit(WriteArrStmt(
 							state.write_opr(), state.arr_offset(), tmp
 						));
 					}
 					else
 					{
-						eeyore_code.emplace_back(BinaryOpStmt(
+						builder.emit(BinaryOpStmt(
 							state.write_opr(), opr1_opr, node->op(), opr2_opr
 						));
 					}
@@ -770,8 +740,8 @@ optional<Operand> EeyoreGenerator::operator() (const BinaryOpNodePtr &node)
 				else // read mode
 				{
 					TempVar tmp = resources.get_temp_var();
-					eeyore_code.emplace_back(DeclStmt(tmp));
-					eeyore_code.emplace_back(BinaryOpStmt(
+					builder.emit(DeclStmt(tmp));
+					builder.emit(BinaryOpStmt(
 						tmp, opr1_opr, node->op(), opr2_opr
 					));
 					return tmp;
@@ -805,25 +775,25 @@ optional<Operand> EeyoreGenerator::operator() (const IfNodePtr &node)
 	auto expr_ret = visit(*this, node->expr());
 	if(expr_ret.has_value())
 	{
-		eeyore_code.emplace_back(CondGotoStmt(
+		builder.emit(CondGotoStmt(
 			expr_ret.value(), BinaryOpNode::EQ, 0, lfalse
 		));
 	}
 	state.restore_true_false_label(prev_true_false_label);
-	eeyore_code.emplace_back(LabelStmt(ltrue));
+	builder.emit(LabelStmt(ltrue));
 	std::visit(*this, node->if_body());
 
 	if(is_null_ast(node->else_body()))
 	{
-		eeyore_code.emplace_back(LabelStmt(lfalse));
+		builder.emit(LabelStmt(lfalse));
 	}
 	else
 	{
 		Label lend = resources.get_label();
-		eeyore_code.emplace_back(GotoStmt(lend));
-		eeyore_code.emplace_back(LabelStmt(lfalse));
+		builder.emit(GotoStmt(lend));
+		builder.emit(LabelStmt(lfalse));
 		std::visit(*this, node->else_body());
-		eeyore_code.emplace_back(LabelStmt(lend));
+		builder.emit(LabelStmt(lend));
 	}
 	return std::nullopt;
 }
@@ -840,7 +810,7 @@ optional<Operand> EeyoreGenerator::operator() (const WhileNodePtr &node)
 	Label lbegin = resources.get_label();
 	Label ltrue = resources.get_label(), lfalse = resources.get_label();
 	
-	eeyore_code.emplace_back(LabelStmt(lbegin));
+	builder.emit(LabelStmt(lbegin));
 
 	auto prev_true_false_label = state.store_true_false_label();
 	auto prev_cont_break_label = state.store_cont_break_label();
@@ -850,16 +820,16 @@ optional<Operand> EeyoreGenerator::operator() (const WhileNodePtr &node)
 	auto expr_ret = visit(*this, node->expr());
 	if(expr_ret.has_value())
 	{
-		eeyore_code.emplace_back(CondGotoStmt(
+		builder.emit(CondGotoStmt(
 			expr_ret.value(), BinaryOpNode::EQ, 0, lfalse
 		));
 	}
 	state.restore_true_false_label(prev_true_false_label);
 	
-	eeyore_code.emplace_back(LabelStmt(ltrue));
+	builder.emit(LabelStmt(ltrue));
 	visit(*this, node->body());
-	eeyore_code.emplace_back(GotoStmt(lbegin));
-	eeyore_code.emplace_back(LabelStmt(lfalse));
+	builder.emit(GotoStmt(lbegin));
+	builder.emit(LabelStmt(lfalse));
 
 	state.restore_cont_break_label(prev_cont_break_label);
 	return std::nullopt;
@@ -868,34 +838,34 @@ optional<Operand> EeyoreGenerator::operator() (const WhileNodePtr &node)
 optional<Operand> EeyoreGenerator::operator() (const BreakNodePtr &node)
 {
 	INTERNAL_ASSERT(state.in_loop(), "break statement should be placed in a loop");
-	eeyore_code.emplace_back(GotoStmt(state.break_label()));
+	builder.emit(GotoStmt(state.break_label()));
 	return std::nullopt;
 }
 
 optional<Operand> EeyoreGenerator::operator() (const ContNodePtr &node)
 {
 	INTERNAL_ASSERT(state.in_loop(), "continue statement should be placed in a loop");
-	eeyore_code.emplace_back(GotoStmt(state.cont_label()));
+	builder.emit(GotoStmt(state.cont_label()));
 	return std::nullopt;
 }
 
 optional<Operand> EeyoreGenerator::operator() (const RetNodePtr &node)
 {
 	if(is_null_ast(node->expr()))
-		eeyore_code.emplace_back(RetStmt());
+		builder.emit(RetStmt());
 	else
 	{
 		// we are in read mode, so call visit method directly and get the return val.
 		auto expr = visit(*this, node->expr());
 		INTERNAL_ASSERT(expr.has_value(), "exptected a return value for return statement");
-		eeyore_code.emplace_back(RetStmt(expr.value()));
+		builder.emit(RetStmt(expr.value()));
 	}
 	return std::nullopt;
 }
 
 optional<Operand> EeyoreGenerator::operator() (const FuncCallNodePtr &node)
 {
-	const std::string &id_name = node->actual_id()->name();
+	utils::Symbol id_name = node->actual_id()->name();
 	auto find_res = table.find(id_name);
 	INTERNAL_ASSERT(find_res.has_value(), "use of undefined function");
 	TypePtr func_type = find_res.value().type;
@@ -923,7 +893,7 @@ optional<Operand> EeyoreGenerator::operator() (const FuncCallNodePtr &node)
 		param_oprs.push_back(param.value());
 	}
 	for(const Operand &param_opr : param_oprs)
-		eeyore_code.emplace_back(ParamStmt(param_opr));
+		builder.emit(ParamStmt(param_opr));
 	
 	if(write_mode)
 	{
@@ -932,15 +902,15 @@ optional<Operand> EeyoreGenerator::operator() (const FuncCallNodePtr &node)
 		if(state.is_write_array())
 		{
 			TempVar tmp = resources.get_temp_var();
-			eeyore_code.emplace_back(DeclStmt(tmp));
-			eeyore_code.emplace_back(FuncCallStmt(id_name, tmp));
-			eeyore_code.emplace_back(WriteArrStmt(
+			builder.emit(DeclStmt(tmp));
+			builder.emit(FuncCallStmt(eeyore_func_name(id_name), tmp));
+			builder.emit(WriteArrStmt(
 				state.write_opr(), state.arr_offset(), tmp
 			));
 		}
 		else
 		{
-			eeyore_code.emplace_back(FuncCallStmt(id_name, state.write_opr()));
+			builder.emit(FuncCallStmt(eeyore_func_name(id_name), state.write_opr()));
 		}
 		return std::nullopt;
 	}
@@ -948,14 +918,14 @@ optional<Operand> EeyoreGenerator::operator() (const FuncCallNodePtr &node)
 	{
 		if(holds_alternative<VoidTypePtr>(retval_type))
 		{
-			eeyore_code.emplace_back(FuncCallStmt(id_name));
+			builder.emit(FuncCallStmt(eeyore_func_name(id_name)));
 			return std::nullopt;
 		}
 		else // retval_type holds IntTypePtr
 		{
 			TempVar tmp = resources.get_temp_var();
-			eeyore_code.emplace_back(DeclStmt(tmp));
-			eeyore_code.emplace_back(FuncCallStmt(id_name, tmp));
+			builder.emit(DeclStmt(tmp));
+			builder.emit(FuncCallStmt(eeyore_func_name(id_name), tmp));
 			return tmp;
 		}
 	}
@@ -967,38 +937,24 @@ optional<Operand> EeyoreGenerator::operator() (const T &node)
 	return std::nullopt;
 }
 
-const std::list<EeyoreStatement> &EeyoreGenerator::generate_eeyore(const AstPtr &ast)
+const EeyoreCode &EeyoreGenerator::generate_eeyore(const AstPtr &ast)
 {
 	eeyore_code.clear();
+	eeyore_funcs.clear();
+	builder.clear();
 	state.reset_all();
 
-	std::visit(*this, ast);
+	{
+		utils::TimeScope time_scope("visit");
+		std::visit(*this, ast);
+	}
 	DBG(std::cout << "end visiting" << std::endl);
 
-	rearranger.rearrange(eeyore_code);
-	optimizer.optimize(eeyore_code);
-	return eeyore_code;
-}
-
-std::vector<Operand> EeyoreGenerator::all_defined_vars()
-{
-	std::vector<Operand> vars;
-
-	int max_param_cnt = 0; // Find the largest function argument to determine
-						   // used parameter count.
-	for(const auto &stmt : eeyore_code)
 	{
-		if(holds_alternative<DeclStmt>(stmt))
-			vars.emplace_back(std::get<DeclStmt>(stmt).var);
-		else if(holds_alternative<FuncDefStmt>(stmt))
-		{
-			max_param_cnt = std::max(max_param_cnt,
-				std::get<FuncDefStmt>(stmt).arg_cnt);
-		}
+		utils::TimeScope time_scope("layout");
+		builder.finish();
 	}
-	for(int i = 0; i < max_param_cnt; i++)
-		vars.emplace_back(Param(i));
-	return vars;
+	return eeyore_code;
 }
 
-} // namespace compiler::backend::eeyore
\ No newline at end of file
+} // namespace compiler::backend::eeyore
@@ -1,8 +1,8 @@
 #ifndef EEYORE_GEN_H
 #define EEYORE_GEN_H
 
-#include <list>
 #include <stack>
+#include <unordered_map>
 #include <variant>
 #include "eeyore.h"
 #include "eeyore_printer.h"
@@ -21,13 +21,16 @@ class EeyoreGenerator
 		int orig_id;
 		int temp_id;
 		int label_id;
+		int var_uid; // Shared by all kinds of variables.
 
-		ResourceManager(): orig_id(0), temp_id(0), label_id(0) {}
+		ResourceManager(): orig_id(0), temp_id(0), label_id(0), var_uid(0) {}
 		
 		inline OrigVar get_original_var(int _size=sizeof(int))
-			{ return OrigVar(orig_id++, _size); }
+			{ return OrigVar(orig_id++, var_uid++, _size); }
 		inline TempVar get_temp_var()
-			{ return TempVar(temp_id++); }
+			{ return TempVar(temp_id++, var_uid++); }
+		inline Param get_param(int id)
+			{ return Param(id, var_uid++); }
 		inline Label get_label()
 			{ return Label(label_id++); }
 	};
@@ -125,19 +128,6 @@ class EeyoreGenerator
 		inline void pop_access_idx() { access_index.pop_back(); }
 		inline void restore_access_idx(std::vector<Operand> &&idx) { access_index = idx; }
 	
-	  protected:
-	  	// For initializer matching. This holds the type of the initializer that is matching.
-	  	std::optional<frontend::TypePtr> curr_type;
-	
-	  public:
-	  	inline frontend::TypePtr arr_type() const { return curr_type.value(); }
-		inline void set_arr_type(frontend::TypePtr arr_type) { curr_type = arr_type; }
-		inline void reset_arr_type() { curr_type.reset(); }
-	  	inline void set_initializer_write(frontend::TypePtr arr_type)
-			{ set_arr_offset(0); curr_type = arr_type; }
-		inline void reset_initializer_write()
-			{ reset_arr_offset(); curr_type.reset(); }
-		
 	  protected:
 	  	bool _is_global;
 	  public:
@@ -151,31 +141,85 @@ class EeyoreGenerator
 
 	EeyoreSymbolTable table; // Generator symbol table.
 
-	// the generated statements are stored here.
-	std::list<EeyoreStatement> eeyore_code;
+	// Eeyore names of the functions ("f_" + name), interned once per function.
+	std::unordered_map<utils::Symbol, utils::Symbol> func_names;
+	utils::Symbol eeyore_func_name(utils::Symbol name);
 
-	// Rearranges the code generated. It Moves:
-	// variable definition forward to the beginning of a function, and
-	// global definition to the begging of the program, and
-	// global assignment to the beginning of f_main.
-	class EeyoreRearranger
-	{
-	  public:
-		void rearrange(std::list<EeyoreStatement> &eeyore_code);
-	};
-	EeyoreRearranger rearranger;
+	// Zeroing local arrays.
+	static constexpr int ZERO_UNROLL = 8;
+	static constexpr int ZERO_LOOP_MIN = 16;
+	void zero_array(OrigVar arr, int begin, int end);
 
-	// Optimize the generated eeyore_code locally.
-	class EeyoreOptimizer
+	// the generated statements are stored here, with the basic blocks of
+	// the functions.
+	EeyoreCode eeyore_code;
+	std::vector<EeyoreFunc> eeyore_funcs;
+
+  public:
+	// Builds the code and the basic blocks while the statements are emitted,
+	// so that no pass over the whole code is needed afterwards.
+	// The global variables are declared before the functions, and the other
+	// global statements (the initialization) are moved to the beginning of
+	// f_main, the ones storing constants first; TiggerGenerator later folds
+	// these constant stores into the static data of the globals instead of
+	// running them. A function is buffered until its end, so that its
+	// declarations are moved to its beginning. The control flow is simplified
+	// on the fly:
+	// - a label right after another one, or right before a goto, is merged
+	//   into that label or the goto target (a union-find of the labels);
+	// - the statements that cannot be reached are dropped, e.g. the ones after
+	//   return and goto statements;
+	// - the jumps to the label right after them are dropped.
+	// At the end of the function, the labels not jumped to are dropped, the
+	// rest are renumbered in order, and the blocks are split by the labels and
+	// jumps left. Only structured control flow is supported: a label that
+	// cannot be reached when placed must not be jumped to later.
+	class CodeBuilder
 	{
 	  protected:
-		void _remove_useless_labels_and_jumps(
-			std::list<EeyoreStatement> &eeyore_code);
-		
+		EeyoreCode &_code;
+		std::vector<EeyoreFunc> &_funcs;
+
+		std::vector<EeyoreStatement> _global_inits;
+		std::vector<EeyoreStatement> _global_static_inits; // Storing constants.
+		std::vector<EeyoreStatement> _global_decls;
+		std::optional<EeyoreCode::iterator> _main_decls_back; // Where the inits go.
+		int _main_func_id;
+
+		// The labels of the program, indexed by label id.
+		std::vector<int> _label_parents; // The union-find forest of the labels.
+		std::vector<int> _label_uses; // The jumps to each root label.
+		std::vector<int> _new_label_ids; // -1 if the label is dropped.
+		int _new_label_cnt;
+
+		// The function being built.
+		std::optional<FuncDefStmt> _func_def;
+		std::vector<EeyoreStatement> _func_decls;
+		std::vector<EeyoreStatement> _func_body;
+		bool _reachable; // Whether the next statement can be reached.
+
+		int _find_label(int label_id);
+		void _add_label(int label_id);
+		void _place_label(int label_id);
+		void _emit_jump(EeyoreStatement &&stmt);
+		bool _body_falls_through() const;
+		void _drop_jumps_to_next();
+		void _end_func(EndFuncDefStmt &&stmt);
+
 	  public:
-	  	void optimize(std::list<EeyoreStatement> &eeyore_code);
+		CodeBuilder(EeyoreCode &code, std::vector<EeyoreFunc> &funcs)
+		  : _code(code), _funcs(funcs) { clear(); }
+
+		void clear();
+		void emit(EeyoreStatement &&stmt);
+		inline bool is_reachable() const { return _reachable; }
+		// Puts the global statements in place, after all the functions are
+		// emitted. The code is compact afterwards.
+		void finish();
 	};
-	EeyoreOptimizer optimizer;
+
+  protected:
+	CodeBuilder builder{eeyore_code, eeyore_funcs};
 
   public:
 	EeyoreGenerator() = default;
@@ -202,8 +246,9 @@ class EeyoreGenerator
 	std::optional<Operand> operator() (const NodePtr &node);
 
 	// Main entrance of this class.
-	const std::list<EeyoreStatement> &generate_eeyore(const frontend::AstPtr &ast);
-	std::vector<Operand> all_defined_vars();
+	const EeyoreCode &generate_eeyore(const frontend::AstPtr &ast);
+	// The functions of the code generated, valid until the next generation.
+	inline const std::vector<EeyoreFunc> &generated_funcs() const { return eeyore_funcs; }
 };
 
 }
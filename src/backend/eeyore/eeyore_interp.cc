@@ -0,0 +1,573 @@
+#include <algorithm>
+#include <climits>
+#include <iomanip>
+#include <unordered_map>
+#include "eeyore_interp.h"
+
+using std::holds_alternative;
+using BinOp = compiler::frontend::BinaryOpNode;
+using UnaryOp = compiler::frontend::UnaryOpNode;
+
+namespace
+{
+
+// In the order of EeyoreStatement.
+const char *STMT_KIND_NAMES[] = {
+	"DeclStmt", "FuncDefStmt", "EndFuncDefStmt", "ParamStmt", "FuncCallStmt", "RetStmt",
+	"GotoStmt", "CondGotoStmt", "UnaryOpStmt", "BinaryOpStmt", "MoveStmt", "ReadArrStmt",
+	"WriteArrStmt", "LabelStmt"
+};
+
+// The blocks printed by print_stats.
+constexpr int HOT_BLOCK_CNT = 10;
+
+// Arithmetic wraps around, and division follows RISC-V (INT_MIN / -1 is
+// INT_MIN), instead of being undefined.
+int calculate(BinOp::OpType op, int opr1, int opr2)
+{
+	using compiler::backend::eeyore::EeyoreInterpreter;
+	switch(op)
+	{
+	case BinOp::ADD: return int(unsigned(opr1) + unsigned(opr2));
+	case BinOp::SUB: return int(unsigned(opr1) - unsigned(opr2));
+	case BinOp::MUL: return int(unsigned(opr1) * unsigned(opr2));
+	case BinOp::DIV:
+		if(opr2 == 0)
+			throw EeyoreInterpreter::RuntimeError("division by zero");
+		return opr1 == INT_MIN && opr2 == -1? INT_MIN : opr1 / opr2;
+	case BinOp::MOD:
+		if(opr2 == 0)
+			throw EeyoreInterpreter::RuntimeError("modulo by zero");
+		return opr1 == INT_MIN && opr2 == -1? 0 : opr1 % opr2;
+	case BinOp::OR: return opr1 || opr2;
+	case BinOp::AND: return opr1 && opr2;
+	case BinOp::GT: return opr1 > opr2;
+	case BinOp::LT: return opr1 < opr2;
+	case BinOp::GE: return opr1 >= opr2;
+	case BinOp::LE: return opr1 <= opr2;
+	case BinOp::EQ: return opr1 == opr2;
+	case BinOp::NE: return opr1 != opr2;
+	default: INTERNAL_ERROR("invalid binary operator in eeyore");
+	}
+}
+
+} // namespace
+
+namespace compiler::backend::eeyore
+{
+
+EeyoreInterpreter::EeyoreInterpreter(const EeyoreCode &code, std::istream &in,
+	utils::OutputWriter &out)
+  : _code(code), _in(in), _out(out), _main_func_id(-1)
+{
+	INTERNAL_ASSERT(code.is_compact(), "interpreting non-compact code");
+	_analyze();
+}
+
+void EeyoreInterpreter::_add_var(const Operand &opr, Function &func)
+{
+	int uid = uid_of(opr);
+	if(uid < 0 || _is_global_uid[uid] || _slots[uid] >= 0)
+		return;
+	_slots[uid] = func.slot_cnt++;
+	if(holds_alternative<Param>(opr))
+	{
+		int param_id = std::get<Param>(opr).id;
+		INTERNAL_ASSERT(param_id < int(func.param_slots.size()), "invalid parameter id");
+		func.param_slots[param_id] = _slots[uid];
+	}
+}
+
+// Numbers the local variables of a function, and finds its basic blocks,
+// which begin at the function, labels and the statements after jumps.
+void EeyoreInterpreter::_analyze_func(int func_id)
+{
+	Function &func = _funcs[func_id];
+	std::unordered_map<int, int> label_stmt_ids;
+	bool is_leader = true;
+	for(int stmt_id = func.begin_stmt_id; stmt_id <= func.end_stmt_id; stmt_id++)
+	{
+		const auto &stmt = _code[stmt_id];
+		if(is_leader || holds_alternative<LabelStmt>(stmt))
+		{
+			if(!_blocks.empty() && _blocks.back().end_stmt_id < 0)
+				_blocks.back().end_stmt_id = stmt_id;
+			_block_ids[stmt_id] = _blocks.size();
+			_blocks.push_back({func_id, stmt_id, -1, 0});
+		}
+		is_leader = holds_alternative<GotoStmt>(stmt) || holds_alternative<CondGotoStmt>(stmt)
+			|| holds_alternative<RetStmt>(stmt);
+
+		if(holds_alternative<LabelStmt>(stmt))
+			label_stmt_ids[std::get<LabelStmt>(stmt).label.id] = stmt_id;
+		else if(holds_alternative<DeclStmt>(stmt))
+		{
+			const auto &var = std::get<DeclStmt>(stmt).var;
+			_add_var(var, func);
+			if(holds_alternative<OrigVar>(var) && std::get<OrigVar>(var).size != sizeof(int))
+			{
+				int words = std::get<OrigVar>(var).size / sizeof(int);
+				func.arrays.emplace_back(_slots[uid_of(var)], words);
+				func.array_words += words;
+			}
+		}
+		for(const auto &var : used_vars(stmt))
+			_add_var(var, func);
+		for(const auto &var : defined_vars(stmt))
+			_add_var(var, func);
+		if(holds_alternative<FuncCallStmt>(stmt))
+		{
+			const auto &receiver = std::get<FuncCallStmt>(stmt).retval_receiver;
+			if(receiver.has_value())
+				_add_var(receiver.value(), func);
+		}
+	}
+	_blocks.back().end_stmt_id = func.end_stmt_id + 1;
+
+	for(int stmt_id = func.begin_stmt_id; stmt_id <= func.end_stmt_id; stmt_id++)
+	{
+		const auto &stmt = _code[stmt_id];
+		int label_id;
+		if(holds_alternative<GotoStmt>(stmt))
+			label_id = std::get<GotoStmt>(stmt).goto_label.id;
+		else if(holds_alternative<CondGotoStmt>(stmt))
+			label_id = std::get<CondGotoStmt>(stmt).goto_label.id;
+		else
+			continue;
+		auto iter = label_stmt_ids.find(label_id);
+		INTERNAL_ASSERT(iter != label_stmt_ids.end(), "jump to an undefined label");
+		_jump_targets[stmt_id] = iter->second;
+	}
+}
+
+void EeyoreInterpreter::_analyze()
+{
+	int stmt_cnt = _code.size();
+	_jump_targets.assign(stmt_cnt, -1);
+	_callees.assign(stmt_cnt, -1);
+	_builtins.assign(stmt_cnt, Builtin::NONE);
+	_block_ids.assign(stmt_cnt, -1);
+
+	int max_uid = -1;
+	for(const auto &stmt : _code)
+	{
+		for(const auto &var : used_vars(stmt))
+			max_uid = std::max(max_uid, uid_of(var));
+		for(const auto &var : defined_vars(stmt))
+			max_uid = std::max(max_uid, uid_of(var));
+		if(holds_alternative<DeclStmt>(stmt))
+			max_uid = std::max(max_uid, uid_of(std::get<DeclStmt>(stmt).var));
+		else if(holds_alternative<FuncCallStmt>(stmt)
+			&& std::get<FuncCallStmt>(stmt).retval_receiver.has_value())
+			max_uid = std::max(max_uid, uid_of(std::get<FuncCallStmt>(stmt).retval_receiver.value()));
+	}
+	_is_global_uid.assign(max_uid + 1, false);
+	_slots.assign(max_uid + 1, -1);
+
+	// The global variables are all declared before the functions.
+	int stmt_id = 0, global_cnt = 0;
+	for( ; stmt_id < stmt_cnt && holds_alternative<DeclStmt>(_code[stmt_id]); stmt_id++)
+	{
+		int uid = uid_of(std::get<DeclStmt>(_code[stmt_id]).var);
+		_is_global_uid[uid] = true;
+		_slots[uid] = global_cnt++;
+	}
+
+	std::unordered_map<utils::Symbol, int> func_ids;
+	while(stmt_id < stmt_cnt)
+	{
+		INTERNAL_ASSERT(holds_alternative<FuncDefStmt>(_code[stmt_id]),
+			"found a statement outside of functions");
+		const auto &def = std::get<FuncDefStmt>(_code[stmt_id]);
+		int begin_stmt_id = stmt_id;
+		while(!holds_alternative<EndFuncDefStmt>(_code[stmt_id]))
+		{
+			stmt_id++;
+			INTERNAL_ASSERT(stmt_id < stmt_cnt, "function without end");
+		}
+		func_ids[def.func_name] = _funcs.size();
+		_funcs.push_back({def.func_name, begin_stmt_id, stmt_id, 0,
+			std::vector<int>(def.arg_cnt, -1), {}, 0, 0});
+		stmt_id++;
+	}
+	for(size_t func_id = 0; func_id < _funcs.size(); func_id++)
+		_analyze_func(func_id);
+
+	static const std::pair<utils::Symbol, Builtin> builtins[] = {
+		{utils::Symbol("f_getint"), Builtin::GETINT},
+		{utils::Symbol("f_getch"), Builtin::GETCH},
+		{utils::Symbol("f_getarray"), Builtin::GETARRAY},
+		{utils::Symbol("f_putint"), Builtin::PUTINT},
+		{utils::Symbol("f_putch"), Builtin::PUTCH},
+		{utils::Symbol("f_putarray"), Builtin::PUTARRAY},
+		{utils::Symbol("f__sysy_starttime"), Builtin::STARTTIME},
+		{utils::Symbol("f__sysy_stoptime"), Builtin::STOPTIME},
+	};
+	for(stmt_id = 0; stmt_id < stmt_cnt; stmt_id++)
+	{
+		if(!holds_alternative<FuncCallStmt>(_code[stmt_id]))
+			continue;
+		auto name = std::get<FuncCallStmt>(_code[stmt_id]).func_name;
+		auto iter = func_ids.find(name);
+		if(iter != func_ids.end())
+			_callees[stmt_id] = iter->second;
+		else
+		{
+			for(const auto &[builtin_name, builtin] : builtins)
+				if(builtin_name == name)
+					_builtins[stmt_id] = builtin;
+			INTERNAL_ASSERT(_builtins[stmt_id] != Builtin::NONE,
+				"call of an undefined function " + name.str());
+		}
+	}
+
+	auto main_iter = func_ids.find(utils::Symbol("f_main"));
+	if(main_iter != func_ids.end())
+		_main_func_id = main_iter->second;
+}
+
+int &EeyoreInterpreter::_word_at(int addr)
+{
+	size_t idx = unsigned(addr) / sizeof(int);
+	if(addr % sizeof(int) != 0 || idx == 0 || idx >= _mem_top)
+		throw RuntimeError("invalid memory access at address " + std::to_string(addr)
+			+ " in " + _funcs[_frames.back().func_id].name.str());
+	return _mem[idx];
+}
+
+// Returns the address of the words allocated on the top of the memory.
+size_t EeyoreInterpreter::_allocate(size_t words)
+{
+	if(_mem_top + words > MAX_MEMORY_WORDS)
+		throw RuntimeError("out of memory");
+	size_t addr = _mem_top * sizeof(int);
+	if(_mem.size() < _mem_top + words)
+		_mem.resize(std::max(_mem_top + words, _mem.size() * 2));
+	std::fill(_mem.begin() + _mem_top, _mem.begin() + _mem_top + words, 0);
+	_mem_top += words;
+	return addr;
+}
+
+void EeyoreInterpreter::_call(int func_id, int call_stmt_id)
+{
+	if(int(_frames.size()) >= MAX_CALL_DEPTH)
+		throw RuntimeError("stack overflow");
+	Function &func = _funcs[func_id];
+	INTERNAL_ASSERT(_args.size() == func.param_slots.size(),
+		"wrong number of arguments for " + func.name.str());
+	func.call_cnt++;
+
+	size_t slot_base = _frame_slots.size();
+	_frames.push_back({func_id, call_stmt_id, slot_base, _mem_top});
+	_frame_slots.resize(slot_base + func.slot_cnt, 0);
+	for(size_t i = 0; i < _args.size(); i++)
+		if(func.param_slots[i] >= 0)
+			_frame_slots[slot_base + func.param_slots[i]] = _args[i];
+	_args.clear();
+	if(func.array_words > 0)
+	{
+		size_t addr = _allocate(func.array_words);
+		for(const auto &[slot, words] : func.arrays)
+		{
+			_frame_slots[slot_base + slot] = addr;
+			addr += words * sizeof(int);
+		}
+	}
+	_pc = func.begin_stmt_id;
+}
+
+void EeyoreInterpreter::_return(int retval)
+{
+	Frame frame = _frames.back();
+	_frames.pop_back();
+	_frame_slots.resize(frame.slot_base);
+	_mem_top = frame.mem_top;
+	if(_frames.empty())
+	{
+		_retval = retval;
+		_pc = -1;
+		return;
+	}
+	const auto &call = std::get<FuncCallStmt>(_code[frame.call_stmt_id]);
+	if(call.retval_receiver.has_value())
+		_var_of(call.retval_receiver.value()) = retval;
+	_pc = frame.call_stmt_id + 1;
+}
+
+int EeyoreInterpreter::_call_builtin(Builtin builtin)
+{
+	int ret = 0;
+	switch(builtin)
+	{
+	case Builtin::GETINT:
+		if(!(_in >> ret))
+			ret = 0;
+		break;
+	case Builtin::GETCH:
+		ret = _in.get();
+		break;
+	case Builtin::GETARRAY:
+		if(!(_in >> ret))
+			ret = 0;
+		for(int i = 0; i < ret; i++)
+		{
+			int val = 0;
+			_in >> val;
+			_word_at(_args[0] + i * int(sizeof(int))) = val;
+		}
+		_store_cnt += std::max(ret, 0);
+		break;
+	case Builtin::PUTINT:
+		_out << _args[0];
+		break;
+	case Builtin::PUTCH:
+		_out << char(_args[0]);
+		break;
+	case Builtin::PUTARRAY:
+		_out << _args[0] << ':';
+		for(int i = 0; i < _args[0]; i++)
+			_out << ' ' << _word_at(_args[1] + i * int(sizeof(int)));
+		_out << '\n';
+		_load_cnt += std::max(_args[0], 0);
+		break;
+	case Builtin::STARTTIME:
+		_timer_start = std::chrono::steady_clock::now();
+		_timer_start_lineno = _args[0];
+		break;
+	case Builtin::STOPTIME:
+		_timers.push_back({_timer_start_lineno, _args[0],
+			std::chrono::steady_clock::now() - _timer_start});
+		break;
+	default:
+		INTERNAL_ERROR("invalid builtin");
+	}
+	_args.clear();
+	return ret;
+}
+
+int EeyoreInterpreter::run()
+{
+	if(_main_func_id < 0)
+		throw RuntimeError("no main function");
+	for(auto &func : _funcs)
+		func.call_cnt = 0;
+	for(auto &block : _blocks)
+		block.exec_cnt = 0;
+	_frame_slots.clear();
+	_frames.clear();
+	_args.clear();
+	_timers.clear();
+	_load_cnt = _store_cnt = 0;
+	_retval = 0;
+	_timer_start = std::chrono::steady_clock::now();
+	_timer_start_lineno = 0;
+
+	// Word 0 is never allocated, so that address 0 is invalid.
+	_mem.assign(1, 0);
+	_mem_top = 1;
+	_globals.assign(std::count(_is_global_uid.begin(), _is_global_uid.end(), true), 0);
+	for(int stmt_id = 0; stmt_id < int(_code.size())
+		&& holds_alternative<DeclStmt>(_code[stmt_id]); stmt_id++)
+	{
+		const auto &var = std::get<DeclStmt>(_code[stmt_id]).var;
+		if(std::get<OrigVar>(var).size != sizeof(int))
+			_var_of(var) = _allocate(std::get<OrigVar>(var).size / sizeof(int));
+	}
+
+	_call(_main_func_id, -1);
+	while(_pc >= 0)
+	{
+		int block_id = _block_ids[_pc];
+		if(block_id >= 0)
+			_blocks[block_id].exec_cnt++;
+		std::visit(*this, _code[_pc]);
+	}
+	return _retval;
+}
+
+void EeyoreInterpreter::operator() (const DeclStmt &)
+{
+	// The local arrays are allocated when the function is called.
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const FuncDefStmt &)
+{
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const EndFuncDefStmt &)
+{
+	// A function without return statement.
+	_return(0);
+}
+
+void EeyoreInterpreter::operator() (const ParamStmt &stmt)
+{
+	_args.push_back(_value_of(stmt.param));
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const FuncCallStmt &stmt)
+{
+	int callee = _callees[_pc];
+	if(callee >= 0)
+	{
+		_call(callee, _pc);
+		return;
+	}
+	int ret = _call_builtin(_builtins[_pc]);
+	if(stmt.retval_receiver.has_value())
+		_var_of(stmt.retval_receiver.value()) = ret;
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const RetStmt &stmt)
+{
+	_return(stmt.retval.has_value()? _value_of(stmt.retval.value()) : 0);
+}
+
+void EeyoreInterpreter::operator() (const GotoStmt &)
+{
+	_pc = _jump_targets[_pc];
+}
+
+void EeyoreInterpreter::operator() (const CondGotoStmt &stmt)
+{
+	if(calculate(stmt.op, _value_of(stmt.opr1), _value_of(stmt.opr2)))
+		_pc = _jump_targets[_pc];
+	else
+		_pc++;
+}
+
+void EeyoreInterpreter::operator() (const UnaryOpStmt &stmt)
+{
+	int val = _value_of(stmt.opr1);
+	switch(stmt.op_type)
+	{
+	case UnaryOp::NEG: _var_of(stmt.opr) = int(0u - unsigned(val)); break;
+	case UnaryOp::NOT: _var_of(stmt.opr) = !val; break;
+	default: INTERNAL_ERROR("invalid unary operator in eeyore");
+	}
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const BinaryOpStmt &stmt)
+{
+	_var_of(stmt.opr) = calculate(stmt.op_type, _value_of(stmt.opr1), _value_of(stmt.opr2));
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const MoveStmt &stmt)
+{
+	_var_of(stmt.opr) = _value_of(stmt.opr1);
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const ReadArrStmt &stmt)
+{
+	_var_of(stmt.opr) = _word_at(calculate(BinOp::ADD, _value_of(stmt.arr_opr), _value_of(stmt.idx_opr)));
+	_load_cnt++;
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const WriteArrStmt &stmt)
+{
+	_word_at(calculate(BinOp::ADD, _value_of(stmt.arr_opr), _value_of(stmt.idx_opr))) = _value_of(stmt.opr);
+	_store_cnt++;
+	_pc++;
+}
+
+void EeyoreInterpreter::operator() (const LabelStmt &)
+{
+	_pc++;
+}
+
+void EeyoreInterpreter::print_stats(std::ostream &out) const
+{
+	constexpr int KIND_CNT = std::variant_size_v<EeyoreStatement>;
+	uint64_t kind_cnts[KIND_CNT] = {};
+	std::vector<uint64_t> func_stmt_cnts(_funcs.size(), 0);
+	std::vector<uint64_t> block_stmt_cnts(_blocks.size(), 0);
+	uint64_t inst_cnt = 0;
+	for(size_t block_id = 0; block_id < _blocks.size(); block_id++)
+	{
+		const auto &block = _blocks[block_id];
+		for(int stmt_id = block.begin_stmt_id; stmt_id < block.end_stmt_id; stmt_id++)
+		{
+			const auto &stmt = _code[stmt_id];
+			kind_cnts[stmt.index()] += block.exec_cnt;
+			// Declarations and labels are not instructions.
+			if(!holds_alternative<DeclStmt>(stmt) && !holds_alternative<LabelStmt>(stmt))
+				inst_cnt += block.exec_cnt;
+		}
+		block_stmt_cnts[block_id] = block.exec_cnt * (block.end_stmt_id - block.begin_stmt_id);
+		func_stmt_cnts[block.func_id] += block_stmt_cnts[block_id];
+	}
+
+	uint64_t stmt_cnt = 0;
+	for(int kind = 0; kind < KIND_CNT; kind++)
+		stmt_cnt += kind_cnts[kind];
+
+	auto flags = out.flags();
+	out << std::left;
+	out << "statements executed: " << stmt_cnt << " (instructions: " << inst_cnt << ")\n";
+	out << "memory words loaded: " << _load_cnt << ", stored: " << _store_cnt << "\n\n";
+	out << std::setw(20) << "statement" << std::right << std::setw(16) << "count" << '\n';
+	for(int kind = 0; kind < KIND_CNT; kind++)
+		out << std::left << std::setw(20) << STMT_KIND_NAMES[kind]
+			<< std::right << std::setw(16) << kind_cnts[kind] << '\n';
+
+	out << '\n' << std::left << std::setw(20) << "function" << std::right << std::setw(16) << "calls"
+		<< std::setw(16) << "statements" << '\n';
+	for(size_t func_id = 0; func_id < _funcs.size(); func_id++)
+		out << std::left << std::setw(20) << _funcs[func_id].name.str() << std::right
+			<< std::setw(16) << _funcs[func_id].call_cnt << std::setw(16) << func_stmt_cnts[func_id] << '\n';
+
+	// The blocks executing the most statements.
+	std::vector<int> block_ids(_blocks.size());
+	for(size_t i = 0; i < block_ids.size(); i++)
+		block_ids[i] = i;
+	int hot_cnt = std::min(int(block_ids.size()), HOT_BLOCK_CNT);
+	std::partial_sort(block_ids.begin(), block_ids.begin() + hot_cnt, block_ids.end(),
+		[&](int a, int b) { return block_stmt_cnts[a] > block_stmt_cnts[b]; });
+	out << '\n' << std::left << std::setw(20) << "hot block" << std::right << std::setw(16) << "statement ids"
+		<< std::setw(16) << "executions" << std::setw(16) << "statements" << '\n';
+	for(int i = 0; i < hot_cnt; i++)
+	{
+		const auto &block = _blocks[block_ids[i]];
+		std::string range = std::to_string(block.begin_stmt_id) + "-" + std::to_string(block.end_stmt_id - 1);
+		out << std::left << std::setw(20) << _funcs[block.func_id].name.str() << std::right
+			<< std::setw(16) << range << std::setw(16) << block.exec_cnt
+			<< std::setw(16) << block_stmt_cnts[block_ids[i]] << '\n';
+	}
+	out.flags(flags);
+}
+
+void EeyoreInterpreter::print_timers(std::ostream &out) const
+{
+	auto print_duration = [&](std::chrono::steady_clock::duration duration) {
+		auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+		out << us / 3600000000 << "H-" << us / 60000000 % 60 << "M-" << us / 1000000 % 60 << "S-"
+			<< us % 1000000 << "us\n";
+	};
+	auto flags = out.flags();
+	auto fill = out.fill('0');
+	std::chrono::steady_clock::duration total(0);
+	for(const auto &timer : _timers)
+	{
+		out << "Timer@" << std::setw(4) << timer.start_lineno << '-' << std::setw(4)
+			<< timer.stop_lineno << ": ";
+		print_duration(timer.elapsed);
+		total += timer.elapsed;
+	}
+	out.fill(fill);
+	out.flags(flags);
+	if(!_timers.empty())
+	{
+		out << "TOTAL: ";
+		print_duration(total);
+	}
+}
+
+} // namespace compiler::backend::eeyore
@@ -0,0 +1,170 @@
+#ifndef EEYORE_INTERP_H
+#define EEYORE_INTERP_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "eeyore.h"
+#include "output_writer.h"
+
+namespace compiler::backend::eeyore
+{
+
+// Runs compact eeyore code, as a local oracle of the generated code. The
+// library functions (getint, putarray, _sysy_starttime ...) are builtins on
+// the given streams.
+// Memory is an array of words, addressed by bytes like the arrays of eeyore.
+// The local arrays of a function are allocated on a stack when it is called.
+// Besides the output, the dynamic counts of the statements are recorded per
+// basic block, from which the counts per statement kind and per function are
+// derived.
+class EeyoreInterpreter
+{
+  public:
+	// An error of the program being run, e.g. an access out of bounds.
+	class RuntimeError
+	{
+	  protected:
+		std::string _what;
+
+	  public:
+		RuntimeError(const std::string &what_arg): _what(what_arg) {}
+		std::string what() const { return "Runtime error: " + _what + "."; }
+	};
+
+	// Maximum words of memory, including the stack.
+	static constexpr size_t MAX_MEMORY_WORDS = size_t(1) << 26;
+	// Maximum depth of calls.
+	static constexpr int MAX_CALL_DEPTH = 1 << 20;
+
+  protected:
+	enum class Builtin
+	{
+		GETINT, GETCH, GETARRAY, PUTINT, PUTCH, PUTARRAY, STARTTIME, STOPTIME, NONE
+	};
+
+	struct Function
+	{
+		utils::Symbol name;
+		int begin_stmt_id; // The FuncDefStmt.
+		int end_stmt_id; // The EndFuncDefStmt.
+		int slot_cnt; // Local variables, temporaries and parameters.
+		std::vector<int> param_slots; // -1 if the parameter is never used.
+		std::vector<std::pair<int, int>> arrays; // (slot, words) of local arrays.
+		int array_words; // Sum of the words of the local arrays.
+		uint64_t call_cnt;
+	};
+
+	struct Block
+	{
+		int func_id;
+		int begin_stmt_id;
+		int end_stmt_id;
+		uint64_t exec_cnt;
+	};
+
+	struct Frame
+	{
+		int func_id;
+		int call_stmt_id; // In the caller, -1 for main.
+		size_t slot_base;
+		size_t mem_top; // Of the caller.
+	};
+
+	struct Timer
+	{
+		int start_lineno, stop_lineno;
+		std::chrono::steady_clock::duration elapsed;
+	};
+
+	const EeyoreCode &_code;
+	std::istream &_in;
+	utils::OutputWriter &_out;
+
+	// Side tables of the statements, by statement ids.
+	std::vector<int> _jump_targets; // Of the jumps, the statement of the label.
+	std::vector<int> _callees; // Of the calls, the function id or -1 for builtins.
+	std::vector<Builtin> _builtins; // Of the calls of builtins.
+	std::vector<int> _block_ids; // -1 if a statement does not begin a block.
+
+	// Side tables of the variables, by uids.
+	std::vector<bool> _is_global_uid;
+	std::vector<int> _slots; // Index in the globals, or in the frame.
+
+	std::vector<Function> _funcs;
+	std::vector<Block> _blocks;
+	int _main_func_id;
+
+	// The state of the program.
+	std::vector<int> _globals;
+	std::vector<int> _frame_slots; // Of all the frames.
+	std::vector<Frame> _frames;
+	std::vector<int> _mem;
+	size_t _mem_top;
+	std::vector<int> _args; // Of the next call.
+	int _retval;
+	int _pc; // The current statement id.
+
+	uint64_t _load_cnt, _store_cnt; // Words accessed in the memory.
+	std::vector<Timer> _timers;
+	std::chrono::steady_clock::time_point _timer_start;
+	int _timer_start_lineno;
+
+	void _analyze();
+	void _analyze_func(int func_id);
+	void _add_var(const Operand &opr, Function &func);
+
+	inline int &_var(int uid)
+	{
+		return _is_global_uid[uid]? _globals[_slots[uid]]
+			: _frame_slots[_frames.back().slot_base + _slots[uid]];
+	}
+	inline int _value_of(const Operand &opr)
+	{
+		if(std::holds_alternative<int>(opr))
+			return std::get<int>(opr);
+		return _var(uid_of(opr));
+	}
+	inline int &_var_of(const Operand &opr) { return _var(uid_of(opr)); }
+	int &_word_at(int addr);
+	size_t _allocate(size_t words);
+
+	void _call(int func_id, int call_stmt_id);
+	void _return(int retval);
+	int _call_builtin(Builtin builtin);
+
+  public:
+	EeyoreInterpreter(const EeyoreCode &code, std::istream &in, utils::OutputWriter &out);
+	EeyoreInterpreter(const EeyoreInterpreter &other) = delete;
+	EeyoreInterpreter &operator = (const EeyoreInterpreter &other) = delete;
+
+	// Runs f_main, returns its return value. Throws RuntimeError.
+	int run();
+
+	// Prints the dynamic counts of the last run.
+	void print_stats(std::ostream &out) const;
+	// Prints the timers of _sysy_starttime and _sysy_stoptime, like the
+	// runtime library of SysY.
+	void print_timers(std::ostream &out) const;
+
+	// The visitor methods execute a statement, and set _pc to the next one.
+	void operator() (const DeclStmt &stmt);
+	void operator() (const FuncDefStmt &stmt);
+	void operator() (const EndFuncDefStmt &stmt);
+	void operator() (const ParamStmt &stmt);
+	void operator() (const FuncCallStmt &stmt);
+	void operator() (const RetStmt &stmt);
+	void operator() (const GotoStmt &stmt);
+	void operator() (const CondGotoStmt &stmt);
+	void operator() (const UnaryOpStmt &stmt);
+	void operator() (const BinaryOpStmt &stmt);
+	void operator() (const MoveStmt &stmt);
+	void operator() (const ReadArrStmt &stmt);
+	void operator() (const WriteArrStmt &stmt);
+	void operator() (const LabelStmt &stmt);
+};
+
+} // namespace compiler::backend::eeyore
+
+#endif
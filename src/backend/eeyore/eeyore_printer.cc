@@ -1,8 +1,6 @@
 #include "eeyore_printer.h"
 #include "visitor_helper.h"
 
-using std::endl;
-
 namespace compiler::backend::eeyore
 {
 
@@ -36,29 +34,29 @@ void EeyorePrinter::operator() (const DeclStmt &stmt)
 		if(var.size != 4)
 			out << var.size << ' ';
 	}
-	out << stmt.var << endl;
+	out << stmt.var << '\n';
 }
 
 void EeyorePrinter::operator() (const FuncDefStmt &stmt)
 {
-	out << stmt.func_name << " [" << stmt.arg_cnt << ']' << endl;
+	out << stmt.func_name << " [" << stmt.arg_cnt << ']' << '\n';
 }
 
 void EeyorePrinter::operator() (const EndFuncDefStmt &stmt)
 {
-	out << "end " << stmt.func_name << endl;
+	out << "end " << stmt.func_name << '\n';
 }
 
 void EeyorePrinter::operator() (const ParamStmt &stmt)
 {
-	out << "param " << stmt.param << endl;
+	out << "param " << stmt.param << '\n';
 }
 
 void EeyorePrinter::operator() (const FuncCallStmt &stmt)
 {
 	if(stmt.retval_receiver.has_value())
 		out << stmt.retval_receiver.value() << " = ";
-	out << "call " << stmt.func_name << endl;
+	out << "call " << stmt.func_name << '\n';
 }
 
 void EeyorePrinter::operator() (const RetStmt &stmt)
@@ -66,63 +64,81 @@ void EeyorePrinter::operator() (const RetStmt &stmt)
 	out << "return";
 	if(stmt.retval.has_value())
 		out << ' ' << stmt.retval.value();
-	out << endl;
+	out << '\n';
 }
 
 void EeyorePrinter::operator() (const GotoStmt &stmt)
 {
-	out << "goto l" << stmt.goto_label.id << endl;
+	out << "goto l" << stmt.goto_label.id << '\n';
 }
 
 void EeyorePrinter::operator() (const CondGotoStmt &stmt)
 {
 	out << "if " << stmt.opr1 << ' ' << stmt.op << ' ' << stmt.opr2
-		<< " goto l" << stmt.goto_label.id << endl;
+		<< " goto l" << stmt.goto_label.id << '\n';
 }
 
 void EeyorePrinter::operator() (const UnaryOpStmt &stmt)
 {
-	out << stmt.opr << " = " << stmt.op_type << stmt.opr1 << endl;
+	out << stmt.opr << " = " << stmt.op_type << stmt.opr1 << '\n';
 }
 
 void EeyorePrinter::operator() (const BinaryOpStmt &stmt)
 {
 	out << stmt.opr << " = "
-		<< stmt.opr1 << ' ' << stmt.op_type << ' ' << stmt.opr2 << endl;
+		<< stmt.opr1 << ' ' << stmt.op_type << ' ' << stmt.opr2 << '\n';
 }
 
 void EeyorePrinter::operator() (const MoveStmt &stmt)
 {
-	out << stmt.opr << " = " << stmt.opr1 << endl;
+	out << stmt.opr << " = " << stmt.opr1 << '\n';
 }
 
 void EeyorePrinter::operator() (const ReadArrStmt &stmt)
 {
-	out << stmt.opr << " = " << stmt.arr_opr << '[' << stmt.idx_opr << ']' << endl;
+	out << stmt.opr << " = " << stmt.arr_opr << '[' << stmt.idx_opr << ']' << '\n';
 }
 
 void EeyorePrinter::operator() (const WriteArrStmt &stmt)
 {
-	out << stmt.arr_opr << '[' << stmt.idx_opr << ']' << " = " << stmt.opr << endl;
+	out << stmt.arr_opr << '[' << stmt.idx_opr << ']' << " = " << stmt.opr << '\n';
 }
 
 void EeyorePrinter::operator() (const LabelStmt &stmt)
 {
-	out << 'l' << stmt.label.id << ':' << endl;
+	out << 'l' << stmt.label.id << ':' << '\n';
 }
 
 } // namespace compiler::backend::eeyore
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::eeyore::Operand opr)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::eeyore::Operand &opr)
 {
 	compiler::backend::eeyore::OprPrinter printer{out};
 	std::visit(printer, opr);
 	return out;
 }
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::eeyore::EeyoreStatement &stmt)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::eeyore::EeyoreStatement &stmt)
 {
 	compiler::backend::eeyore::EeyorePrinter printer{out};
 	std::visit(printer, stmt);
 	return out;
-}
\ No newline at end of file
+}
+
+// The ostream printers are only used for debugging.
+
+std::ostream &operator << (std::ostream &out, const compiler::backend::eeyore::Operand opr)
+{
+	compiler::utils::OutputWriter writer;
+	writer << opr;
+	return out << writer.view();
+}
+
+std::ostream &operator << (std::ostream &out, const compiler::backend::eeyore::EeyoreStatement &stmt)
+{
+	compiler::utils::OutputWriter writer;
+	writer << stmt;
+	return out << writer.view();
+}
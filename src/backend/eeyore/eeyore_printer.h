@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include "eeyore.h"
+#include "output_writer.h"
 #include "ast_node_printer.h"
 
 namespace compiler::backend::eeyore
@@ -10,7 +11,7 @@ namespace compiler::backend::eeyore
 
 struct OprPrinter
 {
-	std::ostream &out;
+	utils::OutputWriter &out;
 
 	void operator() (const OrigVar &var);
 	void operator() (const TempVar &var);
@@ -20,7 +21,7 @@ struct OprPrinter
 
 struct EeyorePrinter
 {
-	std::ostream &out;
+	utils::OutputWriter &out;
 
 	void operator() (const DeclStmt &stmt);
 	void operator() (const FuncDefStmt &stmt);
@@ -40,12 +41,17 @@ struct EeyorePrinter
 
 } // namespace compiler::backend::eeyore
 
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::eeyore::Operand &opr);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::eeyore::EeyoreStatement &stmt);
 std::ostream &operator << (std::ostream &out, const compiler::backend::eeyore::Operand opr);
 std::ostream &operator << (std::ostream &out, const compiler::backend::eeyore::EeyoreStatement &stmt);
 
 // Printer of container of EeyoreStatements.
 template<template<class...> class Container>
-std::ostream &operator << (std::ostream &out, const Container<compiler::backend::eeyore::EeyoreStatement> &stmts)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const Container<compiler::backend::eeyore::EeyoreStatement> &stmts)
 {
 	compiler::backend::eeyore::EeyorePrinter printer{out};
 	for(auto iter = stmts.begin(); iter != stmts.end(); ++iter)
@@ -53,4 +59,12 @@ std::ostream &operator << (std::ostream &out, const Container<compiler::backend:
 	return out;
 }
 
+template<template<class...> class Container>
+std::ostream &operator << (std::ostream &out, const Container<compiler::backend::eeyore::EeyoreStatement> &stmts)
+{
+	compiler::utils::OutputWriter writer;
+	writer << stmts;
+	return out << writer.view();
+}
+
 #endif
\ No newline at end of file
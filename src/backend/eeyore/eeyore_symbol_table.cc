@@ -1,6 +1,5 @@
 #include "eeyore_symbol_table.h"
 
-using std::make_shared;
 using namespace compiler::frontend;
 
 namespace compiler::backend::eeyore
@@ -17,18 +16,18 @@ namespace compiler::backend::eeyore
  * void _sysy_starttime(int lineno)
  * void _sysy_stoptime(int lineno)
  */
-const std::vector<std::pair<std::string, EeyoreSymbolTableEntry>> EeyoreSymbolTable::INTERNAL_FUNCTIONS = {
-	{ "getint", 	EeyoreSymbolTableEntry(make_shared<FuncType>(make_int(), TypePtrVec()), std::monostate())													},
-	{ "getch", 		EeyoreSymbolTableEntry(make_shared<FuncType>(make_int(), TypePtrVec()), std::monostate())													},
-	{ "getarray",	EeyoreSymbolTableEntry(make_shared<FuncType>(make_int(), TypePtrVec{make_shared<PointerType>(make_int())}), std::monostate())				},
-	{ "putint", 	EeyoreSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}), std::monostate())										},
-	{ "putch", 		EeyoreSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}), std::monostate())										},
-	{ "putarray",	EeyoreSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int(), make_shared<PointerType>(make_int())}), std::monostate())	},
-	{ "_sysy_starttime", 	EeyoreSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}), std::monostate())								},
-	{ "_sysy_stoptime", 	EeyoreSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}), std::monostate())								}
+const std::vector<std::pair<utils::Symbol, EeyoreSymbolTableEntry>> EeyoreSymbolTable::INTERNAL_FUNCTIONS = {
+	{ utils::Symbol("getint"), 	EeyoreSymbolTableEntry(make_func(make_int(), TypePtrVec()), std::monostate())													},
+	{ utils::Symbol("getch"), 		EeyoreSymbolTableEntry(make_func(make_int(), TypePtrVec()), std::monostate())													},
+	{ utils::Symbol("getarray"),	EeyoreSymbolTableEntry(make_func(make_int(), TypePtrVec{make_pointer(make_int())}), std::monostate())				},
+	{ utils::Symbol("putint"), 	EeyoreSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}), std::monostate())										},
+	{ utils::Symbol("putch"), 		EeyoreSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}), std::monostate())										},
+	{ utils::Symbol("putarray"),	EeyoreSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int(), make_pointer(make_int())}), std::monostate())	},
+	{ utils::Symbol("_sysy_starttime"), 	EeyoreSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}), std::monostate())								},
+	{ utils::Symbol("_sysy_stoptime"), 	EeyoreSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}), std::monostate())								}
 };
 
-EeyoreSymbolTable::EeyoreSymbolTable(): utils::ChainedMap<std::string, EeyoreSymbolTableEntry>()
+EeyoreSymbolTable::EeyoreSymbolTable(): utils::ScopedMap<utils::Symbol, EeyoreSymbolTableEntry>()
 {
 	for(const auto &predef_func : INTERNAL_FUNCTIONS)
 		basic_insert(predef_func);
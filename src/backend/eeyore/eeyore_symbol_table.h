@@ -1,7 +1,8 @@
 #ifndef EEYORE_SYMBOL_TABLE_H
 #define EEYORE_SYMBOL_TABLE_H
 
-#include "chained_map.h"
+#include "scoped_map.h"
+#include "symbol.h"
 #include "type.h"
 #include "eeyore.h"
 
@@ -21,32 +22,23 @@ struct EeyoreSymbolTableEntry
 	  : type(_type), var(_var) {}
 };
 
-class EeyoreSymbolTable: public utils::ChainedMap<std::string, EeyoreSymbolTableEntry>
+class EeyoreSymbolTable: public utils::ScopedMap<utils::Symbol, EeyoreSymbolTableEntry>
 {
-	static const std::vector<std::pair<std::string, EeyoreSymbolTableEntry>>
+	static const std::vector<std::pair<utils::Symbol, EeyoreSymbolTableEntry>>
 		INTERNAL_FUNCTIONS;
   public:
 	EeyoreSymbolTable();
 
-	inline std::optional<EeyoreSymbolTableEntry> find(const std::string &name)
-	{
-		auto find_res = basic_find(name);
-		if(find_res.has_value())
-			return find_res.value()->second;
-		else
-			return std::nullopt;
-	}
-	
 	template<class... Ts>
-	bool insert(const std::string &name, const Ts&... ts)
+	bool insert(utils::Symbol name, const Ts&... ts)
 	{
 		return basic_insert(name, EeyoreSymbolTableEntry(ts...)).second;
 	}
 
 	template<class... Ts>
-	bool insert(std::string &&name, Ts&&... ts)
+	bool insert(utils::Symbol name, Ts&&... ts)
 	{
-		return basic_insert(std::move(name), EeyoreSymbolTableEntry(std::move(ts)...)).second;
+		return basic_insert(name, EeyoreSymbolTableEntry(std::move(ts)...)).second;
 	}
 };
 
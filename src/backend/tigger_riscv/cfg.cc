@@ -1,5 +1,5 @@
+#include <climits>
 #include "dbg.h"
-#include "visitor_helper.h"
 #include "tigger_gen.h"
 
 using std::holds_alternative;
@@ -9,147 +9,132 @@ namespace compiler::backend::tigger
 
 void ControlFlowGraph::clear()
 {
-	_global_vars.clear();
-	_defined_var_idx_map.clear();
+	_local_vars.clear();
+	_uid_base = 0;
+	_local_var_idx.clear();
 	_all_vertices.clear();
 	_graph.clear();
-	_func_start.clear();
+	_rev_graph.clear();
 }
 
-void ControlFlowGraph::_build_from_code(
-	const std::list<eeyore::EeyoreStatement> &eeyore_code)
+void ControlFlowGraph::_number_local_vars()
 {
-	static utils::LambdaVisitor label_id_getter = {
-		[](const eeyore::GotoStmt &stmt) { return stmt.goto_label.id; },
-		[](const eeyore::CondGotoStmt &stmt) { return stmt.goto_label.id; },
-		[](const eeyore::LabelStmt &stmt) { return stmt.label.id; },
-		[](const auto &stmt) -> int { INTERNAL_ERROR("invalid call to label_id_getter"); }
+	// Collect the variables in the order of appearance first, to find the uid
+	// range of the function.
+	std::vector<eeyore::Operand> vars;
+	int min_uid = INT_MAX, max_uid = -1;
+	auto collect = [&, this](const eeyore::Operand &opr)
+	{
+		if(std::holds_alternative<int>(opr) || is_global_var(opr))
+			return;
+		int uid = eeyore::uid_of(opr);
+		min_uid = std::min(min_uid, uid);
+		max_uid = std::max(max_uid, uid);
+		vars.push_back(opr);
 	};
-
-	clear();
-
-	// Build defined variable -> index mapping.
-	for(int i = 0; i < _defined_vars.size(); i++)
-		_defined_var_idx_map.try_emplace(_defined_vars[i], i);
-
-	// Generate all basic blocks.
-	int basic_block_id = 0;
-	std::unordered_map<int, int> label_id_to_block_id;
-			// Maps a label to the block that contains it.
-
-	auto iter = eeyore_code.cbegin();
-	int stmt_id = 0;
-
-	// global_vars block initialization
-	BasicBlock global_vars;
-	global_vars.id = basic_block_id++;
-	global_vars.begin = iter;
-	global_vars.begin_stmt_id = stmt_id;
-	while(iter != eeyore_code.end()
-		&& holds_alternative<eeyore::DeclStmt>(*iter))
+	for(int stmt_id = _begin_stmt_id; stmt_id < _end_stmt_id; stmt_id++)
 	{
-		eeyore::Operand global_var = std::get<eeyore::DeclStmt>(*iter).var;
-		_global_vars.push_back(global_var);
-		++iter; ++stmt_id;
+		const auto &curr_stmt = stmt(stmt_id);
+		if(holds_alternative<eeyore::DeclStmt>(curr_stmt))
+			collect(std::get<eeyore::DeclStmt>(curr_stmt).var);
+		for(const auto &opr : eeyore::used_vars(curr_stmt))
+			collect(opr);
+		for(const auto &opr : eeyore::defined_vars(curr_stmt))
+			collect(opr);
 	}
-	global_vars.end = iter;
-	global_vars.end_stmt_id = stmt_id;
-	_all_vertices.push_back(global_vars);
+	if(vars.empty())
+		return;
 
-	// other basic block initialization
-	while(iter != eeyore_code.end())
+	_uid_base = min_uid;
+	_local_var_idx.assign(max_uid - min_uid + 1, -1);
+	for(const auto &opr : vars)
 	{
-		BasicBlock block;
-		block.id = basic_block_id++;
-		block.begin = iter;
-		block.begin_stmt_id = stmt_id;
+		int &idx = _local_var_idx[eeyore::uid_of(opr) - _uid_base];
+		if(idx != -1)
+			continue;
+		idx = _local_vars.size();
+		_local_vars.push_back(opr);
+	}
+}
 
-		if(holds_alternative<eeyore::LabelStmt>(*iter))
-		{
-			int label_id = std::visit(label_id_getter, *iter);
-			label_id_to_block_id[label_id] = block.id;
-			++iter, ++stmt_id;
-		}
-		else if(holds_alternative<eeyore::FuncDefStmt>(*iter))
-			_func_start.push_back(block.id);
-		
-		// Find all the way to the last statement. The last statement of a basic
-		// block can only be: GotoStmt, CondGotoStmt, FuncEndStmt, ReturnStmt,
-		// or a statement that is followed by a label statement.
-		for( ; iter != eeyore_code.end(); ++iter, ++stmt_id)
+// The postorder of all blocks in the function, starting from its first block.
+// Blocks that are unreachable from the first block are appended at the end.
+std::vector<int> ControlFlowGraph::postorder() const
+{
+	std::vector<int> order;
+	order.reserve(vertex_cnt());
+	std::vector<bool> visited(vertex_cnt(), false);
+
+	// Iterative dfs, each stack element is (block id, next successor idx).
+	std::vector<std::pair<int, int>> stack;
+	auto visit_from = [&, this](int root)
+	{
+		visited[root] = true;
+		stack.emplace_back(root, 0);
+		while(!stack.empty())
 		{
-			if(holds_alternative<eeyore::LabelStmt>(*iter))
-			{
-				block.end = iter;
-				block.end_stmt_id = stmt_id;
-				break;
-			}
-			if(holds_alternative<eeyore::GotoStmt>(*iter)
-				|| holds_alternative<eeyore::CondGotoStmt>(*iter))
+			auto &[u, next] = stack.back();
+			const auto &sux = successor_ids(u);
+			if(next == (int)sux.size())
 			{
-				block.end = ++iter;
-				block.end_stmt_id = ++stmt_id;
-				break;
+				order.push_back(u);
+				stack.pop_back();
+				continue;
 			}
-			if(holds_alternative<eeyore::RetStmt>(*iter))
-				// EndFuncDefStmt is special: it can only occur after a RetStmt,
-				// and is contained in this basic block after RetStmt.
+			int v = sux[next++];
+			if(!visited[v])
 			{
-				++iter; ++stmt_id;
-				if(iter != eeyore_code.end()
-					&& holds_alternative<eeyore::EndFuncDefStmt>(*iter))
-				{
-					block.end = ++iter;
-					block.end_stmt_id = ++stmt_id;
-				}
-				else
-				{
-					block.end = iter;
-					block.end_stmt_id = stmt_id;
-				}
-				break;
+				visited[v] = true;
+				stack.emplace_back(v, 0);
 			}
 		}
-		_all_vertices.push_back(block);
-	}
+	};
+	for(int i = 0; i < vertex_cnt(); i++)
+		if(!visited[i])
+			visit_from(i);
+	return order;
+}
 
-	// Set the bitmap size.
-	for(auto &v : _all_vertices)
-		v.resize_all_bitmap(_defined_vars.size());
+ControlFlowGraph::ControlFlowGraph(const EeyoreCode &eeyore_code,
+	const eeyore::EeyoreFunc &func, const std::vector<bool> &is_global_uid)
+  : _code(eeyore_code), _begin_stmt_id(func.begin_stmt_id), _end_stmt_id(func.end_stmt_id),
+	_is_global_uid(is_global_uid)
+{
+	INTERNAL_ASSERT(eeyore_code.is_compact(), "building cfg from non-compact code");
+	INTERNAL_ASSERT(_begin_stmt_id < _end_stmt_id
+		&& holds_alternative<eeyore::FuncDefStmt>(stmt(_begin_stmt_id))
+		&& holds_alternative<eeyore::EndFuncDefStmt>(stmt(_end_stmt_id - 1)),
+		"building cfg from statements that are not a function");
+	_build_from_blocks(func);
+}
 
-	DBG(std::cout << "all vertices created!" << std::endl);
+void ControlFlowGraph::_build_from_blocks(const eeyore::EeyoreFunc &func)
+{
+	clear();
 
-	// Create edges.
-	_graph.resize(basic_block_id);
-	for(int i = 1; i < vertex_cnt(); i++) // The successors of the global variable
-										  // block are ignored.
+	_all_vertices.resize(func.blocks.size());
+	_graph.resize(func.blocks.size());
+	for(int i = 0; i < vertex_cnt(); i++)
 	{
-		const BasicBlock &block = vertex(i);
-		const auto &last_stmt = *block.back();
+		const auto &block = func.blocks[i];
+		_all_vertices[i].id = i;
+		_all_vertices[i].begin_stmt_id = block.begin_stmt_id;
+		_all_vertices[i].end_stmt_id = block.end_stmt_id;
+		_graph[i] = block.succ_ids;
+	}
 
-		if(holds_alternative<eeyore::GotoStmt>(last_stmt))
-		{
-			int label_id = std::visit(label_id_getter, last_stmt);
-			_graph[i].push_back(label_id_to_block_id[label_id]);
-		}
-		else if(holds_alternative<eeyore::CondGotoStmt>(last_stmt))
-		{
-			int label_id = std::visit(label_id_getter, last_stmt);
-			int goto_when_true = label_id_to_block_id[label_id];
-			int goto_when_false = i + 1;
+	// Number the variables, and set the bitmap size of each block by the
+	// variable count.
+	_number_local_vars();
+	for(auto &block : _all_vertices)
+		block.resize_all_bitmap(local_var_cnt());
+
+	_rev_graph.resize(vertex_cnt());
+	for(int i = 0; i < vertex_cnt(); i++)
+		for(int j : successor_ids(i))
+			_rev_graph[j].push_back(i);
 
-			_graph[i].push_back(goto_when_true);
-			if(goto_when_true != goto_when_false) // Remove multiple edges.
-				_graph[i].push_back(goto_when_false);
-		}
-		else if(!holds_alternative<eeyore::EndFuncDefStmt>(last_stmt)
-			&& !holds_alternative<eeyore::RetStmt>(last_stmt))
-		{
-			_graph[i].push_back(i + 1);
-		}
-	}
 	DBG(
-		std::cout << "all edges created!" << std::endl;
 		for(const BasicBlock &v : all_vertices())
 		{
 			std::cout << "basic block #" << v.id << ": ["
@@ -2,7 +2,6 @@
 #define CFG_H
 
 #include <vector>
-#include <list>
 #include <algorithm>
 #include "bitmap.h"
 #include "eeyore.h"
@@ -10,30 +9,27 @@
 namespace compiler::backend::tigger
 {
 
+// The control flow graph of a function of a compact code, built from the
+// basic blocks found by EeyoreGenerator. Functions are independent of each
+// other, so the graphs of different functions can be built on different
+// threads.
 class ControlFlowGraph
 {
   public:
-	using EeyoreCode = std::list<eeyore::EeyoreStatement>;
-	using EeyoreStmtPtr = std::list<eeyore::EeyoreStatement>::const_iterator;
+	using EeyoreCode = eeyore::EeyoreCode;
 
-	// A basic block of a program.
+	// A basic block of a function, which is the statements with id in
+	// [begin_stmt_id, end_stmt_id).
 	struct BasicBlock
 	{
 		int id;
 		int begin_stmt_id;
 		int end_stmt_id;
-		EeyoreStmtPtr begin;
-		EeyoreStmtPtr end;
 		utils::Bitmap live_gen;
 		utils::Bitmap live_kill;
 		utils::Bitmap live_in;
 		utils::Bitmap live_out;
 
-		inline EeyoreStmtPtr back() const
-		{
-			EeyoreStmtPtr l = end;
-			return --l;
-		}
 		inline int back_stmt_id() const { return end_stmt_id - 1; }
 
 		inline void resize_all_bitmap(size_t size)
@@ -46,50 +42,64 @@ class ControlFlowGraph
 	};
 
   protected:
-	std::vector<eeyore::Operand> _global_vars;
-	std::vector<eeyore::Operand> _defined_vars;
-	std::unordered_map<eeyore::Operand, int> _defined_var_idx_map;
-	
+	const EeyoreCode &_code; // Must be compact.
+	int _begin_stmt_id;
+	int _end_stmt_id;
+
+	// All the global variables (indexed by uid), shared by all the functions.
+	const std::vector<bool> &_is_global_uid;
+
+	// The function numbers its own variables densely, so that the bitmaps of
+	// its blocks are sized by the local variable count. Global variables are
+	// not numbered, since they are never allocated registers.
+	std::vector<eeyore::Operand> _local_vars;
+	// The local index of each variable, indexed by uid - _uid_base. The
+	// variables of a function are created together, so their uids are close.
+	int _uid_base;
+	std::vector<int> _local_var_idx; // -1 for global variables.
+
 	std::vector<BasicBlock> _all_vertices; // All the basic blocks (as vertices of cfg).
-							// Also use a basic block (id = 0) to store all global
-							// variable decls.
 	std::vector<std::vector<int>> _graph; // the actual graph, stored by adjacency list.
-	std::vector<int> _func_start; // Where all the function starts.
-						// They are the starting block id of each component in the graph.
+	std::vector<std::vector<int>> _rev_graph; // the reversed graph.
 
-	void _build_from_code(const EeyoreCode &eeyore_code);
+	void _build_from_blocks(const eeyore::EeyoreFunc &func);
+	void _number_local_vars();
 
   public:
-	ControlFlowGraph(const EeyoreCode &eeyore_code,
-			std::vector<eeyore::Operand> defined_vars)
-	  : _defined_vars(std::move(defined_vars)) { _build_from_code(eeyore_code); }
+	ControlFlowGraph(const EeyoreCode &eeyore_code, const eeyore::EeyoreFunc &func,
+		const std::vector<bool> &is_global_uid);
 	
 	void clear();
 
+	inline const eeyore::EeyoreStatement &stmt(int stmt_id) const { return _code[stmt_id]; }
+	inline int begin_stmt_id() const { return _begin_stmt_id; }
+	inline int end_stmt_id() const { return _end_stmt_id; }
 	inline int vertex_cnt() const { return _all_vertices.size(); }
 	inline const BasicBlock &vertex(int u) const { return _all_vertices.at(u); }
 	inline const std::vector<BasicBlock> &all_vertices() const
 		{ return _all_vertices; }
 	inline const std::vector<int> &successor_ids(int u) const
 		{ return _graph.at(u); }
-	inline const std::vector<eeyore::Operand> &global_vars() const
-		{ return _global_vars; }
+	inline const std::vector<int> &predecessor_ids(int u) const
+		{ return _rev_graph.at(u); }
 	inline BasicBlock &vertex_(int u) { return _all_vertices.at(u); }
 	inline std::vector<BasicBlock> &all_vertices_() { return _all_vertices; }
 
-	inline const std::vector<int> &func_start_id() const { return _func_start; }
-	
-	inline const std::vector<eeyore::Operand> &defined_var() const
-		{ return _defined_vars; }
-	inline eeyore::Operand defined_var(int i) const
-		{ return _defined_vars[i]; }
-	inline const std::unordered_map<eeyore::Operand, int> &defined_var_idx_map() const
-		{ return _defined_var_idx_map; }
+	inline int local_var_cnt() const { return _local_vars.size(); }
+	inline const std::vector<eeyore::Operand> &local_vars() const { return _local_vars; }
+	inline int uid_base() const { return _uid_base; }
+	std::vector<int> postorder() const;
 	
-	inline bool is_global_var(eeyore::Operand opr) const
+	inline bool is_global_var(const eeyore::Operand &opr) const
+	{
+		int uid = eeyore::uid_of(opr);
+		return uid >= 0 && uid < (int)_is_global_uid.size() && _is_global_uid[uid];
+	}
+	// The index of a variable in the function, or -1 if it is a global variable.
+	inline int local_var_idx(const eeyore::Operand &opr) const
 	{
-		// TODO: This is currently an O(n) algorithm. Optimize it later.
-		return std::find(_global_vars.begin(), _global_vars.end(), opr) != _global_vars.end();
+		int idx = eeyore::uid_of(opr) - _uid_base;
+		return idx >= 0 && idx < (int)_local_var_idx.size()? _local_var_idx[idx] : -1;
 	}
 };
 
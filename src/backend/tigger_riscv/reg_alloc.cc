@@ -1,8 +1,9 @@
 #include <algorithm>
+#include <deque>
 #include "dbg.h"
-#include "insertion_sort.h"
 #include "bitmap.h"
 #include "fstring.h"
+#include "time_report.h"
 #include "tigger_gen.h"
 
 namespace compiler::backend::tigger
@@ -10,11 +11,17 @@ namespace compiler::backend::tigger
 
 void RegAllocator::_RegisterManager::_return_callee_saved(CalleeSavedReg reg)
 {
-	utils::insertion_sort(_free_callee_saved_regs, reg, std::less<CalleeSavedReg>());
+	auto iter = std::lower_bound(_callee_saved_regs.begin(), _callee_saved_regs.end(), reg);
+	INTERNAL_ASSERT(iter != _callee_saved_regs.end() && *iter == reg,
+		"returning an invalid register to callee saved register pool");
+	_free_callee_saved_mask |= uint32_t(1) << (iter - _callee_saved_regs.begin());
 }
 void RegAllocator::_RegisterManager::_return_caller_saved(CallerSavedReg reg)
 {
-	utils::insertion_sort(_free_caller_saved_regs, reg, std::less<CallerSavedReg>());
+	auto iter = std::lower_bound(_caller_saved_regs.begin(), _caller_saved_regs.end(), reg);
+	INTERNAL_ASSERT(iter != _caller_saved_regs.end() && *iter == reg,
+		"returning an invalid register to caller saved register pool");
+	_free_caller_saved_mask |= uint32_t(1) << (iter - _caller_saved_regs.begin());
 }
 
 // ref: https://www.zhihu.com/question/29355187/answer/99413526
@@ -23,56 +30,44 @@ void RegAllocator::_RegisterManager::_return_caller_saved(CallerSavedReg reg)
 
 void RegAllocator::_add_to_active(int interv_id)
 {
-	utils::insertion_sort(_active, interv_id,
-		[this](const int id1, const int id2)
-		{
-			// Keep _active sorted by increasing order of back_stmt_id.
-			return _live_intervals[_curr_func_id][id1].back_stmt_id
-				< _live_intervals[_curr_func_id][id2].back_stmt_id;
-		}
-	);
+	_is_active[interv_id] = true;
+	_active.emplace(_live_intervals[interv_id].back_stmt_id, -interv_id);
 }
 
 void RegAllocator::_calculate_local_live_sets(ControlFlowGraph &cfg)
 {
-	const auto &var_to_idx = cfg.defined_var_idx_map();
+	// Calculate live_gen and live_kill for all basic blocks. Only the local
+	// variables are considered, global variables are never allocated
+	// registers, so their liveness is not needed.
 	DBG(
 		std::cout << "var -> idx mapping" << std::endl;
-		for(const auto &p : var_to_idx)
-			std::cout << p.first << ' ' << p.second << std::endl;
+		for(int i = 0; i < cfg.local_var_cnt(); i++)
+			std::cout << cfg.local_vars()[i] << ' ' << i << std::endl;
 	)
 
-	// pre-calculate the bitmap for all the global variables.
-	utils::Bitmap global_var_bitmap(cfg.defined_var().size());
-	for(const auto &global_var : cfg.global_vars())
-		global_var_bitmap.set(var_to_idx.at(global_var));
-
-	// Calculate live_gen and live_kill for all basic blocks.
 	for(auto &v : cfg.all_vertices_())
 	{
-		EeyoreStmtPtr iter = v.begin;
-		int stmt_id = v.begin_stmt_id;
-		for( ; stmt_id != v.end_stmt_id; ++iter, ++stmt_id)
+		for(int stmt_id = v.begin_stmt_id; stmt_id != v.end_stmt_id; ++stmt_id)
 		{
-			if(std::holds_alternative<eeyore::FuncCallStmt>(*iter))
+			const auto &stmt = cfg.stmt(stmt_id);
+			// For function call: kill(stmt) = all global vars, and
+			// gen(stmt) = empty. Both are irrelevant to local variables.
+			if(std::holds_alternative<eeyore::FuncCallStmt>(stmt))
+				continue;
+
+			std::vector<eeyore::Operand> used_vars = eeyore::used_vars(stmt),
+										 def_vars = eeyore::defined_vars(stmt);
+			for(const auto &var : used_vars)
 			{
-				// For function call: kill(stmt) = all global vars. Since it may
-				// re-define all global variables.
-				// gen(stmt) = empty.
-				v.live_kill.union_with(global_var_bitmap);
+				int idx = cfg.local_var_idx(var);
+				if(idx != -1 && !v.live_kill.get(idx))
+					v.live_gen.set(idx);
 			}
-			else
+			for(const auto &var : def_vars)
 			{
-				std::vector<eeyore::Operand> used_vars = eeyore::used_vars(*iter),
-											 def_vars = eeyore::defined_vars(*iter);
-				for(const auto &var : used_vars)
-				{
-					int idx = var_to_idx.at(var);
-					if(!v.live_kill.get(idx))
-						v.live_gen.set(idx);
-				}
-				for(const auto &var : def_vars)
-					v.live_kill.set(var_to_idx.at(var));
+				int idx = cfg.local_var_idx(var);
+				if(idx != -1)
+					v.live_kill.set(idx);
 			}
 		}
 	}
@@ -83,50 +78,55 @@ void RegAllocator::_calculate_local_live_sets(ControlFlowGraph &cfg)
 			std::cout << "block #" << v.id << std::endl;
 
 			std::cout << "live kill: ";
-			for(int i = 0; i < v.live_kill.size(); i++)
-				if(v.live_kill.get(i))
-					std::cout << cfg.defined_var(i) << ' ';
+			v.live_kill.for_each_set_bit([&](int i)
+				{ std::cout << cfg.local_vars()[i] << ' '; });
 			std::cout << std::endl;
 
 			std::cout << "live gen: ";
-			for(int i = 0; i < v.live_gen.size(); i++)
-				if(v.live_gen.get(i))
-					std::cout << cfg.defined_var(i) << ' ';
+			v.live_gen.for_each_set_bit([&](int i)
+				{ std::cout << cfg.local_vars()[i] << ' '; });
 			std::cout << std::endl << std::endl;
 		}
 	);
 }
 
+// A worklist solver for liveness. The worklist is seeded in postorder of the
+// function (i.e. reverse postorder of the reversed cfg), so that most
+// successors are visited before their predecessors. A block is revisited only
+// if the live_in of one of its successors is changed.
 void RegAllocator::_calculate_global_live_sets(ControlFlowGraph &cfg)
 {
-	const int N = cfg.vertex_cnt();
-	while(true)
+	std::deque<int> worklist;
+	std::vector<bool> in_worklist(cfg.vertex_cnt(), false);
+	for(int bid : cfg.postorder())
 	{
-		bool changed = false;
-		for(int i = N - 1; i >= 0; i--)
-		{
-			auto &v = cfg.vertex_(i);
-			
-			// v.live_out = union{sux.live_in} for sux in succesor(v)
-			auto prev_live_out_cnt = v.live_out.cnt();
-			v.live_out.clear();
-			for(int bid : cfg.successor_ids(i))
+		worklist.push_back(bid);
+		in_worklist[bid] = true;
+	}
+
+	while(!worklist.empty())
+	{
+		int bid = worklist.front();
+		worklist.pop_front();
+		in_worklist[bid] = false;
+		auto &v = cfg.vertex_(bid);
+
+		// v.live_out = union{sux.live_in} for sux in succesor(v)
+		// Live sets only grow during the iteration, so it is safe to union
+		// in place.
+		for(int sux_id : cfg.successor_ids(bid))
+			v.live_out.union_with(cfg.vertex(sux_id).live_in);
+
+		// v.live_in = (v.live_out - v.live_kill) union v.live_gen
+		if(!v.live_in.assign_transfer(v.live_gen, v.live_out, v.live_kill))
+			continue;
+
+		for(int pred_id : cfg.predecessor_ids(bid))
+			if(!in_worklist[pred_id])
 			{
-				auto &sux = cfg.vertex(bid);
-				v.live_out.union_with(sux.live_in);
+				worklist.push_back(pred_id);
+				in_worklist[pred_id] = true;
 			}
-			changed = changed || (v.live_out.cnt() != prev_live_out_cnt);
-
-			// v.live_in = (v.live_out - v.live_kill) union v.live_gen
-			auto prev_live_in_cnt = v.live_in.cnt();
-			v.live_in.clear();
-			v.live_in.union_with(v.live_out);
-			v.live_in.diff_with(v.live_kill);
-			v.live_in.union_with(v.live_gen);
-			changed = changed || (v.live_in.cnt() != prev_live_in_cnt);
-		}
-		if(!changed)
-			break;
 	}
 	DBG(
 		for(const auto &v : cfg.all_vertices())
@@ -134,15 +134,13 @@ void RegAllocator::_calculate_global_live_sets(ControlFlowGraph &cfg)
 			std::cout << "block #" << v.id << std::endl;
 
 			std::cout << "live in: ";
-			for(int i = 0; i < v.live_in.size(); i++)
-				if(v.live_in.get(i))
-					std::cout << cfg.defined_var(i) << ' ';
+			v.live_in.for_each_set_bit([&](int i)
+				{ std::cout << cfg.local_vars()[i] << ' '; });
 			std::cout << std::endl;
 
 			std::cout << "live out: ";
-			for(int i = 0; i < v.live_out.size(); i++)
-				if(v.live_out.get(i))
-					std::cout << cfg.defined_var(i) << ' ';
+			v.live_out.for_each_set_bit([&](int i)
+				{ std::cout << cfg.local_vars()[i] << ' '; });
 			std::cout << std::endl << std::endl;
 		}
 	);
@@ -150,118 +148,144 @@ void RegAllocator::_calculate_global_live_sets(ControlFlowGraph &cfg)
 
 void RegAllocator::_build_intervals(const ControlFlowGraph &cfg)
 {
-	const std::vector<int> &func_starts = cfg.func_start_id();
-	
-	// Build live interval for each function.
-	for(int i = 0; i < func_starts.size(); i++)
+	// The live interval of all local variables, indexed by the local variable
+	// index. Global variables are skipped, since we never allocate registers
+	// for them.
+	_live_intervals.clear();
+	_live_intervals.reserve(cfg.local_var_cnt());
+	for(const auto &opr : cfg.local_vars())
+		_live_intervals.emplace_back(opr);
+
+	std::vector<int> func_call_id; // All the function call statement id.
+
+	for(int j = cfg.vertex_cnt() - 1; j >= 0; j--)
 	{
-		// Find the start and end block idx.
-		int func_start = func_starts[i];
-		int func_end;
-		if(i == func_starts.size() - 1)
-			func_end = cfg.vertex_cnt();
-		else
-			func_end = func_starts[i + 1];
-		DBG(std::cout << "block of func #" << i << ": [" << func_start
-			<< ", " << func_end - 1 << ']' << std::endl);
-		
-		// The live interval of all variables in the current function, stored in
-		// the hash map temporarily and are further transfered to _live_intervals.
-		// Since operands are already stored in the key, the opr field of LiveInterval
-		// is not set.
-		std::unordered_map<eeyore::Operand, LiveInterval> var_live_interval_map;
-
-		std::vector<int> func_call_id; // All the function call statement id.
-
-		for(int j = func_end - 1; j >= func_start; j--)
-		{
-			const auto &block = cfg.vertex(j);
-			int block_from = block.begin_stmt_id;
-			int block_to = block.back_stmt_id();
+		const auto &block = cfg.vertex(j);
+		int block_from = block.begin_stmt_id;
+		int block_to = block.back_stmt_id();
 
-			for(int k = 0; k < block.live_out.size(); k++)
-				if(block.live_out.get(k))
-					var_live_interval_map[cfg.defined_var(k)].add_range(block_from, block_to);
+		block.live_out.for_each_set_bit([&](int k)
+			{ _live_intervals[k].add_range(block_from, block_to); });
 
-			auto iter = block.back();
-			int stmt_id = block.back_stmt_id();
-			for( ; stmt_id >= block.begin_stmt_id; --iter, --stmt_id)
+		for(int stmt_id = block.back_stmt_id(); stmt_id >= block.begin_stmt_id; --stmt_id)
+		{
+			const auto &stmt = cfg.stmt(stmt_id);
+			if(std::holds_alternative<eeyore::FuncCallStmt>(stmt))
+				func_call_id.push_back(stmt_id);
+			else
 			{
-				if(std::holds_alternative<eeyore::FuncCallStmt>(*iter))
+				for(const auto &opr : eeyore::defined_vars(stmt))
 				{
-					func_call_id.push_back(stmt_id);
-					for(const auto &opr : cfg.global_vars())
-					{
-						DBG(std::cout << "func call may define " << opr << " at line " << stmt_id + 1 << std::endl);
-						var_live_interval_map[opr].set_begin(stmt_id);
-					}
+					int idx = cfg.local_var_idx(opr);
+					if(idx == -1)
+						continue;
+					DBG(std::cout << "defined " << opr << " at line " << stmt_id + 1 << std::endl);
+					_live_intervals[idx].set_begin(stmt_id);
 				}
-				else
+				for(const auto &opr : eeyore::used_vars(stmt))
 				{
-					for(const auto &opr : eeyore::defined_vars(*iter))
-					{
-						DBG(std::cout << "defined " << opr << " at line " << stmt_id + 1 << std::endl);
-						var_live_interval_map[opr].set_begin(stmt_id);
-					}
-					for(const auto &opr : eeyore::used_vars(*iter))
-					{
-						DBG(std::cout << "used " << opr << " at line " << stmt_id + 1 << std::endl);
-						var_live_interval_map[opr].add_range(block_from, stmt_id);
-					}
+					int idx = cfg.local_var_idx(opr);
+					if(idx == -1)
+						continue;
+					DBG(std::cout << "used " << opr << " at line " << stmt_id + 1 << std::endl);
+					_live_intervals[idx].add_range(block_from, stmt_id);
 				}
 			}
 		}
+	}
+
+	std::sort(_live_intervals.begin(), _live_intervals.end(),
+		LiveInterval::StartPointLessCmp());
+	
+	// Record the interval id of all variables. The local variables have the
+	// same uid range as in the cfg.
+	_uid_base = cfg.uid_base();
+	_interv_id_of_uid.clear();
+	_param_interv_ids.clear();
+	for(size_t j = 0; j < _live_intervals.size(); j++)
+	{
+		const auto &opr = _live_intervals[j].opr;
+		int idx = eeyore::uid_of(opr) - _uid_base;
+		if(idx >= (int)_interv_id_of_uid.size())
+			_interv_id_of_uid.resize(idx + 1, -1);
+		_interv_id_of_uid[idx] = j;
 
-		std::vector<LiveInterval> func_live_intervals;
-		for(auto &var_interv_pair : var_live_interval_map)
+		if(std::holds_alternative<eeyore::Param>(opr))
 		{
-			var_interv_pair.second.opr = var_interv_pair.first;
-			func_live_intervals.push_back(var_interv_pair.second);
+			int param_id = std::get<eeyore::Param>(opr).id;
+			if(param_id >= (int)_param_interv_ids.size())
+				_param_interv_ids.resize(param_id + 1, -1);
+			_param_interv_ids[param_id] = j;
 		}
-		std::sort(func_live_intervals.begin(), func_live_intervals.end(),
-			LiveInterval::StartPointLessCmp());
-		
-		// Check if there is a func_call inside each live interval.
-		for(LiveInterval &interv : func_live_intervals)
+	}
+
+	// Check if there is a func_call inside each live interval.
+	for(LiveInterval &interv : _live_intervals)
+	{
+		auto find_res = std::lower_bound(func_call_id.begin(), func_call_id.end(),
+			interv.back_stmt_id, std::greater<int>());
+		interv.cross_func_call =
+			find_res != func_call_id.end() && *find_res >= interv.begin_stmt_id;
+	}
+	DBG(
+		for(LiveInterval &interv : _live_intervals)
 		{
-			auto find_res = std::lower_bound(func_call_id.begin(), func_call_id.end(),
-				interv.back_stmt_id, std::greater<int>());
-			interv.cross_func_call =
-				find_res != func_call_id.end() && *find_res >= interv.begin_stmt_id;
+			std::cout << interv.opr << ": ["
+				<< interv.begin_stmt_id + 1 << ' '
+				<< interv.back_stmt_id + 1 << "], cross func: "
+				<< std::boolalpha << interv.cross_func_call << ", "
+				<< "size = " << (std::holds_alternative<eeyore::OrigVar>(interv.opr)? std::get<eeyore::OrigVar>(interv.opr).size : 0) << std::endl;
 		}
-		DBG(
-			for(LiveInterval &interv : func_live_intervals)
-			{
-				std::cout << interv.opr << ": ["
-					<< interv.begin_stmt_id + 1 << ' '
-					<< interv.back_stmt_id + 1 << "], cross func: "
-					<< std::boolalpha << interv.cross_func_call << ", "
-					<< "size = " << (std::holds_alternative<eeyore::OrigVar>(interv.opr)? std::get<eeyore::OrigVar>(interv.opr).size : 0) << std::endl;
-			}
-		);
-		_live_intervals.push_back(std::move(func_live_intervals));
-	}
+	);
 	
 	DBG(std::cout << "end live interval construction" << std::endl);
 }
 
-void RegAllocator::_calculate_live_intervals(
-	const EeyoreCode &eeyore_code, std::vector<eeyore::Operand> all_defined_var)
+void RegAllocator::_calculate_live_intervals(const EeyoreCode &eeyore_code,
+	const eeyore::EeyoreFunc &func)
 {
-	ControlFlowGraph cfg(eeyore_code, std::move(all_defined_var));
-	_global_vars.insert(cfg.global_vars().begin(), cfg.global_vars().end());
-	_calculate_local_live_sets(cfg);
-	_calculate_global_live_sets(cfg);
-	_build_intervals(cfg);
+	std::optional<ControlFlowGraph> cfg;
+	{
+		utils::TimeScope time_scope("cfg");
+		cfg.emplace(eeyore_code, func, *_is_global_uid);
+		utils::TimeReport::add_size("basic blocks", cfg->vertex_cnt());
+		utils::TimeReport::add_size("local variables", cfg->local_var_cnt());
+	}
+
+	utils::TimeScope time_scope("liveness");
+	{
+		utils::TimeScope time_scope("local live sets");
+		_calculate_local_live_sets(cfg.value());
+	}
+	{
+		utils::TimeScope time_scope("global live sets");
+		_calculate_global_live_sets(cfg.value());
+	}
+	{
+		utils::TimeScope time_scope("live intervals");
+		_build_intervals(cfg.value());
+		utils::TimeReport::add_size("live intervals", _live_intervals.size());
+		utils::TimeReport::add_size("live interval bytes",
+			_live_intervals.capacity() * sizeof(LiveInterval));
+	}
+	if(utils::TimeReport::enabled())
+	{
+		size_t bitmap_bytes = 0;
+		for(const auto &block : cfg->all_vertices())
+			bitmap_bytes += block.live_gen.bytes() + block.live_kill.bytes()
+				+ block.live_in.bytes() + block.live_out.bytes();
+		utils::TimeReport::add_size("bitmap bytes", bitmap_bytes);
+	}
 }
 
 void RegAllocator::initialize(
-	const EeyoreCode &eeyore_code,
-	std::vector<eeyore::Operand> all_defined_var,
+	const EeyoreCode &eeyore_code, const eeyore::EeyoreFunc &func,
+	const std::vector<bool> &is_global_uid,
 	std::vector<CalleeSavedReg> callee_saved,
 	std::vector<CallerSavedReg> caller_saved)
 {
-	_curr_func_id = 0;
+	_next_interv_id = 0;
+	_is_global_uid = &is_global_uid;
 
 	DBG(
 		std::cout << "configuring reg alloc" << std::endl;
@@ -273,21 +297,20 @@ void RegAllocator::initialize(
 			std::cout << reg << ' ';
 		std::cout << std::endl;
 	);
-	_regs.initialize(
-		std::deque<CalleeSavedReg>(callee_saved.begin(), callee_saved.end()),
-		std::deque<CallerSavedReg>(caller_saved.begin(), caller_saved.end()));
-	_calculate_live_intervals(eeyore_code, std::move(all_defined_var));
+	_regs.initialize(std::move(callee_saved), std::move(caller_saved));
+	_calculate_live_intervals(eeyore_code, func);
 }
 
 void RegAllocator::_expire_old_intervals(int stmt_id)
 {
 	while(!_active.empty())
 	{
-		const auto &first_interval = _live_intervals[_curr_func_id][_active.front()];
+		const auto &first_interval = _live_intervals[_active_front()];
 		if(first_interval.back_stmt_id >= stmt_id)
 			break;
 		_regs.return_reg_of(first_interval);
-		_active.pop_front();
+		_is_active[_active_front()] = false;
+		_active.erase(_active.begin());
 	}
 }
 
@@ -297,7 +320,7 @@ void RegAllocator::_spill_at_interval(
 {
 	// Check which operand we will have to spill. We always try to replace
 	// the operand with the last interval endpoint.
-	auto &spill = _live_intervals[_curr_func_id][_active.back()];
+	auto &spill = _live_intervals[_active_back()];
 	if(interv.back_stmt_id <= spill.back_stmt_id) // do spill
 	{
 		INTERNAL_ASSERT(spill.reg.has_value(),
@@ -309,7 +332,8 @@ void RegAllocator::_spill_at_interval(
 			changes.push_back({interv.pre_assigned_reg.value(), interv.reg.value()});
 		changes.push_back({spill.reg.value(), spill.stack_loc.value()});
 
-		_active.pop_back();
+		_is_active[_active_back()] = false;
+		_active.erase(std::prev(_active.end()));
 		_add_to_active(interv_id);
 	}
 	else // simply spill the new variable to memory
@@ -329,8 +353,6 @@ void RegAllocator::_spill_at_interval(
 std::vector<RegAllocator::AllocationChange>
 RegAllocator::allocate_for(const eeyore::EeyoreStatement &stmt, int stmt_id)
 {
-	static int live_interv_id = 0;
-
 	DBG(std::cout << "allocate register for " << stmt);
 	std::vector<AllocationChange> changes;
 
@@ -338,22 +360,23 @@ RegAllocator::allocate_for(const eeyore::EeyoreStatement &stmt, int stmt_id)
 	if(std::holds_alternative<eeyore::FuncDefStmt>(stmt))
 	{
 		_active.clear();
+		_is_active.assign(_live_intervals.size(), false);
 		_regs.reset();
 		_stack.reset();
-		live_interv_id = 0;
+		_next_interv_id = 0;
 	}
 	else if(std::holds_alternative<eeyore::EndFuncDefStmt>(stmt))
 	{
-		_curr_func_id++;
+		_active.clear();
 	}
 	else
 	{
 		for( ;
-			live_interv_id < _live_intervals.at(_curr_func_id).size()
-				&& _live_intervals.at(_curr_func_id).at(live_interv_id).begin_stmt_id <= stmt_id;
-			live_interv_id++)
+			_next_interv_id < (int)_live_intervals.size()
+				&& _live_intervals.at(_next_interv_id).begin_stmt_id <= stmt_id;
+			_next_interv_id++)
 		{
-			auto &interv = _live_intervals.at(_curr_func_id).at(live_interv_id);
+			auto &interv = _live_intervals.at(_next_interv_id);
 
 			// Check if this is an argument.
 			if(std::holds_alternative<eeyore::Param>(interv.opr))
@@ -385,13 +408,13 @@ RegAllocator::allocate_for(const eeyore::EeyoreStatement &stmt, int stmt_id)
 				{
 					DBG(std::cout << "getting s reg for " << interv.opr << std::endl);
 					_regs.get_callee_saved_for(interv);
-					_add_to_active(live_interv_id);
+					_add_to_active(_next_interv_id);
 
 					if(interv.pre_assigned_reg.has_value())
 						changes.push_back({interv.pre_assigned_reg.value(), interv.reg.value()});
 				}
 				else
-					_spill_at_interval(interv, live_interv_id, changes);
+					_spill_at_interval(interv, _next_interv_id, changes);
 			}
 			else
 			{
@@ -399,7 +422,7 @@ RegAllocator::allocate_for(const eeyore::EeyoreStatement &stmt, int stmt_id)
 				{
 					DBG(std::cout << "getting t reg for " << interv.opr << std::endl);
 					_regs.get_caller_saved_for(interv);
-					_add_to_active(live_interv_id);
+					_add_to_active(_next_interv_id);
 
 					if(interv.pre_assigned_reg.has_value())
 						changes.push_back({interv.pre_assigned_reg.value(), interv.reg.value()});
@@ -408,28 +431,28 @@ RegAllocator::allocate_for(const eeyore::EeyoreStatement &stmt, int stmt_id)
 				{
 					DBG(std::cout << "getting s reg for " << interv.opr << std::endl);
 					_regs.get_callee_saved_for(interv);
-					_add_to_active(live_interv_id);
+					_add_to_active(_next_interv_id);
 
 					if(interv.pre_assigned_reg.has_value())
 						changes.push_back({interv.pre_assigned_reg.value(), interv.reg.value()});
 				}
 				else
-					_spill_at_interval(interv, live_interv_id, changes);
+					_spill_at_interval(interv, _next_interv_id, changes);
 			}
 		}
 
 		DBG(
 			std::cout << "after allocation: " << std::endl;
 			std::cout << "active variables: " << std::endl;
-			for(int active_idx : _active)
+			for(const auto &active_pair : _active)
 			{
-				const auto &interv = _live_intervals.at(_curr_func_id).at(active_idx);
+				const auto &interv = _live_intervals.at(-active_pair.second);
 				std::cout << interv.opr << " -> " << interv.reg.value() << std::endl;
 			}
 			std::cout << "all variables in current function: " << std::endl;
-			for(int i = 0; i < live_interv_id; i++)
+			for(int i = 0; i < _next_interv_id; i++)
 			{
-				const auto &interv = _live_intervals.at(_curr_func_id).at(i);
+				const auto &interv = _live_intervals.at(i);
 				std::cout << interv.opr << ": reg ";
 				if(!interv.reg.has_value() && !interv.pre_assigned_reg.has_value())
 					std::cout << "not allocated";
@@ -458,59 +481,74 @@ RegAllocator::allocate_for(const eeyore::EeyoreStatement &stmt, int stmt_id)
 
 bool RegAllocator::is_global_var(const eeyore::Operand &opr) const
 {
-	return _global_vars.find(opr) != _global_vars.end();
+	int uid = eeyore::uid_of(opr);
+	return uid >= 0 && uid < (int)_is_global_uid->size() && (*_is_global_uid)[uid];
+}
+
+// The interval of an operand, or nullptr if there is no such interval (e.g.
+// a global variable).
+const LiveInterval *RegAllocator::_interval_of(const eeyore::Operand &opr) const
+{
+	int idx = eeyore::uid_of(opr) - _uid_base;
+	if(idx < 0 || idx >= (int)_interv_id_of_uid.size() || _interv_id_of_uid[idx] == -1)
+		return nullptr;
+	return &_live_intervals[_interv_id_of_uid[idx]];
 }
 
 // The actual stored register of an operand.
 std::optional<Reg> RegAllocator::reg_of(const eeyore::Operand &opr) const
 {
-	for(const LiveInterval &interv : _live_intervals.at(_curr_func_id))
-		if(interv.opr == opr)
-		{
-			if(interv.reg.has_value())
-				return interv.reg;
-			return interv.pre_assigned_reg;
-		}
-	return std::nullopt;
+	const LiveInterval *interv = _interval_of(opr);
+	if(interv == nullptr)
+		return std::nullopt;
+	if(interv->reg.has_value())
+		return interv->reg;
+	return interv->pre_assigned_reg;
+}
+
+// The actual stored register of the param_id-th parameter of the function.
+std::optional<Reg> RegAllocator::reg_of_param(int param_id) const
+{
+	if(param_id >= (int)_param_interv_ids.size() || _param_interv_ids[param_id] == -1)
+		return std::nullopt;
+	const LiveInterval &interv = _live_intervals[_param_interv_ids[param_id]];
+	if(interv.reg.has_value())
+		return interv.reg;
+	return interv.pre_assigned_reg;
 }
 
 // The stack position of an operand.
 std::optional<int> RegAllocator::stack_pos_of(const eeyore::Operand &opr) const
 {
-	// TODO: This is a O(n) algorithm. Optimize it later.
-	for(const LiveInterval &interv : _live_intervals.at(_curr_func_id))
-		if(interv.opr == opr)
-			return interv.stack_loc;
-	return std::nullopt;
+	const LiveInterval *interv = _interval_of(opr);
+	if(interv == nullptr)
+		return std::nullopt;
+	return interv->stack_loc;
 }
 
 // The (current) actual position of an operand, can be either in a register or
 // in the stack.
 std::optional<RegOrNum> RegAllocator::actual_pos_of(const eeyore::Operand &opr) const
 {
-	const auto &active_intervs = _live_intervals.at(_curr_func_id);
-	for(int active_idx : _active)
+	const LiveInterval *interv = _interval_of(opr);
+	if(interv == nullptr)
+		return std::nullopt;
+	if(_is_active[interv - _live_intervals.data()])
 	{
-		const LiveInterval &interv = active_intervs.at(active_idx);
-		if(interv.opr == opr)
-		{
-			INTERNAL_ASSERT(interv.reg.has_value(),
-				"found an active operand not assigned a register");
-			return interv.reg.value();
-		}
+		INTERNAL_ASSERT(interv->reg.has_value(),
+			"found an active operand not assigned a register");
+		return interv->reg.value();
 	}
 
 	// We have to check if the operand is stored in argument register, since
 	// active in an argument register is not considered as "active".
-	// This is bad, TODO: change it later.
-	auto reg = reg_of(opr);
+	auto reg = interv->reg.has_value()? interv->reg : interv->pre_assigned_reg;
 	if(reg.has_value() && std::holds_alternative<ArgReg>(reg.value()))
 		return reg.value();
 	
 	// The operand must be stored in the stack.
-	auto stack_pos = stack_pos_of(opr);
-	if(stack_pos.has_value())
-		return stack_pos.value();
+	if(interv->stack_loc.has_value())
+		return interv->stack_loc.value();
 	else
 		return std::nullopt;
 }
@@ -2,9 +2,8 @@
 #define REG_ALLOC_H
 
 #include <vector>
-#include <list>
-#include <deque>
-#include <unordered_set>
+#include <set>
+#include <cstdint>
 #include "exceptions.h"
 #include "visitor_helper.h"
 #include "eeyore.h"
@@ -15,41 +14,46 @@
 namespace compiler::backend::tigger
 {
 
-// Linear-scan register allocator.
+// Linear-scan register allocator of a function.
 class RegAllocator
 {
   protected:
-	using EeyoreCode = std::list<eeyore::EeyoreStatement>;
-	using EeyoreStmtPtr = std::list<eeyore::EeyoreStatement>::const_iterator;
+	using EeyoreCode = eeyore::EeyoreCode;
 
 	class _RegisterManager
 	{
 	  protected:
-		// All the registers.
-		std::deque<CalleeSavedReg> _callee_saved_regs;
-		std::deque<CallerSavedReg> _caller_saved_regs;
+		// All the registers, sorted.
+		std::vector<CalleeSavedReg> _callee_saved_regs;
+		std::vector<CallerSavedReg> _caller_saved_regs;
 
-		// The free registers.
-		std::deque<CalleeSavedReg> _free_callee_saved_regs;
-		std::deque<CallerSavedReg> _free_caller_saved_regs;
+		// The free registers. Bit i is set if the i-th register above is free,
+		// so that the smallest free register can be found by find-first-set.
+		uint32_t _free_callee_saved_mask;
+		uint32_t _free_caller_saved_mask;
 
 		// Number of registers that must be used in this function.
 		int _max_callee_saved_regs_use;
 		int _max_caller_saved_regs_use;
 
+		inline static uint32_t _full_mask(int size)
+			{ return size == 32? ~uint32_t(0) : (uint32_t(1) << size) - 1; }
+
 	  public:
 	  	_RegisterManager() = default;
 		_RegisterManager(
-			std::deque<CalleeSavedReg> callee_saved_regs,
-			std::deque<CallerSavedReg> caller_saved_regs)
+			std::vector<CalleeSavedReg> callee_saved_regs,
+			std::vector<CallerSavedReg> caller_saved_regs)
 		{
 			initialize(std::move(callee_saved_regs), std::move(caller_saved_regs));
 		}
 
 		inline void initialize(
-			std::deque<CalleeSavedReg> callee_saved_regs,
-			std::deque<CallerSavedReg> caller_saved_regs)
+			std::vector<CalleeSavedReg> callee_saved_regs,
+			std::vector<CallerSavedReg> caller_saved_regs)
 		{
+			INTERNAL_ASSERT(callee_saved_regs.size() <= 32 && caller_saved_regs.size() <= 32,
+				"too many registers for the register pool");
 			_callee_saved_regs = std::move(callee_saved_regs);
 			_caller_saved_regs = std::move(caller_saved_regs);
 			std::sort(_callee_saved_regs.begin(), _callee_saved_regs.end(),
@@ -59,38 +63,38 @@ class RegAllocator
 		}
 	  	inline void reset()
 		{
-			_free_callee_saved_regs = _callee_saved_regs;
-			_free_caller_saved_regs = _caller_saved_regs;
+			_free_callee_saved_mask = _full_mask(_callee_saved_regs.size());
+			_free_caller_saved_mask = _full_mask(_caller_saved_regs.size());
 			_max_callee_saved_regs_use = 0;
 			_max_caller_saved_regs_use = 0;
 		}
 		inline CalleeSavedReg callee_saved_reg(int idx) const
 			{ return _callee_saved_regs.at(idx); }
-		inline bool callee_saved_empty() const { return _free_callee_saved_regs.empty(); }
-		inline bool caller_saved_empty() const { return _free_caller_saved_regs.empty();	}
+		inline bool callee_saved_empty() const { return _free_callee_saved_mask == 0; }
+		inline bool caller_saved_empty() const { return _free_caller_saved_mask == 0; }
 		inline int max_callee_saved_use() const { return _max_callee_saved_regs_use; }
 		inline int max_caller_saved_use() const { return _max_caller_saved_regs_use; }
 
 	  protected:
 		inline CalleeSavedReg _get_callee_saved()
 		{
-			INTERNAL_ASSERT(!_free_callee_saved_regs.empty(),
+			INTERNAL_ASSERT(_free_callee_saved_mask != 0,
 				"try to get a callee saved register from empty register pool");
-			auto reg = _free_callee_saved_regs.front();
-			_free_callee_saved_regs.pop_front();
+			int idx = __builtin_ctz(_free_callee_saved_mask);
+			_free_callee_saved_mask &= _free_callee_saved_mask - 1;
 			_max_callee_saved_regs_use = std::max<int>(_max_callee_saved_regs_use,
-				_callee_saved_regs.size() - _free_callee_saved_regs.size());
-			return reg;
+				_callee_saved_regs.size() - __builtin_popcount(_free_callee_saved_mask));
+			return _callee_saved_regs[idx];
 		}
 		inline CallerSavedReg _get_caller_saved()
 		{
-			INTERNAL_ASSERT(!_free_caller_saved_regs.empty(),
+			INTERNAL_ASSERT(_free_caller_saved_mask != 0,
 				"try to get a caller saved register from empty register pool");
-			auto reg = _free_caller_saved_regs.front();
-			_free_caller_saved_regs.pop_front();
+			int idx = __builtin_ctz(_free_caller_saved_mask);
+			_free_caller_saved_mask &= _free_caller_saved_mask - 1;
 			_max_caller_saved_regs_use = std::max<int>(_max_caller_saved_regs_use,
-				_caller_saved_regs.size() - _free_caller_saved_regs.size());
-			return reg;
+				_caller_saved_regs.size() - __builtin_popcount(_free_caller_saved_mask));
+			return _caller_saved_regs[idx];
 		}
 
 		void _return_callee_saved(CalleeSavedReg reg);
@@ -158,16 +162,31 @@ class RegAllocator
 	}
 
   protected:
-	// All the live intervals. For all the live intervals in a function, they
-	// are sorted in increasing order of start point.
-	std::vector<std::vector<LiveInterval>> _live_intervals;
-
-	// The active intervals of the current function. Always sorted by endpoint.
-	int _curr_func_id;
-	std::deque<int> _active;
-
-	// All the global variables, do not allocate registers for them.
-	std::unordered_set<eeyore::Operand> _global_vars;
+	// All the live intervals of the function, sorted in increasing order of
+	// start point.
+	std::vector<LiveInterval> _live_intervals;
+
+	// The active intervals, stored as (back_stmt_id, -interval id), so that
+	// they are ordered by endpoint and the earliest added one is the last
+	// among the same endpoint.
+	int _next_interv_id; // The next interval to start.
+	std::set<std::pair<int, int>> _active;
+	inline int _active_front() const { return -_active.begin()->second; }
+	inline int _active_back() const { return -_active.rbegin()->second; }
+	std::vector<bool> _is_active; // Indexed by interval id.
+
+	// Location map: the interval id of each variable, indexed by
+	// uid - _uid_base. -1 for variables without interval.
+	int _uid_base;
+	std::vector<int> _interv_id_of_uid;
+	// The interval id of each parameter.
+	std::vector<int> _param_interv_ids;
+
+	const LiveInterval *_interval_of(const eeyore::Operand &opr) const;
+
+	// All the global variables (indexed by uid), do not allocate registers
+	// for them. Shared by all the functions.
+	const std::vector<bool> *_is_global_uid;
 
 	void _add_to_active(int interv_id);
 
@@ -175,13 +194,15 @@ class RegAllocator
 	void _calculate_local_live_sets(ControlFlowGraph &cfg);
 	void _calculate_global_live_sets(ControlFlowGraph &cfg);
 	void _build_intervals(const ControlFlowGraph &cfg);
-	void _calculate_live_intervals(
-		const EeyoreCode &eeyore_code, std::vector<eeyore::Operand> all_defined_var);
+	void _calculate_live_intervals(const EeyoreCode &eeyore_code,
+		const eeyore::EeyoreFunc &func);
 
   public:
+	// Prepares the allocation of a function of a compact code. is_global_uid
+	// must outlive the allocator.
 	void initialize(
-		const EeyoreCode &eeyore_code,
-		std::vector<eeyore::Operand> all_defined_var,
+		const EeyoreCode &eeyore_code, const eeyore::EeyoreFunc &func,
+		const std::vector<bool> &is_global_uid,
 		std::vector<CalleeSavedReg> callee_saved,
 		std::vector<CallerSavedReg> caller_saved);
 	
@@ -200,12 +221,13 @@ class RegAllocator
 	std::vector<AllocationChange>
 	allocate_for(const eeyore::EeyoreStatement &stmt, int stmt_id);
 
-	inline const std::vector<std::vector<LiveInterval>> &live_intervals() const
+	inline const std::vector<LiveInterval> &live_intervals() const
 		{ return _live_intervals; }
 
 	// query functions.
 	bool is_global_var(const eeyore::Operand &opr) const;
 	std::optional<Reg> reg_of(const eeyore::Operand &opr) const;
+	std::optional<Reg> reg_of_param(int param_id) const;
 	std::optional<int> stack_pos_of(const eeyore::Operand &opr) const;
 	std::optional<RegOrNum> actual_pos_of(const eeyore::Operand &opr) const;
 };
@@ -4,7 +4,6 @@
 #include "exceptions.h"
 #include "ast_node.h"
 
-using std::endl;
 using std::holds_alternative;
 
 namespace
@@ -28,49 +27,85 @@ int RiscvPrinter::riscv_xalloc = std::ios::xalloc();
 
 void RiscvPrinter::operator() (const tigger::GlobalVarDeclStmt &stmt)
 {
-	out << "  .global " << stmt.var << endl;
-	out << "  .section .sdata" << endl;
-	out << "  .align 2" << endl;
-	out << "  .type " << stmt.var << ", @object" << endl;
-	out << "  .size " << stmt.var << ", 4" << endl;
-	out << stmt.var << ':' << endl;
-	out << "  .word " << stmt.initial_val << endl;
+	out << "  .global " << stmt.var << '\n';
+	out << "  .section .sdata" << '\n';
+	out << "  .align 2" << '\n';
+	out << "  .type " << stmt.var << ", @object" << '\n';
+	out << "  .size " << stmt.var << ", 4" << '\n';
+	out << stmt.var << ':' << '\n';
+	out << "  .word " << stmt.initial_val << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::GlobalArrDeclStmt &stmt)
 {
-	out << "  .comm " << stmt.var << ", " << stmt.size << ", 4" << endl;
+	out << "  .comm " << stmt.var << ", " << stmt.size << ", 4" << '\n';
+}
+
+// The runs of initial values are .word lines, and the gaps between them .zero.
+void RiscvPrinter::operator() (const tigger::GlobalArrInitDeclStmt &stmt)
+{
+	static constexpr int WORDS_PER_LINE = 16;
+
+	out << "  .global " << stmt.var << '\n';
+	out << "  .data" << '\n';
+	out << "  .align 2" << '\n';
+	out << "  .type " << stmt.var << ", @object" << '\n';
+	out << "  .size " << stmt.var << ", " << stmt.size << '\n';
+	out << stmt.var << ':' << '\n';
+	int next_offset = 0, line_words = 0;
+	for(auto [offset, val] : stmt.initial_vals)
+	{
+		if(offset != next_offset)
+		{
+			if(line_words != 0)
+				out << '\n';
+			out << "  .zero " << offset - next_offset << '\n';
+			line_words = 0;
+		}
+		if(line_words == WORDS_PER_LINE)
+		{
+			out << '\n';
+			line_words = 0;
+		}
+		out << (line_words == 0? "  .word " : ", ") << val;
+		line_words++;
+		next_offset = offset + 4;
+	}
+	if(line_words != 0)
+		out << '\n';
+	if(next_offset != stmt.size)
+		out << "  .zero " << stmt.size - next_offset << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::FuncHeaderStmt &stmt)
 {
-	auto actual_func_name = stmt.func_name.substr(2);
+	auto actual_func_name = std::string_view(stmt.func_name.str()).substr(2);
 	int stack_size_bytes = (stmt.stack_size / 4 + 1) * 16;
 	_stack_size = stack_size_bytes;
-	out << "  .text" << endl;
-	out << "  .align 2" << endl;
-	out << "  .global " << actual_func_name << endl;
-	out << "  .type " << actual_func_name << ", @function" << endl;
-	out << actual_func_name << ':' << endl;
+	out << "  .text" << '\n';
+	out << "  .align 2" << '\n';
+	out << "  .global " << actual_func_name << '\n';
+	out << "  .type " << actual_func_name << ", @function" << '\n';
+	out << actual_func_name << ':' << '\n';
 
 	if(is_12bit(stack_size_bytes))
 	{
-		out << "  addi sp, sp, -" << stack_size_bytes << endl;
-		out << "  sw ra, " << stack_size_bytes - 4 << "(sp)" << endl;
+		out << "  addi sp, sp, -" << stack_size_bytes << '\n';
+		out << "  sw ra, " << stack_size_bytes - 4 << "(sp)" << '\n';
 	}
 	else
 	{
-		out << "  sw ra, -4(sp)" << endl;
-		out << "  li " << scratch_reg << ", " << stack_size_bytes << endl;
-		out << "  sub sp, sp, " << scratch_reg << endl;
+		out << "  sw ra, -4(sp)" << '\n';
+		out << "  li " << scratch_reg << ", " << stack_size_bytes << '\n';
+		out << "  sub sp, sp, " << scratch_reg << '\n';
 	}
 }
 
 void RiscvPrinter::operator() (const tigger::FuncEndStmt &stmt)
 {
-	auto actual_func_name = stmt.func_name.substr(2);
-	out << "  .size   " << actual_func_name << ", .-" << actual_func_name << endl;
-	out << endl;
+	auto actual_func_name = std::string_view(stmt.func_name.str()).substr(2);
+	out << "  .size   " << actual_func_name << ", .-" << actual_func_name << '\n';
+	out << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::UnaryOpStmt &stmt)
@@ -78,9 +113,9 @@ void RiscvPrinter::operator() (const tigger::UnaryOpStmt &stmt)
 	switch(stmt.op_type)
 	{
 		case frontend::UnaryOpNode::NEG:
-			out << "  neg " << stmt.opr << ", " << stmt.opr1 << endl; break;
+			out << "  neg " << stmt.opr << ", " << stmt.opr1 << '\n'; break;
 		case frontend::UnaryOpNode::NOT:
-			out << "  seqz " << stmt.opr << ", " << stmt.opr1 << endl; break;
+			out << "  seqz " << stmt.opr << ", " << stmt.opr1 << '\n'; break;
 		default:
 			INTERNAL_ERROR("invalid unary op type");
 	}
@@ -90,33 +125,33 @@ void RiscvPrinter::operator() (const tigger::BinaryOpStmt &stmt)
 {
 	// generate the one-statement "Op reg1, reg2, reg3" type instructions,
 	// or "Opi reg1, reg2, imm" if needed.
-	static auto gen_imm_binary =
-	[this](const tigger::BinaryOpStmt &stmt, std::string op_name)
+	auto gen_imm_binary =
+	[this](const tigger::BinaryOpStmt &stmt, const char *op_name)
 	{
 		if(holds_alternative<int>(stmt.opr2))
 		{
 			int opr2_val = std::get<int>(stmt.opr2);
 			if(is_12bit(opr2_val))
 				out << "  " << op_name << "i " << stmt.opr << ", " << stmt.opr1
-					<< ", " << opr2_val << endl;
+					<< ", " << opr2_val << '\n';
 			else
 			{
-				out << "  li " << scratch_reg << ", " << opr2_val << endl;
+				out << "  li " << scratch_reg << ", " << opr2_val << '\n';
 				out << "  " << op_name << ' ' << stmt.opr << ", " << stmt.opr1
-					<< ", " << scratch_reg << endl;
+					<< ", " << scratch_reg << '\n';
 			}
 		}
 		else
 		{
 			out << "  " << op_name << ' ' << stmt.opr << ", " << stmt.opr1
-				<< ", " << stmt.opr2 << endl;
+				<< ", " << stmt.opr2 << '\n';
 		}
 	};
 
 	// always load the immediate to scratch register, since there is no
 	// corresponding I-instructions.
-	static auto gen_always_load_binary =
-	[this](const tigger::BinaryOpStmt &stmt, std::string op_name)
+	auto gen_always_load_binary =
+	[this](const tigger::BinaryOpStmt &stmt, const char *op_name)
 	{
 		if(holds_alternative<int>(stmt.opr2))
 		{
@@ -124,19 +159,19 @@ void RiscvPrinter::operator() (const tigger::BinaryOpStmt &stmt)
 			if(opr2_val == 0)
 			{
 				out << "  " << op_name << ' ' << stmt.opr << ", " << stmt.opr1
-					<< ", x0" << endl;
+					<< ", x0" << '\n';
 			}
 			else
 			{
-				out << "  li " << scratch_reg << ", " << opr2_val << endl;
+				out << "  li " << scratch_reg << ", " << opr2_val << '\n';
 				out << "  " << op_name << ' ' << stmt.opr << ", " << stmt.opr1
-					<< ", " << scratch_reg << endl;
+					<< ", " << scratch_reg << '\n';
 			}
 		}
 		else
 		{
 			out << "  " << op_name << ' ' << stmt.opr << ", " << stmt.opr1
-				<< ", " << stmt.opr2 << endl;
+				<< ", " << stmt.opr2 << '\n';
 		}
 	};
 
@@ -150,18 +185,18 @@ void RiscvPrinter::operator() (const tigger::BinaryOpStmt &stmt)
 				int opr2_val = -std::get<int>(stmt.opr2);
 				if(is_12bit(opr2_val))
 					out << "  addi " << stmt.opr << ", " << stmt.opr1
-						<< ", " << opr2_val << endl;
+						<< ", " << opr2_val << '\n';
 				else
 				{
-					out << "  li " << scratch_reg << ", " << opr2_val << endl;
-					out << "  addi " << stmt.opr << ", " << stmt.opr1
-						<< ", " << scratch_reg << endl;
+					out << "  li " << scratch_reg << ", " << opr2_val << '\n';
+					out << "  add " << stmt.opr << ", " << stmt.opr1
+						<< ", " << scratch_reg << '\n';
 				}
 			}
 			else
 			{
 				out << "  sub " << stmt.opr << ", " << stmt.opr1
-					<< ", " << stmt.opr2 << endl;
+					<< ", " << stmt.opr2 << '\n';
 			}
 			break;
 		case frontend::BinaryOpNode::MUL:
@@ -172,21 +207,21 @@ void RiscvPrinter::operator() (const tigger::BinaryOpStmt &stmt)
 			gen_always_load_binary(stmt, "rem"); break;
 		case frontend::BinaryOpNode::OR:
 			gen_imm_binary(stmt, "or");
-			out << "  snez " << stmt.opr << ", " << stmt.opr << endl;
+			out << "  snez " << stmt.opr << ", " << stmt.opr << '\n';
 			break;
 		case frontend::BinaryOpNode::AND:
 			if(std::holds_alternative<int>(stmt.opr2))
 			{
 				if(std::get<int>(stmt.opr2) == 0)
-					out << "  li " << stmt.opr << ", " << 0 << endl;
+					out << "  li " << stmt.opr << ", " << 0 << '\n';
 				else
-					out << "  snez " << stmt.opr << ", " << stmt.opr1 << endl;
+					out << "  snez " << stmt.opr << ", " << stmt.opr1 << '\n';
 			}
 			else
 			{
-				out << "  snez " << stmt.opr << ", " << stmt.opr1 << endl;
-				out << "  snez " << scratch_reg << ", " << stmt.opr2 << endl;
-				out << "  and " << stmt.opr << ", " << stmt.opr << ", " << scratch_reg << endl;
+				out << "  snez " << stmt.opr << ", " << stmt.opr1 << '\n';
+				out << "  snez " << scratch_reg << ", " << stmt.opr2 << '\n';
+				out << "  and " << stmt.opr << ", " << stmt.opr << ", " << scratch_reg << '\n';
 			}
 			break;
 		case frontend::BinaryOpNode::GT:
@@ -195,19 +230,19 @@ void RiscvPrinter::operator() (const tigger::BinaryOpStmt &stmt)
 			gen_imm_binary(stmt, "slt"); break;
 		case frontend::BinaryOpNode::GE:
 			gen_imm_binary(stmt, "slt");
-			out << "  seqz " << stmt.opr << ", " << stmt.opr << endl;
+			out << "  seqz " << stmt.opr << ", " << stmt.opr << '\n';
 			break;
 		case frontend::BinaryOpNode::LE:
 			gen_always_load_binary(stmt, "sgt");
-			out << "  seqz " << stmt.opr << ", " << stmt.opr << endl;
+			out << "  seqz " << stmt.opr << ", " << stmt.opr << '\n';
 			break;
 		case frontend::BinaryOpNode::EQ:
 			gen_imm_binary(stmt, "xor");
-			out << "  seqz " << stmt.opr << ", " << stmt.opr << endl;
+			out << "  seqz " << stmt.opr << ", " << stmt.opr << '\n';
 			break;
 		case frontend::BinaryOpNode::NE:
 			gen_imm_binary(stmt, "xor");
-			out << "  snez " << stmt.opr << ", " << stmt.opr << endl;
+			out << "  snez " << stmt.opr << ", " << stmt.opr << '\n';
 			break;
 		default:
 			INTERNAL_ERROR("invalid binary op type");
@@ -217,38 +252,38 @@ void RiscvPrinter::operator() (const tigger::BinaryOpStmt &stmt)
 void RiscvPrinter::operator() (const tigger::MoveStmt &stmt)
 {
 	if(holds_alternative<tigger::Reg>(stmt.opr1))
-		out << "  mv " << stmt.opr << ", " << stmt.opr1 << endl;
+		out << "  mv " << stmt.opr << ", " << stmt.opr1 << '\n';
 	else // int
 	{
 		int val = std::get<int>(stmt.opr1);
 		if(val == 0)
-			out << "  mv " << stmt.opr << ", x0" << endl;
+			out << "  mv " << stmt.opr << ", x0" << '\n';
 		else
-			out << "  li " << stmt.opr << ", " << val << endl;
+			out << "  li " << stmt.opr << ", " << val << '\n';
 	}
 }
 
 void RiscvPrinter::operator() (const tigger::ReadArrStmt &stmt)
 {
 	if(is_12bit(stmt.idx))
-		out << "  lw " << stmt.opr << ", " << stmt.idx << '(' << stmt.opr1 << ')' << endl;
+		out << "  lw " << stmt.opr << ", " << stmt.idx << '(' << stmt.opr1 << ')' << '\n';
 	else // We have to calculate the actual address.
 	{
-		out << "  li " << scratch_reg << ", " << stmt.idx << endl;
-		out << "  add " << scratch_reg << ", " << scratch_reg << ", " << stmt.opr1 << endl;
-		out << "  lw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << endl;
+		out << "  li " << scratch_reg << ", " << stmt.idx << '\n';
+		out << "  add " << scratch_reg << ", " << scratch_reg << ", " << stmt.opr1 << '\n';
+		out << "  lw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << '\n';
 	}
 }
 
 void RiscvPrinter::operator() (const tigger::WriteArrStmt &stmt)
 {
 	if(is_12bit(stmt.idx))
-		out << "  sw " << stmt.opr << ", " << stmt.idx << '(' << stmt.opr1 << ')' << endl;
+		out << "  sw " << stmt.opr << ", " << stmt.idx << '(' << stmt.opr1 << ')' << '\n';
 	else
 	{
-		out << "  li " << scratch_reg << ", " << stmt.idx << endl;
-		out << "  add " << scratch_reg << ", " << scratch_reg << ", " << stmt.opr1 << endl;
-		out << "  sw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << endl;
+		out << "  li " << scratch_reg << ", " << stmt.idx << '\n';
+		out << "  add " << scratch_reg << ", " << scratch_reg << ", " << stmt.opr1 << '\n';
+		out << "  sw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << '\n';
 	}
 }
 
@@ -265,50 +300,50 @@ void RiscvPrinter::operator() (const tigger::CondGotoStmt &stmt)
 		case frontend::BinaryOpNode::EQ: out << "beq"; break;
 		default: INTERNAL_ERROR("invalid condition op type");
 	}
-	out << ' ' << stmt.opr1 << ", " << stmt.opr2 << ", ." << stmt.goto_label << endl;
+	out << ' ' << stmt.opr1 << ", " << stmt.opr2 << ", ." << stmt.goto_label << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::GotoStmt &stmt)
 {
-	out << "  j ." << stmt.goto_label << endl;
+	out << "  j ." << stmt.goto_label << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::LabelStmt &stmt)
 {
-	out << '.' << stmt.label << ':' << endl;
+	out << '.' << stmt.label << ':' << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::FuncCallStmt &stmt)
 {
-	auto actual_func_name = stmt.func_name.substr(2);
-	out << "  call " << actual_func_name << endl;
+	auto actual_func_name = std::string_view(stmt.func_name.str()).substr(2);
+	out << "  call " << actual_func_name << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::ReturnStmt &stmt)
 {
 	if(is_12bit(_stack_size))
 	{
-		out << "  lw ra, " << _stack_size-4 << "(sp)" << endl;
-		out << "  addi sp, sp, " << _stack_size << endl;
+		out << "  lw ra, " << _stack_size-4 << "(sp)" << '\n';
+		out << "  addi sp, sp, " << _stack_size << '\n';
 	}
 	else
 	{
-		out << "  li " << scratch_reg << ", " << _stack_size << endl;
-		out << "  add sp, sp, " << scratch_reg << endl;
-		out << "  lw ra, -4(sp)" << endl;
+		out << "  li " << scratch_reg << ", " << _stack_size << '\n';
+		out << "  add sp, sp, " << scratch_reg << '\n';
+		out << "  lw ra, -4(sp)" << '\n';
 	}
-	out << "  ret" << endl;
+	out << "  ret" << '\n';
 }
 
 void RiscvPrinter::operator() (const tigger::StoreStmt &stmt)
 {
 	if(is_10bit(stmt.stack_offset))
-		out << "  sw " << stmt.opr << ", " << stmt.stack_offset*4 << "(sp)" << endl;
+		out << "  sw " << stmt.opr << ", " << stmt.stack_offset*4 << "(sp)" << '\n';
 	else
 	{
-		out << "  li " << scratch_reg << ", " << stmt.stack_offset*4 << endl;
-		out << "  add " << scratch_reg << ", " << scratch_reg << ", sp" << endl;
-		out << "  sw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << endl;
+		out << "  li " << scratch_reg << ", " << stmt.stack_offset*4 << '\n';
+		out << "  add " << scratch_reg << ", " << scratch_reg << ", sp" << '\n';
+		out << "  sw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << '\n';
 	}
 }
 
@@ -318,19 +353,19 @@ void RiscvPrinter::operator() (const tigger::LoadStmt &stmt)
 	{
 		int stack_offset = std::get<int>(stmt.src);
 		if(is_10bit(stack_offset))
-			out << "  lw " << stmt.opr << ", " << stack_offset*4 << "(sp)" << endl;
+			out << "  lw " << stmt.opr << ", " << stack_offset*4 << "(sp)" << '\n';
 		else
 		{
-			out << "  li " << scratch_reg << ", " << stack_offset*4 << endl;
-			out << "  add " << scratch_reg << ", " << scratch_reg << ", sp" << endl;
-			out << "  lw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << endl;
+			out << "  li " << scratch_reg << ", " << stack_offset*4 << '\n';
+			out << "  add " << scratch_reg << ", " << scratch_reg << ", sp" << '\n';
+			out << "  lw " << stmt.opr << ", " << "0(" << scratch_reg << ')' << '\n';
 		}
 	}
 	else
 	{
 		auto global_var = std::get<tigger::GlobalVar>(stmt.src);
-		out << "  lui " << stmt.opr << ", %hi(" << global_var << ')' << endl;
-		out << "  lw " << stmt.opr << ", %lo(" << global_var << ")(" << stmt.opr << ')' << endl;
+		out << "  lui " << stmt.opr << ", %hi(" << global_var << ')' << '\n';
+		out << "  lw " << stmt.opr << ", %lo(" << global_var << ")(" << stmt.opr << ')' << '\n';
 	}
 }
 
@@ -340,37 +375,40 @@ void RiscvPrinter::operator() (const tigger::LoadAddrStmt &stmt)
 	{
 		int offset = std::get<int>(stmt.src);
 		if(is_10bit(offset))
-			out << "  addi " << stmt.opr << ", sp, " << offset*4 << endl;
+			out << "  addi " << stmt.opr << ", sp, " << offset*4 << '\n';
 		else
 		{
-			out << "  li " << stmt.opr << ", " << offset*4 << endl;
-			out << "  add " << stmt.opr << ", " << stmt.opr << ", sp" << endl;
+			out << "  li " << stmt.opr << ", " << offset*4 << '\n';
+			out << "  add " << stmt.opr << ", " << stmt.opr << ", sp" << '\n';
 		}
 	}
 	else
 	{
 		auto global_var = std::get<tigger::GlobalVar>(stmt.src);
-		out << "  la " << stmt.opr << ", " << global_var << endl;
+		out << "  la " << stmt.opr << ", " << global_var << '\n';
 	}
 }
 
 
 } // namespace compiler::backend::riscv
 
+// The ostream printers are only used for debugging.
+
 std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::TiggerStatement &stmt)
 {
+	compiler::utils::OutputWriter writer;
 	int idx = compiler::backend::riscv::RiscvPrinter::riscv_xalloc;
 	if(out.iword(idx) == 1)
 	{
-		compiler::backend::riscv::RiscvPrinter riscv_printer(out);
+		compiler::backend::riscv::RiscvPrinter riscv_printer(writer);
 		std::visit(riscv_printer, stmt);
 	}
 	else
 	{
-		compiler::backend::tigger::TiggerPrinter tigger_printer(out);
+		compiler::backend::tigger::TiggerPrinter tigger_printer(writer);
 		std::visit(tigger_printer, stmt);
 	}
-	return out;
+	return out << writer.view();
 }
 
 std::ostream &riscv_mode(std::ostream &out)
@@ -385,4 +423,4 @@ std::ostream &tigger_mode(std::ostream &out)
 	static int idx = compiler::backend::riscv::RiscvPrinter::riscv_xalloc;
 	out.iword(idx) = 0;
 	return out;
-}
\ No newline at end of file
+}
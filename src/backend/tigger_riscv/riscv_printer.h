@@ -1,3 +1,6 @@
+#ifndef RISCV_PRINTER_H
+#define RISCV_PRINTER_H
+
 #include "tigger_printer.h"
 
 namespace compiler::backend::riscv
@@ -9,14 +12,15 @@ class RiscvPrinter
 	int _stack_size; // Stack size of the current function, in bytes.
 
   public:
-	std::ostream &out;
+	utils::OutputWriter &out;
 	static int riscv_xalloc;
 	tigger::Reg scratch_reg = tigger::CallerSavedReg(0); // t0
 
-	RiscvPrinter(std::ostream &_out): out(_out) {}
+	RiscvPrinter(utils::OutputWriter &_out): out(_out) {}
 
 	void operator() (const tigger::GlobalVarDeclStmt &stmt);
 	void operator() (const tigger::GlobalArrDeclStmt &stmt);
+	void operator() (const tigger::GlobalArrInitDeclStmt &stmt);
 	void operator() (const tigger::FuncHeaderStmt &stmt);
 	void operator() (const tigger::FuncEndStmt &stmt);
 	void operator() (const tigger::UnaryOpStmt &stmt);
@@ -34,31 +38,59 @@ class RiscvPrinter
 	void operator() (const tigger::LoadAddrStmt &stmt);
 };
 
+// Prints the statements in risc-v style.
+template<template<class...> class Container>
+void print_riscv(utils::OutputWriter &out, const Container<tigger::TiggerStatement> &stmts)
+{
+	RiscvPrinter printer(out);
+	for(auto iter = stmts.begin(); iter != stmts.end(); ++iter)
+		std::visit(printer, *iter);
+}
+
+// Prints the code in risc-v style, the functions in parallel if a thread pool
+// is given.
+inline void print_riscv(utils::OutputWriter &out, const tigger::TiggerCode &code,
+	utils::ThreadPool *pool)
+{
+	if(pool == nullptr)
+		print_riscv(out, code);
+	else
+		tigger::print_by_func<RiscvPrinter>(out, code, *pool);
+}
+
 } // namespace compiler::backend::riscv
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::TiggerStatement &stmt);
+namespace compiler::backend::tigger
+{
 
+// Prints the statements in tigger style.
 template<template<class...> class Container>
-std::ostream &operator << (std::ostream &out, const Container<compiler::backend::tigger::TiggerStatement> &stmts)
+void print_tigger(utils::OutputWriter &out, const Container<TiggerStatement> &stmts)
+{
+	TiggerPrinter printer(out);
+	for(auto iter = stmts.begin(); iter != stmts.end(); ++iter)
+		std::visit(printer, *iter);
+}
+
+// Prints the code in tigger style, the functions in parallel if a thread pool
+// is given.
+inline void print_tigger(utils::OutputWriter &out, const TiggerCode &code,
+	utils::ThreadPool *pool)
 {
-	int idx = compiler::backend::riscv::RiscvPrinter::riscv_xalloc;
-	if(out.iword(idx) == 1)
-	{
-		compiler::backend::riscv::RiscvPrinter riscv_printer(out);
-		for(auto iter = stmts.begin(); iter != stmts.end(); ++iter)
-			std::visit(riscv_printer, *iter);
-	}
+	if(pool == nullptr)
+		print_tigger(out, code);
 	else
-	{
-		compiler::backend::tigger::TiggerPrinter tigger_printer(out);
-		for(auto iter = stmts.begin(); iter != stmts.end(); ++iter)
-			std::visit(tigger_printer, *iter);
-	}
-	return out;
+		print_by_func<TiggerPrinter>(out, code, *pool);
 }
 
-// Switch output mode between tigger and riscv.
+} // namespace compiler::backend::tigger
+
+std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::TiggerStatement &stmt);
+
+// Switch output mode of the debugging ostream printer between tigger and riscv.
 // Usage: std::cout << riscv_mode << stmt;
 //     or std::cout << tigger_mode << stmt;
 std::ostream &riscv_mode(std::ostream &out);
-std::ostream &tigger_mode(std::ostream &out);
\ No newline at end of file
+std::ostream &tigger_mode(std::ostream &out);
+
+#endif
\ No newline at end of file
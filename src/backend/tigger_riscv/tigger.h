@@ -4,8 +4,11 @@
 #include <iostream>
 #include <string>
 #include <variant>
+#include <vector>
 #include "eeyore.h"
 #include "ast_node.h"
+#include "stmt_list.h"
+#include "symbol.h"
 
 namespace compiler::backend::tigger
 {
@@ -81,20 +84,30 @@ struct GlobalArrDeclStmt
 	GlobalArrDeclStmt(GlobalVar _var, int _size)
 	  : var(_var), size(_size) {}
 };
+// A global array with initial values, which are zero except the given words.
+struct GlobalArrInitDeclStmt
+{
+	GlobalVar var;
+	int size;
+	std::vector<std::pair<int, int>> initial_vals; // (offset, value), by offset.
+
+	GlobalArrInitDeclStmt(GlobalVar _var, int _size, std::vector<std::pair<int, int>> _initial_vals)
+	  : var(_var), size(_size), initial_vals(std::move(_initial_vals)) {}
+};
 struct FuncHeaderStmt
 {
-	std::string func_name;
+	utils::Symbol func_name;
 	int arg_cnt;
 	int stack_size;
 
-	FuncHeaderStmt(std::string _func_name, int _arg_cnt, int _stack_size=0)
+	FuncHeaderStmt(utils::Symbol _func_name, int _arg_cnt, int _stack_size=0)
 	  : func_name(_func_name), arg_cnt(_arg_cnt), stack_size(_stack_size) {}
 };
 struct FuncEndStmt
 {
-	std::string func_name;
+	utils::Symbol func_name;
 
-	FuncEndStmt(std::string _func_name): func_name(_func_name) {}
+	FuncEndStmt(utils::Symbol _func_name): func_name(_func_name) {}
 };
 struct UnaryOpStmt
 {
@@ -162,9 +175,9 @@ struct LabelStmt
 };
 struct FuncCallStmt
 {
-	std::string func_name;
+	utils::Symbol func_name;
 
-	FuncCallStmt(std::string _func_name): func_name(_func_name) {}
+	FuncCallStmt(utils::Symbol _func_name): func_name(_func_name) {}
 };
 struct ReturnStmt
 {
@@ -197,6 +210,7 @@ using TiggerStatement = std::variant
 <
 	GlobalVarDeclStmt,
 	GlobalArrDeclStmt,
+	GlobalArrInitDeclStmt,
 	FuncHeaderStmt,
 	FuncEndStmt,
 	UnaryOpStmt,
@@ -214,6 +228,8 @@ using TiggerStatement = std::variant
 	LoadAddrStmt
 >;
 
+using TiggerCode = utils::StmtList<TiggerStatement>;
+
 } // namespace compiler::backend::tigger
 
 namespace std
@@ -1,6 +1,9 @@
 #include "dbg.h"
+#include <algorithm>
+#include <unordered_map>
 #include "fstring.h"
 #include "visitor_helper.h"
+#include "time_report.h"
 #include "tigger_gen.h"
 
 using std::holds_alternative;
@@ -8,7 +11,7 @@ using std::holds_alternative;
 namespace compiler::backend::tigger
 {
 
-void TiggerGenerator::_TempRegManager::reset()
+void FuncTiggerGenerator::_TempRegManager::reset()
 {
 	while(!_allocated_temp_regs.empty())
 	{
@@ -17,10 +20,12 @@ void TiggerGenerator::_TempRegManager::reset()
 	}
 }
 
-Reg TiggerGenerator::_read_opr(eeyore::Operand opr)
+Reg FuncTiggerGenerator::_read_opr(eeyore::Operand opr)
 {
 	if(std::holds_alternative<int>(opr))
 	{
+		if(std::get<int>(opr) == 0)
+			return ZERO_REG;
 		Reg tmp_reg = _temp_regs.get_temp();
 		_tigger_code.emplace_back(MoveStmt(tmp_reg, std::get<int>(opr)));
 		return tmp_reg;
@@ -32,6 +37,9 @@ Reg TiggerGenerator::_read_opr(eeyore::Operand opr)
 		{
 			INTERNAL_ASSERT(_is_global_var(opr), utils::fstring("invalid position of opr ", opr));
 			auto var = std::get<eeyore::OrigVar>(opr);
+			// The value of an array is its address, e.g. in "t0 = T0 + 4".
+			if(var.size > (int)sizeof(int))
+				return _read_opr_addr(opr);
 			Reg tmp_reg = _temp_regs.get_temp();
 			_tigger_code.emplace_back(LoadStmt(tmp_reg, GlobalVar(var.id)));
 			return tmp_reg;
@@ -43,13 +51,17 @@ Reg TiggerGenerator::_read_opr(eeyore::Operand opr)
 		else // in stack
 		{
 			Reg tmp_reg = _temp_regs.get_temp();
-			_tigger_code.emplace_back(LoadStmt(tmp_reg, std::get<int>(actual_pos.value())));
+			int stack_pos = std::get<int>(actual_pos.value());
+			if(holds_alternative<eeyore::OrigVar>(opr) && std::get<eeyore::OrigVar>(opr).size > (int)sizeof(int))
+				_tigger_code.emplace_back(LoadAddrStmt(tmp_reg, stack_pos));
+			else
+				_tigger_code.emplace_back(LoadStmt(tmp_reg, stack_pos));
 			return tmp_reg;
 		}
 	}
 }
 
-Reg TiggerGenerator::_read_opr_addr(eeyore::Operand opr)
+Reg FuncTiggerGenerator::_read_opr_addr(eeyore::Operand opr)
 {
 	INTERNAL_ASSERT(std::holds_alternative<eeyore::OrigVar>(opr),
 		"temp variables does not have an address");
@@ -62,10 +74,11 @@ Reg TiggerGenerator::_read_opr_addr(eeyore::Operand opr)
 	return tmp_reg;
 }
 
-TiggerGenerator::TiggerGenerator(
-	const std::list<eeyore::EeyoreStatement> &code,
-	std::vector<eeyore::Operand> all_vars
-) : _eeyore_code(code)
+FuncTiggerGenerator::FuncTiggerGenerator(const eeyore::EeyoreCode &code,
+	const eeyore::EeyoreFunc &func, const std::vector<bool> &is_global_uid)
+  : _eeyore_code(code), _begin_stmt_id(func.begin_stmt_id), _end_stmt_id(func.end_stmt_id),
+	_static_init_begin_stmt_id(func.static_init_begin_stmt_id),
+	_static_init_end_stmt_id(func.static_init_end_stmt_id)
 {
 	auto _free_callee_saved_reg = ALL_CALLEE_SAVED_REG;
 
@@ -79,7 +92,7 @@ TiggerGenerator::TiggerGenerator(
 	);
 
 	_allocator.initialize(
-		code, std::move(all_vars),
+		code, func, is_global_uid,
 		std::move(_free_callee_saved_reg), std::move(_free_caller_saved_reg)
 	);
 	_temp_regs.set_temp(std::deque<CallerSavedReg>(
@@ -89,16 +102,19 @@ TiggerGenerator::TiggerGenerator(
 	DBG(std::cout << "end tigger gen construction" << std::endl);
 }
 
-const std::list<TiggerStatement> &TiggerGenerator::generate_tigger()
+TiggerCode &FuncTiggerGenerator::generate_tigger()
 {
 	DBG(std::cout << std::endl << "start generatning tigger" << std::endl);
-	_is_global = true;
-	_func_id = 0;
 	_param_id = 0;
-	_eeyore_stmt_id = 0;
+	_tigger_code.clear();
+	_tigger_code.reserve((_end_stmt_id - _begin_stmt_id) * 2);
 
-	for(const auto &stmt : _eeyore_code)
+	// The linear scan advances with the emission, one statement at a time,
+	// so they are timed together.
+	utils::TimeScope time_scope("linear scan and emission");
+	for(_eeyore_stmt_id = _begin_stmt_id; _eeyore_stmt_id < _end_stmt_id; _eeyore_stmt_id++)
 	{
+		const auto &stmt = _eeyore_code[_eeyore_stmt_id];
 		auto alloc_changes = _allocator.allocate_for(stmt, _eeyore_stmt_id);
 		for(const auto &change : alloc_changes)
 		{
@@ -108,38 +124,27 @@ const std::list<TiggerStatement> &TiggerGenerator::generate_tigger()
 				_tigger_code.emplace_back(StoreStmt(std::get<int>(change.new_pos), change.prev_pos));
 		}
 
+		// The initial values of the global variables are static.
+		if(_eeyore_stmt_id >= _static_init_begin_stmt_id && _eeyore_stmt_id < _static_init_end_stmt_id)
+			continue;
 		std::visit(*this, stmt);
 		_temp_regs.reset();
-		_eeyore_stmt_id++;
 	}
 	DBG(std::cout << "end generating tigger" << std::endl);
 	return _tigger_code;
 }
 
-// Only global declaration is translated.
-// var T0      -->   v0 = 0  // The initial value is always zero.
-// var 40 T0   -->   v1 = malloc 40
-void TiggerGenerator::operator() (const eeyore::DeclStmt &stmt)
+// Local declaration statements corresponds to no tigger statements, the
+// global ones are translated by TiggerGenerator.
+void FuncTiggerGenerator::operator() ([[maybe_unused]] const eeyore::DeclStmt &stmt)
 {
 	DBG(std::cout << stmt);
-	if(_is_global)
-	{
-		INTERNAL_ASSERT(holds_alternative<eeyore::OrigVar>(stmt.var),
-			"Error global definition");
-		auto var = std::get<eeyore::OrigVar>(stmt.var);
-		if(var.size == sizeof(int))
-			_tigger_code.emplace_back(GlobalVarDeclStmt(var.id));
-		else
-			_tigger_code.emplace_back(GlobalArrDeclStmt(var.id, var.size));
-	}
-	// Local declaration statements corresponds to no tigger statements.
 }
 
 // f_func [2]   -->   f_func [2] [stack_size]
-void TiggerGenerator::operator() (const eeyore::FuncDefStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::FuncDefStmt &stmt)
 {
 	DBG(std::cout << stmt);
-	_is_global = false;
 	_tigger_code.emplace_back(FuncHeaderStmt(stmt.func_name, stmt.arg_cnt));
 	_func_start = std::prev(_tigger_code.end());
 	_return_stmt_pos.clear();
@@ -148,14 +153,14 @@ void TiggerGenerator::operator() (const eeyore::FuncDefStmt &stmt)
 	// Stores parameter in callee saved registers.
 	for(int i = 0; i < stmt.arg_cnt; i++)
 	{
-		auto arg_reg = _allocator.reg_of(eeyore::Param(i));
+		auto arg_reg = _allocator.reg_of_param(i);
 		if(arg_reg.has_value() && !holds_alternative<ArgReg>(arg_reg.value()))
 			_tigger_code.emplace_back(MoveStmt(arg_reg.value(), ArgReg(i)));
 	}
 }
 
 // Same as eeyore.
-void TiggerGenerator::operator() (const eeyore::EndFuncDefStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::EndFuncDefStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	int stack_size = _allocator.func_stack_size();
@@ -172,7 +177,6 @@ void TiggerGenerator::operator() (const eeyore::EndFuncDefStmt &stmt)
 				LoadStmt(_allocator.callee_saved_reg(i), stack_size - 1 - i));
 
 	_tigger_code.emplace_back(FuncEndStmt(stmt.func_name));
-	_is_global = true;
 }
 
 // If t0 is an immediate number:
@@ -187,7 +191,7 @@ void TiggerGenerator::operator() (const eeyore::EndFuncDefStmt &stmt)
 //            -->   load loc(t0) aX
 // or if t0 is an array in the stack:
 //            -->   loadaddr loc(t0) aX
-void TiggerGenerator::operator() (const eeyore::ParamStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::ParamStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	if(holds_alternative<int>(stmt.param))
@@ -239,7 +243,7 @@ void TiggerGenerator::operator() (const eeyore::ParamStmt &stmt)
 // or if T0 is in stack:
 //                    -->   call f_func
 //                          store a0 loc(T0)
-void TiggerGenerator::operator() (const eeyore::FuncCallStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::FuncCallStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	_param_id = 0;
@@ -287,7 +291,7 @@ void TiggerGenerator::operator() (const eeyore::FuncCallStmt &stmt)
 // or if t0 is in stack:
 //             -->   load loc(T0) a0
 //                   return
-void TiggerGenerator::operator() (const eeyore::RetStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::RetStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	if(stmt.retval.has_value())
@@ -324,7 +328,7 @@ void TiggerGenerator::operator() (const eeyore::RetStmt &stmt)
 }
 
 // Same as eeyore.
-void TiggerGenerator::operator() (const eeyore::GotoStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::GotoStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	_tigger_code.emplace_back(GotoStmt(stmt.goto_label));
@@ -333,7 +337,7 @@ void TiggerGenerator::operator() (const eeyore::GotoStmt &stmt)
 // if T1 BinOp T2 goto l1   -->   (load T1 if T1 is not in a register)
 //                                (load T2 if T2 is not in a register)
 //                                if reg(T1) BinOp reg(T2) goto l1
-void TiggerGenerator::operator() (const eeyore::CondGotoStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::CondGotoStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	Reg reg1 = _read_opr(stmt.opr1);
@@ -354,7 +358,7 @@ void TiggerGenerator::operator() (const eeyore::CondGotoStmt &stmt)
 //                       tmp_reg = UniOp reg(T1)
 //                       store tmp_reg loc(T0)
 // Maximum temporary register used: 2.
-void TiggerGenerator::operator() (const eeyore::UnaryOpStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::UnaryOpStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	Reg reg1 = _read_opr(stmt.opr1);
@@ -411,7 +415,7 @@ void TiggerGenerator::operator() (const eeyore::UnaryOpStmt &stmt)
 //
 // Note: T2 allocation part can be optimized if T2 is an immediate number.
 // Maximum temporary register used: 2
-void TiggerGenerator::operator() (const eeyore::BinaryOpStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::BinaryOpStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	Reg reg1 = _read_opr(stmt.opr1);
@@ -522,7 +526,7 @@ void TiggerGenerator::operator() (const eeyore::BinaryOpStmt &stmt)
 //           -->   (load T1 if T1 is not in a register)
 //                 store tmp_reg loc(T1)
 // or T1 allocation can be optimized if T1 is an immediate number.
-void TiggerGenerator::operator() (const eeyore::MoveStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::MoveStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	if(_is_global_var(stmt.opr))
@@ -597,7 +601,8 @@ void TiggerGenerator::operator() (const eeyore::MoveStmt &stmt)
                or -->   load loc(T1)+T2 tmp_reg1
                        store tmp_reg1 loc(T0)
 	
-   For pointer arrays, if T2 is not an immediate:
+   For pointer arrays (the parameters, or temp variables holding an address,
+   which are loaded first if they are in stack), if T2 is not an immediate:
     T0 = p0[T2]   -->   (load T2 if T2 is not in a register)
                         tmp_reg = reg(p0) + reg(T2)
                         reg(T0) = tmp_reg[0]
@@ -612,7 +617,7 @@ void TiggerGenerator::operator() (const eeyore::MoveStmt &stmt)
    
    Maximum temporary register used: 2
  */
-void TiggerGenerator::operator() (const eeyore::ReadArrStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::ReadArrStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	// value read but never used.
@@ -659,7 +664,7 @@ void TiggerGenerator::operator() (const eeyore::ReadArrStmt &stmt)
 		}
 
 	}
-	else if(holds_alternative<int>(arr_pos.value())) // local array
+	else if(holds_alternative<int>(arr_pos.value()) && _is_local_arr(stmt.arr_opr)) // local array
 	{
 		int arr_stack_pos = std::get<int>(arr_pos.value());
 
@@ -730,12 +735,14 @@ void TiggerGenerator::operator() (const eeyore::ReadArrStmt &stmt)
 			}
 		}
 	}
-	else // pointer array
+	else // pointer array, loaded if it is in stack
 	{
-		Reg reg_arr = std::get<Reg>(arr_pos.value());
+		Reg reg_arr = _read_opr(stmt.arr_opr);
 		if(!holds_alternative<int>(stmt.idx_opr))
 		{
 			Reg reg_idx = _read_opr(stmt.idx_opr);
+			_temp_regs.try_return_temp(reg_idx);
+			_temp_regs.try_return_temp(reg_arr);
 			auto tmp_reg = _temp_regs.get_temp();
 			_tigger_code.emplace_back(BinaryOpStmt(
 				tmp_reg, reg_arr, frontend::BinaryOpNode::ADD, reg_idx
@@ -769,6 +776,7 @@ void TiggerGenerator::operator() (const eeyore::ReadArrStmt &stmt)
 		else
 		{
 			int idx_val = std::get<int>(stmt.idx_opr);
+			_temp_regs.try_return_temp(reg_arr);
 			if(_is_global_var(stmt.opr))
 			{
 				auto var = std::get<eeyore::OrigVar>(stmt.opr);
@@ -815,10 +823,11 @@ void TiggerGenerator::operator() (const eeyore::ReadArrStmt &stmt)
                  -->   (load T0 if T0 is not in a register)
                  -->   store reg(T0) loc(T1)+T2
    
-   For pointer arrays, almost the same as global arrays.
+   For pointer arrays, almost the same as global arrays, with the pointer
+   loaded first if it is in stack.
    Maximum temporary register used: 2
 */
-void TiggerGenerator::operator() (const eeyore::WriteArrStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::WriteArrStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	auto arr_pos = _allocator.actual_pos_of(stmt.arr_opr);
@@ -846,7 +855,7 @@ void TiggerGenerator::operator() (const eeyore::WriteArrStmt &stmt)
 			_tigger_code.emplace_back(WriteArrStmt(tmp_reg, reg_idx_val, reg_opr));
 		}
 	}
-	else if(holds_alternative<int>(arr_pos.value())) // local array
+	else if(holds_alternative<int>(arr_pos.value()) && _is_local_arr(stmt.arr_opr)) // local array
 	{
 		int arr_stack_pos = std::get<int>(arr_pos.value());
 
@@ -871,18 +880,19 @@ void TiggerGenerator::operator() (const eeyore::WriteArrStmt &stmt)
 			_tigger_code.emplace_back(StoreStmt(ele_pos, reg_opr));
 		}
 	}
-	else
+	else // pointer array, loaded if it is in stack
 	{
-		Reg reg_arr = std::get<Reg>(arr_pos.value());
+		Reg reg_arr = _read_opr(stmt.arr_opr);
 
 		if(!holds_alternative<int>(stmt.idx_opr))
 		{
-			auto tmp_reg = _temp_regs.get_temp();
 			Reg reg_idx = _read_opr(stmt.idx_opr);
+			_temp_regs.try_return_temp(reg_idx);
+			_temp_regs.try_return_temp(reg_arr);
+			auto tmp_reg = _temp_regs.get_temp();
 			_tigger_code.emplace_back(BinaryOpStmt(
 				tmp_reg, reg_arr, frontend::BinaryOpNode::ADD, reg_idx
 			));
-			_temp_regs.try_return_temp(reg_idx);
 
 			Reg reg_opr = _read_opr(stmt.opr);
 			_tigger_code.emplace_back(WriteArrStmt(tmp_reg, 0, reg_opr));
@@ -897,11 +907,92 @@ void TiggerGenerator::operator() (const eeyore::WriteArrStmt &stmt)
 }
 
 // Same as eeyore.
-void TiggerGenerator::operator() (const eeyore::LabelStmt &stmt)
+void FuncTiggerGenerator::operator() (const eeyore::LabelStmt &stmt)
 {
 	DBG(std::cout << stmt);
 	_tigger_code.emplace_back(LabelStmt(stmt.label));
 }
 
+TiggerGenerator::TiggerGenerator(const eeyore::EeyoreCode &code,
+	const std::vector<eeyore::EeyoreFunc> &funcs, utils::ThreadPool *pool)
+  : _eeyore_code(code), _eeyore_funcs(funcs), _pool(pool) {}
+
+// The global variables are all declared before the functions, with the
+// constants stored to them at the beginning of f_main as initial values:
+// var T0      -->   v0 = 0
+// var 40 T1   -->   v1 = malloc 40
+// var 40 T2   -->   v2 = malloc 40 {0: 1 2, 12: 5}  // With T2[0] = 1 ...
+const TiggerCode &TiggerGenerator::generate_tigger()
+{
+	INTERNAL_ASSERT(_eeyore_code.is_compact(), "generating tigger from non-compact code");
+	_is_global_uid.clear();
+	_tigger_code.clear();
+	_tigger_code.reserve(_eeyore_code.size() * 2);
+
+	// The nonzero initial values of the global variables, by uid.
+	std::unordered_map<int, std::vector<std::pair<int, int>>> initial_vals;
+	for(const auto &func : _eeyore_funcs)
+		for(int stmt_id = func.static_init_begin_stmt_id; stmt_id < func.static_init_end_stmt_id; stmt_id++)
+		{
+			const auto &stmt = _eeyore_code[stmt_id];
+			if(holds_alternative<eeyore::MoveStmt>(stmt))
+			{
+				const auto &move = std::get<eeyore::MoveStmt>(stmt);
+				if(std::get<int>(move.opr1) != 0)
+					initial_vals[eeyore::uid_of(move.opr)].emplace_back(0, std::get<int>(move.opr1));
+			}
+			else
+			{
+				const auto &write = std::get<eeyore::WriteArrStmt>(stmt);
+				if(std::get<int>(write.opr) != 0)
+					initial_vals[eeyore::uid_of(write.arr_opr)].emplace_back(
+						std::get<int>(write.idx_opr), std::get<int>(write.opr));
+			}
+		}
+
+	int global_end_stmt_id = _eeyore_funcs.empty()? _eeyore_code.size() : _eeyore_funcs[0].begin_stmt_id;
+	for(int stmt_id = 0; stmt_id < global_end_stmt_id; stmt_id++)
+	{
+		const auto &stmt = std::get<eeyore::DeclStmt>(_eeyore_code[stmt_id]);
+		INTERNAL_ASSERT(holds_alternative<eeyore::OrigVar>(stmt.var),
+			"Error global definition");
+		auto var = std::get<eeyore::OrigVar>(stmt.var);
+		if(var.uid >= (int)_is_global_uid.size())
+			_is_global_uid.resize(var.uid + 1, false);
+		_is_global_uid[var.uid] = true;
+
+		auto find_res = initial_vals.find(var.uid);
+		if(var.size == sizeof(int))
+		{
+			int initial_val = find_res == initial_vals.end()? 0 : find_res->second.back().second;
+			_tigger_code.emplace_back(GlobalVarDeclStmt(var.id, initial_val));
+		}
+		else if(find_res == initial_vals.end())
+			_tigger_code.emplace_back(GlobalArrDeclStmt(var.id, var.size));
+		else
+		{
+			auto &vals = find_res->second;
+			if(!std::is_sorted(vals.begin(), vals.end()))
+				std::sort(vals.begin(), vals.end());
+			_tigger_code.emplace_back(GlobalArrInitDeclStmt(var.id, var.size, std::move(vals)));
+		}
+	}
+
+	std::vector<TiggerCode> func_codes(_eeyore_funcs.size());
+	auto generate_func = [&, this](int i)
+	{
+		FuncTiggerGenerator generator(_eeyore_code, _eeyore_funcs[i], _is_global_uid);
+		func_codes[i] = std::move(generator.generate_tigger());
+	};
+	if(_pool != nullptr)
+		_pool->parallel_for(_eeyore_funcs.size(), generate_func);
+	else
+		for(int i = 0; i < (int)_eeyore_funcs.size(); i++)
+			generate_func(i);
+
+	for(auto &func_code : func_codes)
+		_tigger_code.splice(_tigger_code.end(), func_code);
+	return _tigger_code;
+}
 
 } // namespace compiler::backend::tigger
\ No newline at end of file
@@ -6,21 +6,28 @@
 #include "reg_alloc.h"
 #include "cfg.h"
 #include "live_interval.h"
+#include "thread_pool.h"
 
 namespace compiler::backend::tigger
 {
 
-class TiggerGenerator
+// Generates the tigger code of a function of a compact eeyore code, with the
+// basic blocks found by EeyoreGenerator. The generators of
+// different functions share nothing but the (read-only) eeyore code and global
+// variable table, so they can run on different threads.
+class FuncTiggerGenerator
 {
-	const std::list<eeyore::EeyoreStatement> &_eeyore_code;
+	const eeyore::EeyoreCode &_eeyore_code;
+	int _begin_stmt_id;
+	int _end_stmt_id;
+	int _static_init_begin_stmt_id;
+	int _static_init_end_stmt_id;
 	RegAllocator _allocator;
-	std::list<TiggerStatement> _tigger_code;
-	std::list<TiggerStatement>::iterator _func_start;
-	std::vector<std::list<TiggerStatement>::iterator> _return_stmt_pos;
+	TiggerCode _tigger_code;
+	TiggerCode::iterator _func_start;
+	std::vector<TiggerCode::iterator> _return_stmt_pos;
 
-	bool _is_global;
 	int _param_id;
-	int _func_id;
 	int _eeyore_stmt_id;
 
 	class _TempRegManager
@@ -82,15 +89,21 @@ class TiggerGenerator
 
 	inline bool _is_global_var(eeyore::Operand opr) const
 		{ return _allocator.is_global_var(opr); }
+	// Whether the operand is an array in the stack, not a pointer to an array
+	// (which may also be in the stack, if spilled).
+	inline bool _is_local_arr(eeyore::Operand opr) const
+	{
+		return std::holds_alternative<eeyore::OrigVar>(opr)
+			&& std::get<eeyore::OrigVar>(opr).size > (int)sizeof(int) && !_is_global_var(opr);
+	}
 	bool _is_useless_stmt(const eeyore::EeyoreStatement &stmt) const;
 	Reg _read_opr(eeyore::Operand opr);
 	Reg _read_opr_addr(eeyore::Operand opr);
 	
   public:
-	TiggerGenerator(
-		const std::list<eeyore::EeyoreStatement> &eeyore_code,
-		std::vector<eeyore::Operand> all_vars);
-	const std::list<TiggerStatement> &generate_tigger();
+	FuncTiggerGenerator(const eeyore::EeyoreCode &eeyore_code, const eeyore::EeyoreFunc &func,
+		const std::vector<bool> &is_global_uid);
+	TiggerCode &generate_tigger();
 
 	void operator() (const eeyore::DeclStmt &stmt);
 	void operator() (const eeyore::FuncDefStmt &stmt);
@@ -108,6 +121,24 @@ class TiggerGenerator
 	void operator() (const eeyore::LabelStmt &stmt);
 };
 
+// Generates the tigger code of a program. The global variables are declared
+// first, then each function is generated by a FuncTiggerGenerator, in
+// parallel if a thread pool is given. The code of the functions are appended
+// in order, so the result does not depend on the thread count.
+class TiggerGenerator
+{
+	const eeyore::EeyoreCode &_eeyore_code;
+	const std::vector<eeyore::EeyoreFunc> &_eeyore_funcs;
+	utils::ThreadPool *_pool;
+	std::vector<bool> _is_global_uid;
+	TiggerCode _tigger_code;
+
+  public:
+	TiggerGenerator(const eeyore::EeyoreCode &eeyore_code,
+		const std::vector<eeyore::EeyoreFunc> &eeyore_funcs, utils::ThreadPool *pool=nullptr);
+	const TiggerCode &generate_tigger();
+};
+
 } // namespace compiler::backend::tigger
 
 #endif
\ No newline at end of file
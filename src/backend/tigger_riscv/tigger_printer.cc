@@ -2,8 +2,6 @@
 #include "tigger_printer.h"
 #include "ast_node_printer.h"
 
-using std::endl;
-
 namespace compiler::backend::tigger
 {
 
@@ -30,110 +28,130 @@ void RegPrinter::operator() (const ArgReg &reg)
 
 void TiggerPrinter::operator() (const GlobalVarDeclStmt &stmt)
 {
-	out << stmt.var << " = " << stmt.initial_val << endl;
+	out << stmt.var << " = " << stmt.initial_val << '\n';
 }
 
 void TiggerPrinter::operator() (const GlobalArrDeclStmt &stmt)
 {
-	out << stmt.var << " = malloc " << stmt.size << endl;
+	out << stmt.var << " = malloc " << stmt.size << '\n';
+}
+
+// The initial values are extended syntax, as runs of words with their offsets:
+// v0 = malloc 40 {0: 1 2 3, 20: 5}
+void TiggerPrinter::operator() (const GlobalArrInitDeclStmt &stmt)
+{
+	out << stmt.var << " = malloc " << stmt.size << " {";
+	int next_offset = -1;
+	for(auto [offset, val] : stmt.initial_vals)
+	{
+		if(offset != next_offset)
+		{
+			if(next_offset != -1)
+				out << ", ";
+			out << offset << ':';
+		}
+		out << ' ' << val;
+		next_offset = offset + 4;
+	}
+	out << '}' << '\n';
 }
 
 void TiggerPrinter::operator() (const FuncHeaderStmt &stmt)
 {
 	out << stmt.func_name << " [" << stmt.arg_cnt << "] ["
-		<< stmt.stack_size << ']' << endl;
+		<< stmt.stack_size << ']' << '\n';
 }
 
 void TiggerPrinter::operator() (const FuncEndStmt &stmt)
 {
-	out << "end " << stmt.func_name << endl;
+	out << "end " << stmt.func_name << '\n';
 }
 
 void TiggerPrinter::operator() (const UnaryOpStmt &stmt)
 {
-	out << "  " << stmt.opr << " = " << stmt.op_type << stmt.opr1 << endl;
+	out << "  " << stmt.opr << " = " << stmt.op_type << stmt.opr1 << '\n';
 }
 
 void TiggerPrinter::operator() (const BinaryOpStmt &stmt)
 {
 	out << "  " << stmt.opr << " = " << stmt.opr1 << ' ' << stmt.op_type
-		<< ' ' << stmt.opr2 << endl;
+		<< ' ' << stmt.opr2 << '\n';
 }
 
 void TiggerPrinter::operator() (const MoveStmt &stmt)
 {
-	out << "  " << stmt.opr << " = " << stmt.opr1 << endl;
+	out << "  " << stmt.opr << " = " << stmt.opr1 << '\n';
 }
 
 void TiggerPrinter::operator() (const ReadArrStmt &stmt)
 {
-	out << "  " << stmt.opr << " = " << stmt.opr1 << '[' << stmt.idx << ']' << endl;
+	out << "  " << stmt.opr << " = " << stmt.opr1 << '[' << stmt.idx << ']' << '\n';
 }
 
 void TiggerPrinter::operator() (const WriteArrStmt &stmt)
 {
-	out << "  " << stmt.opr1 << '[' << stmt.idx << "] = " << stmt.opr << endl;
+	out << "  " << stmt.opr1 << '[' << stmt.idx << "] = " << stmt.opr << '\n';
 }
 
 void TiggerPrinter::operator() (const CondGotoStmt &stmt)
 {
 	out << "  if " << stmt.opr1 << ' ' << stmt.op_type << ' ' << stmt.opr2
-		<< " goto " << stmt.goto_label << endl;
+		<< " goto " << stmt.goto_label << '\n';
 }
 
 void TiggerPrinter::operator() (const GotoStmt &stmt)
 {
-	out << "  goto " << stmt.goto_label << endl;
+	out << "  goto " << stmt.goto_label << '\n';
 }
 
 void TiggerPrinter::operator() (const LabelStmt &stmt)
 {
-	out << stmt.label << ':' << endl;
+	out << stmt.label << ':' << '\n';
 }
 
 void TiggerPrinter::operator() (const FuncCallStmt &stmt)
 {
-	out << "  call " << stmt.func_name << endl;
+	out << "  call " << stmt.func_name << '\n';
 }
 
 void TiggerPrinter::operator() (const ReturnStmt &stmt)
 {
-	out << "  return" << endl;
+	out << "  return" << '\n';
 }
 
 void TiggerPrinter::operator() (const StoreStmt &stmt)
 {
-	out << "  store " << stmt.opr << ' ' << stmt.stack_offset << endl;
+	out << "  store " << stmt.opr << ' ' << stmt.stack_offset << '\n';
 }
 
 void TiggerPrinter::operator() (const LoadStmt &stmt)
 {
-	out << "  load " << stmt.src << ' ' << stmt.opr << endl;
+	out << "  load " << stmt.src << ' ' << stmt.opr << '\n';
 }
 
 void TiggerPrinter::operator() (const LoadAddrStmt &stmt)
 {
-	out << "  loadaddr " << stmt.src << ' ' << stmt.opr << endl;
+	out << "  loadaddr " << stmt.src << ' ' << stmt.opr << '\n';
 }
 
 } // namespace compiler::backend::tigger
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::Label &label)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out, const compiler::backend::tigger::Label &label)
 {
 	return out << 'l' << label.id;
 }
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::Reg &reg)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out, const compiler::backend::tigger::Reg &reg)
 {
 	compiler::backend::tigger::RegPrinter printer{out};
 	std::visit(printer, reg);
 	return out;
 }
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::RegOrNum &reg_or_num)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out, const compiler::backend::tigger::RegOrNum &reg_or_num)
 {
 	// Decompose RegOrNum to a Reg or an int. Both of them are printable
-	// using std::ostream.
+	// using OutputWriter.
 	compiler::utils::LambdaVisitor printer = {
 		[&out](const auto &reg_or_num) { out << reg_or_num; }
 	};
@@ -141,16 +159,25 @@ std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::R
 	return out;
 }
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::GlobalVar &global_var)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out, const compiler::backend::tigger::GlobalVar &global_var)
 {
 	return out << 'v' << global_var.id;
 }
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::GlobalVarOrNum &global_var_or_num)
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out, const compiler::backend::tigger::GlobalVarOrNum &global_var_or_num)
 {
 	compiler::utils::LambdaVisitor printer = {
 		[&out](const auto &global_var_or_num) { out << global_var_or_num; }
 	};
 	std::visit(printer, global_var_or_num);
 	return out;
-}
\ No newline at end of file
+}
+
+// The ostream printers are only used for debugging.
+
+std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::Reg &reg)
+{
+	compiler::utils::OutputWriter writer;
+	writer << reg;
+	return out << writer.view();
+}
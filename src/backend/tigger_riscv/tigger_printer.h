@@ -2,14 +2,17 @@
 #define TIGGER_PRINTER_H
 
 #include <iostream>
+#include <vector>
 #include "tigger.h"
+#include "output_writer.h"
+#include "thread_pool.h"
 
 namespace compiler::backend::tigger
 {
 
 struct RegPrinter
 {
-	std::ostream &out;
+	utils::OutputWriter &out;
 
 	void operator() (const ZeroReg &reg);
 	void operator() (const CalleeSavedReg &reg);
@@ -20,12 +23,13 @@ struct RegPrinter
 class TiggerPrinter
 {
   public:
-	std::ostream &out;
+	utils::OutputWriter &out;
 
-	TiggerPrinter(std::ostream &_out): out(_out) {}
+	TiggerPrinter(utils::OutputWriter &_out): out(_out) {}
 
 	void operator() (const GlobalVarDeclStmt &stmt);
 	void operator() (const GlobalArrDeclStmt &stmt);
+	void operator() (const GlobalArrInitDeclStmt &stmt);
 	void operator() (const FuncHeaderStmt &stmt);
 	void operator() (const FuncEndStmt &stmt);
 	void operator() (const UnaryOpStmt &stmt);
@@ -43,13 +47,46 @@ class TiggerPrinter
 	void operator() (const LoadAddrStmt &stmt);
 };
 
+// Prints the code with a Printer per function on the pool. Each function is
+// printed into its own in-memory buffer, and the buffers are written to out
+// in order, so the output does not depend on the thread count.
+template<class Printer>
+void print_by_func(utils::OutputWriter &out, const TiggerCode &code, utils::ThreadPool &pool)
+{
+	std::vector<TiggerCode::const_iterator> func_begins;
+	for(auto iter = code.begin(); iter != code.end(); ++iter)
+		if(std::holds_alternative<FuncHeaderStmt>(*iter))
+			func_begins.push_back(iter);
+	func_begins.push_back(code.end());
+
+	// The global declarations are before the first function.
+	Printer printer(out);
+	for(auto iter = code.begin(); iter != func_begins.front(); ++iter)
+		std::visit(printer, *iter);
+
+	std::vector<utils::OutputWriter> bufs(func_begins.size() - 1);
+	pool.parallel_for(bufs.size(), [&](int i) {
+		Printer func_printer(bufs[i]);
+		for(auto iter = func_begins[i]; iter != func_begins[i + 1]; ++iter)
+			std::visit(func_printer, *iter);
+	});
+	for(const auto &buf : bufs)
+		out << buf.view();
+}
+
 } // namespace compiler::backend::tigger
 
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::Label &label);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::tigger::Label &label);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::tigger::Reg &reg);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::tigger::RegOrNum &reg_or_num);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::tigger::GlobalVar &global_var);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::backend::tigger::GlobalVarOrNum &global_var_or_num);
 std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::Reg &reg);
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::RegOrNum &reg_or_num);
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::GlobalVar &global_var);
-std::ostream &operator << (std::ostream &out, const compiler::backend::tigger::GlobalVarOrNum &global_var_or_num);
 
 // The printer methods are implemented in riscv_printer.cc, since a tigger
 // statement can be printed either in tigger style or risc-v style.
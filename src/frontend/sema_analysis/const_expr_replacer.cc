@@ -7,7 +7,6 @@
 
 using std::visit;
 using std::holds_alternative;
-using std::make_unique;
 using compiler::utils::fstring;
 
 namespace compiler::frontend
@@ -18,6 +17,30 @@ void SemanticChecker::ConstExprReplacer::replace_expr(AstPtr &node)
 	node = visit(*this, node);
 }
 
+bool SemanticChecker::ConstExprReplacer::is_const_expr(const AstPtr &node) const
+{
+	if(holds_alternative<ConstIntNodePtr>(node))
+		return true;
+	if(holds_alternative<IdNodePtr>(node))
+	{
+		auto find_res = table.find(std::get<IdNodePtr>(node)->name());
+		return find_res.has_value() && is_const(find_res.value().type)
+			&& find_res.value().initial_val.has_value();
+	}
+	if(holds_alternative<UnaryOpNodePtr>(node))
+	{
+		const auto &unary_node = std::get<UnaryOpNodePtr>(node);
+		return unary_node->op() != UnaryOpNode::POINTER && is_const_expr(unary_node->operand());
+	}
+	if(holds_alternative<BinaryOpNodePtr>(node))
+	{
+		const auto &binary_node = std::get<BinaryOpNodePtr>(node);
+		return binary_node->op() != BinaryOpNode::ASSIGN && binary_node->op() != BinaryOpNode::ACCESS
+			&& is_const_expr(binary_node->operand1()) && is_const_expr(binary_node->operand2());
+	}
+	return false;
+}
+
 AstPtr SemanticChecker::ConstExprReplacer::operator() (ConstIntNodePtr &node)
 {
 	DBG(std::cout << "literal " << node->val() << std::endl);
@@ -37,7 +60,7 @@ AstPtr SemanticChecker::ConstExprReplacer::operator() (IdNodePtr &node)
 	if(!init_val.has_value())
 		INTERNAL_ERROR(fstring("non-initialized const variable ", node->name()));
 	DBG(std::cout << "id " << node->name() << " = " << init_val.value() << std::endl);
-	return make_unique<ConstIntNode>(init_val.value());
+	return make_node<ConstIntNode>(init_val.value());
 }
 AstPtr SemanticChecker::ConstExprReplacer::operator() (InitializerNodePtr &node)
 {
@@ -63,7 +86,7 @@ AstPtr SemanticChecker::ConstExprReplacer::operator() (UnaryOpNodePtr &node)
 			throw SemanticError(node->location().begin, "pointer types should not occur in constexpr");
 	}
 	DBG(std::cout << node->op() << val << '=' << target_val << std::endl);
-	return make_unique<ConstIntNode>(target_val);
+	return make_node<ConstIntNode>(target_val);
 }
 AstPtr SemanticChecker::ConstExprReplacer::operator() (BinaryOpNodePtr &node)
 {
@@ -87,8 +110,12 @@ AstPtr SemanticChecker::ConstExprReplacer::operator() (BinaryOpNodePtr &node)
 		case BinaryOpNode::MUL:
 			target_val = val1 * val2; break;
 		case BinaryOpNode::DIV:
+			if(val2 == 0)
+				throw SemanticError(node->location().begin, "division by zero in constexpr");
 			target_val = val1 / val2; break;
 		case BinaryOpNode::MOD:
+			if(val2 == 0)
+				throw SemanticError(node->location().begin, "division by zero in constexpr");
 			target_val = val1 % val2; break;
 		case BinaryOpNode::OR:
 			target_val = val1 || val2; break;
@@ -112,7 +139,7 @@ AstPtr SemanticChecker::ConstExprReplacer::operator() (BinaryOpNodePtr &node)
 			throw SemanticError(node->location().begin, "access statements should not occur in constexpr");
 	}
 	DBG(std::cout << val1 << node->op() << val2 << '=' << target_val << std::endl);
-	return make_unique<ConstIntNode>(target_val);
+	return make_node<ConstIntNode>(target_val);
 }
 
 template<class ErrorType>
@@ -58,9 +58,9 @@ TypePtr SemanticChecker::DeclTypeDeducer::deduce_type(AstPtr &decl_expr,
 		DBG(std::cout << "base type: " << base_type << std::endl);
 		if(_is_ptr)
 		{
-			IdNodePtr simplified_id = std::make_unique<IdNode>(*_id_node_ptr);
+			IdNodePtr simplified_id = make_node<IdNode>(*_id_node_ptr);
 			decl_expr = std::move(simplified_id);
-			return std::make_shared<PointerType>(base_type);
+			return make_pointer(base_type);
 		}
 		else
 			return base_type;
@@ -69,12 +69,12 @@ TypePtr SemanticChecker::DeclTypeDeducer::deduce_type(AstPtr &decl_expr,
 	{
 		DBG(std::cout << "array type of " << base_type << std::endl);
 		// do simplification
-		IdNodePtr simplified_id = std::make_unique<IdNode>(*_id_node_ptr);
+		IdNodePtr simplified_id = make_node<IdNode>(*_id_node_ptr);
 		decl_expr = std::move(simplified_id);
 
-		TypePtr tp = std::make_shared<ArrayType>(base_type, _dim_size);
+		TypePtr tp = make_array(base_type, _dim_size);
 		if(_is_ptr)
-			tp = std::make_shared<PointerType>(tp);
+			tp = make_pointer(tp);
 		return tp;
 	}
 }
@@ -9,15 +9,30 @@ using compiler::utils::fstring;
 namespace compiler::frontend
 {
 
+bool SemanticChecker::InitializerTypeChecker::_match_elements(const ArrayTypePtr &arr_type)
+{
+	int base_pos = _pos;
+	int element_cnt = arr_type->element_size() / sizeof(int);
+	for(int i = 0; i < arr_type->len(); i++)
+	{
+		_pos = base_pos + i * element_cnt;
+		if(std::visit(*this, arr_type->element_type())) // exhaused, finish the check
+			return true;
+	}
+	return false;
+}
+
 bool SemanticChecker::InitializerTypeChecker::operator() (const ArrayTypePtr &arr_type)
 {
-	if(_idx == _parent_ptr->children_cnt()) // exhaused
+	if(_idx == (int)_parent_ptr->children_cnt()) // exhaused
 	{
 		DBG(std::cout << "exhaused "; TypePrinter{std::cout}(arr_type);
 			std::cout << std::endl;);
 		return true;
 	}
 	AstPtr &curr = _parent_ptr->get_(_idx);
+	int base_pos = _pos;
+	bool exhausted = false;
 
 	if(std::holds_alternative<InitializerNodePtr>(curr))
 	{
@@ -31,13 +46,12 @@ bool SemanticChecker::InitializerTypeChecker::operator() (const ArrayTypePtr &ar
 		_parent_ptr = std::get<InitializerNodePtr>(curr).get();
 		_idx = 0;
 
-		for(int i = 0; i < arr_type->len(); i++)
-			if(std::visit(*this, arr_type->element_type())) // exhaused, finish the check
-				break;
+		_match_elements(arr_type);
 		// Check if there is exceed element.
-		if(_idx < _parent_ptr->children_cnt())
+		if(_idx < (int)_parent_ptr->children_cnt())
 			throw SemanticError(_parent_ptr->location().end,
 				"too many elements in the initializer list");
+		_parent_ptr->children_() = AstPtrVec(); // Moved to _flat, free the memory.
 		
 		// Restore _parent_ptr.
 		_parent_ptr = prev__parent_ptr;
@@ -45,56 +59,40 @@ bool SemanticChecker::InitializerTypeChecker::operator() (const ArrayTypePtr &ar
 	}
 	else
 	{
-		// Match expressions with an array.
-		if(arr_type->is_1d_arr())
-		{
-			InitializerNodePtr arr_rebuild = std::make_unique<InitializerNode>();
-			int parent_len = _parent_ptr->children_cnt();
-			int i;
-			for(i = 0; i < arr_type->len() && _idx + i < parent_len; i++)
-			{
-				AstPtr &ith_expr = _parent_ptr->get_(_idx + i);
-				if(std::holds_alternative<InitializerNodePtr>(ith_expr))
-					throw SemanticError(
-						std::get<InitializerNodePtr>(ith_expr)->location().begin,
-						"expected an expression but got an initializer"
-					);
-				if(_const_mode)
-					const_expr_replacer.replace_expr(_parent_ptr->get_(_idx + i));
-				arr_rebuild->push_back(std::move(ith_expr));
-			}
-
-			// Replace these expressions with a single InitializerNode.
-			auto &children = _parent_ptr->children_();
-			children.erase(
-				children.begin() + _idx + 1,
-				children.begin() + _idx + i
-			);
-			children[_idx] = std::move(arr_rebuild);
-			_idx++;
-		}
-		else
-		{
-			// Handle them until 1-d array.
-			return std::visit(*this, arr_type->element_type());
-		}
+		// Match the expressions from here with the elements of the array,
+		// as if they are enclosed by braces.
+		exhausted = _match_elements(arr_type);
 	}
-	return false;
+	_pos = base_pos + arr_type->len() * (arr_type->element_size() / sizeof(int));
+	return exhausted;
 }
 
-bool SemanticChecker::InitializerTypeChecker::operator() (const IntTypePtr &ele_type)
+bool SemanticChecker::InitializerTypeChecker::operator() (const IntTypePtr &)
 {
-	if(_idx == _parent_ptr->children_cnt()) // exhaused
+	if(_idx == (int)_parent_ptr->children_cnt()) // exhaused
 		return true;
 	AstPtr &curr = _parent_ptr->get_(_idx);
 
 	if(std::holds_alternative<InitializerNodePtr>(curr))
-		throw SemanticError(_parent_ptr->location().begin,
-			fstring("expted array type ", ele_type, ", but got an expression"));
+		throw SemanticError(std::get<InitializerNodePtr>(curr)->location().begin,
+			"expected an expression but got an initializer");
 	
-	DBG(std::cout << "match " << _parent_ptr->get(_idx) << " with expr" << std::endl);
-	if(_const_mode)
-		const_expr_replacer.replace_expr(_parent_ptr->get_(_idx));
+	DBG(std::cout << "match " << _parent_ptr->get(_idx) << " with expr at " << _pos << std::endl);
+	// Constant expressions are calculated, even if the array is not const.
+	if(_const_mode || const_expr_replacer.is_const_expr(curr))
+		const_expr_replacer.replace_expr(curr);
+	if(std::holds_alternative<ConstIntNodePtr>(curr))
+	{
+		int val = std::get<ConstIntNodePtr>(curr)->val();
+		if(val != 0)
+		{
+			if((int)_flat.vals.size() <= _pos)
+				_flat.vals.resize(_pos + 1, 0);
+			_flat.vals[_pos] = val;
+		}
+	}
+	else
+		_flat.exprs.emplace_back(_pos, std::move(curr));
 	
 	_idx++;
 	return false;
@@ -118,13 +116,14 @@ void SemanticChecker::InitializerTypeChecker::check_type(
 	const auto &_arr_type = std::get<ArrayTypePtr>(arr_type);
 	_parent_ptr = _initializer.get();
 	_idx = 0;
+	_pos = 0;
 	_const_mode = is_const(arr_type);
-	for(int i = 0; i < _arr_type->len(); i++)
-		if(std::visit(*this, _arr_type->element_type()))
-			break;
-	if(_idx < _parent_ptr->children_cnt())
+	_flat = FlatInitializer();
+	_match_elements(_arr_type);
+	if(_idx < (int)_parent_ptr->children_cnt())
 		throw SemanticError(_parent_ptr->location().end,
 			"too many elements in the initializer list");
+	_initializer->set_flat(std::move(_flat));
 }
 
 } // namespace compiler::frontend
\ No newline at end of file
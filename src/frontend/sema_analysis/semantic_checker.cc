@@ -59,7 +59,7 @@ void SemanticChecker::operator() (SingleVarDeclNodePtr &node)
 				throw SemanticError(id->location().begin,
 					"local const basic variable must have a initial value"
 				);
-			node->set_init_val(std::make_unique<ConstIntNode>(0));
+			node->set_init_val(make_node<ConstIntNode>(0));
 		}
 		const_expr_replacer.replace_expr(node->init_val_());
 		int id_init_val = std::get<ConstIntNodePtr>(node->init_val())->val();
@@ -93,12 +93,12 @@ void SemanticChecker::operator() (SingleVarDeclNodePtr &node)
 		}
 		else if(is_global())
 			// We are declaring a global variable, set its initial value to zero.
-			node->set_init_val(std::make_unique<ConstIntNode>(0));
+			node->set_init_val(make_node<ConstIntNode>(0));
 	}
 	else // array types
 	{
 		if(is_global() && is_null_ast(node->init_val()))
-			node->set_init_val(std::make_unique<InitializerNode>());
+			node->set_init_val(make_node<InitializerNode>());
 		if(!is_null_ast(node->init_val()))
 			initilaizer_type_checker.check_type(node->init_val_(), id_type);
 	}
@@ -125,7 +125,7 @@ void SemanticChecker::operator() (FuncDefNodePtr &node)
 	// Add function name and type to symbol table.
 	const TypePtr &retval_type = node->retval_type();
 	const auto &id = std::get<IdNodePtr>(node->name());
-	node->set_type(std::make_shared<FuncType>(retval_type, std::move(param_types)));
+	node->set_type(make_func(retval_type, param_types));
 	if(!table.insert(id->name(), node->type()))
 		throw SemanticError(id->location().begin,
 			fstring("conflict definition of id ", id->name()));
@@ -36,6 +36,8 @@ class SemanticChecker
 		template<class ErrorType> AstPtr operator() (ErrorType &node);
 
 		void replace_expr(AstPtr &expr_node);
+		// Whether replace_expr would succeed on the expression.
+		bool is_const_expr(const AstPtr &expr_node) const;
 	};
 
 	// Deduce the type of the IdNode in the declaration part. Also simplifies the
@@ -70,7 +72,7 @@ class SemanticChecker
 		// 	const TypePtr &base_type);
 	};
 
-	// Check and set the type of the initializer list. Throw 
+	// Check the type of the initializer list, and flatten it. Throw 
 	// SemanticError for invalid initializers.
 	struct InitializerTypeChecker
 	{
@@ -78,14 +80,19 @@ class SemanticChecker
 	  protected:
 		InitializerNode *_parent_ptr; // points to the parent initializer.
 		int _idx; // the index of the child node
+		int _pos; // the position of the element matching in the array
 		bool _const_mode;
+		FlatInitializer _flat;
+
+		bool _match_elements(const ArrayTypePtr &arr_type);
 
 	  public:
 		InitializerTypeChecker(ConstExprReplacer &expr_replacer)
 		  : const_expr_replacer(expr_replacer), _parent_ptr(nullptr),
-		  	_idx(0), _const_mode(false) {}
+		  	_idx(0), _pos(0), _const_mode(false) {}
 
-		// Return whether the initializer list is exhausted.
+		// Match the children from _idx with an element at _pos. Return
+		// whether the initializer list is exhausted.
 		bool operator() (const ArrayTypePtr &arr_type);
 		bool operator() (const IntTypePtr &ele_type);
 		template<class ErrorType> bool operator() (const ErrorType &err_type);
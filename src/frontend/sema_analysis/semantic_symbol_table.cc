@@ -1,8 +1,5 @@
-#include <memory>
 #include "semantic_symbol_table.h"
 
-using std::make_shared;
-
 namespace compiler::frontend
 {
 
@@ -17,18 +14,18 @@ namespace compiler::frontend
  * void _sysy_starttime(int lineno)
  * void _sysy_stoptime(int lineno)
  */
-const std::vector<std::pair<std::string, SemanticSymbolTableEntry>> SemanticSymbolTable::INTERNAL_FUNCTIONS = {
-	{ "getint", 	SemanticSymbolTableEntry(make_shared<FuncType>(make_int(), TypePtrVec()))													},
-	{ "getch", 		SemanticSymbolTableEntry(make_shared<FuncType>(make_int(), TypePtrVec()))													},
-	{ "getarray",	SemanticSymbolTableEntry(make_shared<FuncType>(make_int(), TypePtrVec{make_shared<PointerType>(make_int())}))				},
-	{ "putint", 	SemanticSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}))										},
-	{ "putch", 		SemanticSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}))										},
-	{ "putarray",	SemanticSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int(), make_shared<PointerType>(make_int())}))	},
-	{ "_sysy_starttime", 	SemanticSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}))								},
-	{ "_sysy_stoptime", 	SemanticSymbolTableEntry(make_shared<FuncType>(make_void(), TypePtrVec{make_int()}))								}
+const std::vector<std::pair<utils::Symbol, SemanticSymbolTableEntry>> SemanticSymbolTable::INTERNAL_FUNCTIONS = {
+	{ utils::Symbol("getint"), 	SemanticSymbolTableEntry(make_func(make_int(), TypePtrVec()))													},
+	{ utils::Symbol("getch"), 		SemanticSymbolTableEntry(make_func(make_int(), TypePtrVec()))													},
+	{ utils::Symbol("getarray"),	SemanticSymbolTableEntry(make_func(make_int(), TypePtrVec{make_pointer(make_int())}))				},
+	{ utils::Symbol("putint"), 	SemanticSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}))										},
+	{ utils::Symbol("putch"), 		SemanticSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}))										},
+	{ utils::Symbol("putarray"),	SemanticSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int(), make_pointer(make_int())}))	},
+	{ utils::Symbol("_sysy_starttime"), 	SemanticSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}))								},
+	{ utils::Symbol("_sysy_stoptime"), 	SemanticSymbolTableEntry(make_func(make_void(), TypePtrVec{make_int()}))								}
 };
 
-SemanticSymbolTable::SemanticSymbolTable(): ChainedMap<std::string, SemanticSymbolTableEntry>()
+SemanticSymbolTable::SemanticSymbolTable(): ScopedMap<utils::Symbol, SemanticSymbolTableEntry>()
 {
 	for(const auto &predef_func : INTERNAL_FUNCTIONS)
 		basic_insert(predef_func);
@@ -1,10 +1,10 @@
 #ifndef SEMANTIC_SYMBOL_TABLE_H
 #define SEMANTIC_SYMBOL_TABLE_H
 
-#include <string>
 #include <vector>
 #include <utility>
-#include "chained_map.h"
+#include "scoped_map.h"
+#include "symbol.h"
 #include "type.h"
 
 namespace compiler::frontend
@@ -27,21 +27,15 @@ struct SemanticSymbolTableEntry
 	  : type(_type), initial_val(_initial_val) {}
 };
 
-class SemanticSymbolTable: public utils::ChainedMap<std::string, SemanticSymbolTableEntry>
+class SemanticSymbolTable: public utils::ScopedMap<utils::Symbol, SemanticSymbolTableEntry>
 {
-	static const std::vector<std::pair<std::string, SemanticSymbolTableEntry>> INTERNAL_FUNCTIONS;
+	static const std::vector<std::pair<utils::Symbol, SemanticSymbolTableEntry>> INTERNAL_FUNCTIONS;
 
   public:
 	SemanticSymbolTable();
 
 	template<class... Ts>
-	bool insert(const std::string &name, const Ts... ts)
-	{
-		return basic_insert(name, SemanticSymbolTableEntry(std::move(ts)...)).second;
-	}
-	
-	template<class... Ts>
-	bool insert(std::string &&name, const Ts... ts)
+	bool insert(utils::Symbol name, const Ts... ts)
 	{
 		return basic_insert(name, SemanticSymbolTableEntry(std::move(ts)...)).second;
 	}
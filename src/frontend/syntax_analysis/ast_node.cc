@@ -9,6 +9,14 @@ using compiler::utils::LambdaVisitor;
 namespace compiler::frontend
 {
 
+thread_local AstArena *AstArena::_curr = nullptr;
+
+AstArena &AstArena::curr()
+{
+	INTERNAL_ASSERT(_curr != nullptr, "creating an AST node without an arena");
+	return *_curr;
+}
+
 VarDeclNode::VarDeclNode(TypePtr base_type, AstPtrVec &&definitions)
   : XaryAstNodeBase(std::move(definitions)), _base_type(base_type)
 {
@@ -33,13 +41,13 @@ ConstIntNode::ConstIntNode(int val)
 	DBG(std::cout << "ConstIntNode built! val = " << _val << std::endl);
 }
 
-IdNode::IdNode(std::string name, yy::location loc)
+IdNode::IdNode(utils::Symbol name, yy::location loc)
   : _name(name), _loc(loc)
 {
 	DBG(std::cout << "IdNode built! name = " << _name << std::endl);
 }
 
-IdNode::IdNode(TypePtr type, std::string name, yy::location loc)
+IdNode::IdNode(TypePtr type, utils::Symbol name, yy::location loc)
   : _name(name), _loc(loc)
 {
 	DBG(std::cout << "IdNode built! name = " << _name << std::endl);
@@ -57,9 +65,18 @@ InitializerNode::InitializerNode(AstPtrVec &&sub_initializer, yy::location loc)
 	DBG(std::cout << "InitializerNode built! len = " << children_cnt() << std::endl);
 }
 
+void InitializerNode::set_flat(FlatInitializer &&flat)
+{
+	_flat = std::move(flat);
+	_flattened = true;
+	_children = AstPtrVec(); // Frees the memory.
+	DBG(std::cout << "InitializerNode flattened! len = " << _flat.vals.size()
+		<< ", exprs = " << _flat.exprs.size() << std::endl);
+}
+
 FuncDefNode::FuncDefNode(TypePtr retval_type, AstPtr &&name, AstPtr &&block)
   // paramless function definition
-  : NaryAstNodeBase<3>({std::move(name), std::make_unique<FuncParamsNode>(), std::move(block)}),
+  : NaryAstNodeBase<3>({std::move(name), make_node<FuncParamsNode>(), std::move(block)}),
 	_retval_type(retval_type)
 {
 	DBG(std::cout << "FuncDefNode built! ret_type = " << _retval_type << std::endl);
@@ -137,7 +154,7 @@ RetNode::RetNode(AstPtr &&expr, yy::location loc)
 }
 
 FuncCallNode::FuncCallNode(AstPtr &&id)
-  : NaryAstNodeBase<2>({std::move(id), std::make_unique<FuncArgsNode>()})
+  : NaryAstNodeBase<2>({std::move(id), make_node<FuncArgsNode>()})
 {
 	DBG(std::cout << "FuncCallNode built!" << std::endl);
 }
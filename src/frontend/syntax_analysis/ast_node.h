@@ -1,12 +1,17 @@
 #ifndef AST_NODE_H
 #define AST_NODE_H
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <utility>
 #include <variant>
 #include <vector>
 #include "type.h"
 #include "location.h"
+#include "arena.h"
+#include "symbol.h"
 
 namespace compiler::frontend
 {
@@ -38,32 +43,73 @@ class RetNode;
 class FuncCallNode;
 class FuncArgsNode;
 
+// A non-owning handle of an AST node. All the nodes are allocated by
+// make_node() in the current AstArena, and freed together with the arena.
+template<class T>
+class NodePtr
+{
+  protected:
+	T *_ptr;
+
+  public:
+	NodePtr(): _ptr(nullptr) {}
+	explicit NodePtr(T *ptr): _ptr(ptr) {}
+
+	inline T *get() const { return _ptr; }
+	inline T *operator -> () const { return _ptr; }
+	inline T &operator * () const { return *_ptr; }
+	inline explicit operator bool () const { return _ptr != nullptr; }
+	inline bool operator == (const NodePtr &other) const { return _ptr == other._ptr; }
+	inline bool operator != (const NodePtr &other) const { return _ptr != other._ptr; }
+};
+
+// The arena of all the AST nodes of a parse. An arena becomes the current
+// one of the thread during its lifetime, so it must outlive every use of the
+// AST built in it.
+class AstArena: public utils::Arena
+{
+  protected:
+	AstArena *_prev;
+	static thread_local AstArena *_curr;
+
+  public:
+	AstArena(): _prev(_curr) { _curr = this; }
+	~AstArena() { _curr = _prev; }
+
+	static AstArena &curr();
+};
+
+template<class T, class... Ts>
+inline NodePtr<T> make_node(Ts&&... ts)
+{
+	return NodePtr<T>(AstArena::curr().make<T>(std::forward<Ts>(ts)...));
+}
+
 // all the node pointer classes of AST
-// They are all std::unqiue_ptr's of the corresponding node class.
-using ProgramNodePtr = std::unique_ptr<ProgramNode>;
-using VarDeclNodePtr = std::unique_ptr<VarDeclNode>;
-using SingleVarDeclNodePtr = std::unique_ptr<SingleVarDeclNode>;
-using ConstIntNodePtr = std::unique_ptr<ConstIntNode>;
-using IdNodePtr = std::unique_ptr<IdNode>;
-using InitializerNodePtr = std::unique_ptr<InitializerNode>;
-using FuncDefNodePtr = std::unique_ptr<FuncDefNode>;
-using FuncParamsNodePtr = std::unique_ptr<FuncParamsNode>;
-using SingleFuncParamNodePtr = std::unique_ptr<SingleFuncParamNode>;
-using BlockNodePtr = std::unique_ptr<BlockNode>;
-using UnaryOpNodePtr = std::unique_ptr<UnaryOpNode>;
-using BinaryOpNodePtr = std::unique_ptr<BinaryOpNode>;
-using IfNodePtr = std::unique_ptr<IfNode>;
-using WhileNodePtr = std::unique_ptr<WhileNode>;
-using BreakNodePtr = std::unique_ptr<BreakNode>;
-using ContNodePtr = std::unique_ptr<ContNode>;
-using RetNodePtr = std::unique_ptr<RetNode>;
-using FuncCallNodePtr = std::unique_ptr<FuncCallNode>;
-using FuncArgsNodePtr = std::unique_ptr<FuncArgsNode>;
+using ProgramNodePtr = NodePtr<ProgramNode>;
+using VarDeclNodePtr = NodePtr<VarDeclNode>;
+using SingleVarDeclNodePtr = NodePtr<SingleVarDeclNode>;
+using ConstIntNodePtr = NodePtr<ConstIntNode>;
+using IdNodePtr = NodePtr<IdNode>;
+using InitializerNodePtr = NodePtr<InitializerNode>;
+using FuncDefNodePtr = NodePtr<FuncDefNode>;
+using FuncParamsNodePtr = NodePtr<FuncParamsNode>;
+using SingleFuncParamNodePtr = NodePtr<SingleFuncParamNode>;
+using BlockNodePtr = NodePtr<BlockNode>;
+using UnaryOpNodePtr = NodePtr<UnaryOpNode>;
+using BinaryOpNodePtr = NodePtr<BinaryOpNode>;
+using IfNodePtr = NodePtr<IfNode>;
+using WhileNodePtr = NodePtr<WhileNode>;
+using BreakNodePtr = NodePtr<BreakNode>;
+using ContNodePtr = NodePtr<ContNode>;
+using RetNodePtr = NodePtr<RetNode>;
+using FuncCallNodePtr = NodePtr<FuncCallNode>;
+using FuncArgsNodePtr = NodePtr<FuncArgsNode>;
 
 
 // The universal pointer class.
-// We would always assume that AstPtr is passed as rvalue's, since they are
-// unique_ptr's and they have to be passed by std::move.
+// AstPtr is trivially copyable, but is still passed by std::move like an
+// owning pointer, where it is moved into its parent node.
 using AstPtr = std::variant
 <
 	std::monostate, // indicating nullptrs
@@ -94,6 +140,35 @@ using NullAst = std::monostate;
 inline bool is_null_ast(const AstPtr &node)
 	{ return std::holds_alternative<std::monostate>(node); }
 
+// The source location of a node, with each of its positions packed into 32
+// bits: the line in the high 20 bits and the column in the low 12 (both
+// saturated). It is expanded into a yy::location only to report an error.
+class CompactLocation
+{
+  protected:
+	static constexpr int COLUMN_BITS = 12;
+	static constexpr uint32_t MAX_COLUMN = (1u << COLUMN_BITS) - 1;
+	static constexpr uint32_t MAX_LINE = (1u << (32 - COLUMN_BITS)) - 1;
+
+	uint32_t _begin;
+	uint32_t _end;
+
+	static inline uint32_t _pack(const yy::position &pos)
+	{
+		uint32_t line = std::min<uint32_t>(pos.line, MAX_LINE);
+		uint32_t column = std::min<uint32_t>(pos.column, MAX_COLUMN);
+		return line << COLUMN_BITS | column;
+	}
+	static inline yy::position _unpack(uint32_t packed)
+		{ return yy::position(nullptr, packed >> COLUMN_BITS, packed & MAX_COLUMN); }
+
+  public:
+	CompactLocation(): _begin(0), _end(0) {}
+	CompactLocation(const yy::location &loc): _begin(_pack(loc.begin)), _end(_pack(loc.end)) {}
+
+	inline yy::location expand() const { return yy::location(_unpack(_begin), _unpack(_end)); }
+};
+
 class AstNodeBase
 {
 };
@@ -211,30 +286,43 @@ class ConstIntNode: public AstLeafNodeBase
 class IdNode: public AstLeafNodeBase
 {
   protected:
-	std::string _name;
-	yy::position _pos;
-	yy::location _loc;
+	utils::Symbol _name;
+	CompactLocation _loc;
 
   public:
 	IdNode() = default;
-	IdNode(TypePtr type, std::string name, yy::location loc);
+	IdNode(TypePtr type, utils::Symbol name, yy::location loc);
 
 	// Typeless id, used during syntax analysis of vairable declaration. Their types are set later
 	// during sematic analysis.
-	IdNode(std::string name, yy::location loc);
+	IdNode(utils::Symbol name, yy::location loc);
 
 	// Getters & setters.
-	inline const std::string &name() { return _name; }
-	inline yy::location location() const { return _loc; }
+	inline utils::Symbol name() const { return _name; }
+	inline yy::location location() const { return _loc.expand(); }
+};
+
+// The elements of an array initializer in row-major order, matched with the
+// type of the array. The constant elements are in vals, and the others are
+// in exprs with their positions (the vals there are 0). The elements after
+// vals and not in exprs are 0.
+struct FlatInitializer
+{
+	std::vector<int> vals;
+	std::vector<std::pair<int, AstPtr>> exprs; // Sorted by the positions.
 };
 
 // InitializerNode
 //  -> (InitializerNode|ExprNode)*
 // ExprNode = IdNode|ConstIntNode|UnaryOpNode|BinaryOpNode|FuncCallNode
+// The children of an initializer of a declaration are replaced with a
+// FlatInitializer during semantic analysis.
 class InitializerNode: public XaryAstNodeBase
 {
   protected:
-	yy::location _loc;
+	CompactLocation _loc;
+	FlatInitializer _flat;
+	bool _flattened = false;
 
   public:
 	InitializerNode() = default;
@@ -244,7 +332,10 @@ class InitializerNode: public XaryAstNodeBase
 	InitializerNode(AstPtrVec &&sub_initializer, yy::location loc);
 	
 	// Getters & setters
-	yy::location location() const { return _loc; }
+	yy::location location() const { return _loc.expand(); }
+	inline bool is_flattened() const { return _flattened; }
+	inline const FlatInitializer &flat() const { return _flat; }
+	void set_flat(FlatInitializer &&flat);
 };
 
 // FuncDefNode
@@ -328,7 +419,7 @@ class UnaryOpNode: public NaryAstNodeBase<1>
 
   protected:
 	OpType _op;
-	yy::location _loc;
+	CompactLocation _loc;
 
   public:
 	UnaryOpNode() = default;
@@ -338,7 +429,7 @@ class UnaryOpNode: public NaryAstNodeBase<1>
 	OpType op() const { return _op; }
 	inline const AstPtr &operand() const { return get(0); }
 	inline AstPtr &operand_() { return get_(0); }
-	inline yy::location location() const { return _loc; }
+	inline yy::location location() const { return _loc.expand(); }
 	inline void set_operand(AstPtr &&operand) { set(0, std::move(operand)); }
 };
 
@@ -355,7 +446,7 @@ class BinaryOpNode: public NaryAstNodeBase<2>
 
   protected:
 	OpType _op;
-	yy::location _loc;
+	CompactLocation _loc;
 
   public:
 	BinaryOpNode() = default;
@@ -367,7 +458,7 @@ class BinaryOpNode: public NaryAstNodeBase<2>
 	inline const AstPtr &operand2() const { return get(1); }
 	inline AstPtr &operand1_() { return get_(0); }
 	inline AstPtr &operand2_() { return get_(1); }
-	inline yy::location location() const { return _loc; }
+	inline yy::location location() const { return _loc.expand(); }
 	inline void set_operand1(AstPtr &&operand1) { set(0, std::move(operand1)); }
 	inline void set_operand2(AstPtr &&operand2) { set(1, std::move(operand2)); }
 };
@@ -408,25 +499,25 @@ class WhileNode: public NaryAstNodeBase<2>
 class BreakNode: public AstLeafNodeBase
 {
   protected:
-	yy::location _loc;
+	CompactLocation _loc;
 
   public:
 	BreakNode() = default;
 	BreakNode(yy::location loc);
 
-	yy::location location() const { return _loc; }
+	yy::location location() const { return _loc.expand(); }
 };
 
 class ContNode: public AstLeafNodeBase
 {
   protected:
-	yy::location _loc;
+	CompactLocation _loc;
 
   public:
 	ContNode() = default;
 	ContNode(yy::location loc);
 
-	yy::location location() const { return _loc; }
+	yy::location location() const { return _loc.expand(); }
 };
 
 // RetNode
@@ -435,7 +526,7 @@ class ContNode: public AstLeafNodeBase
 class RetNode: public NaryAstNodeBase<1>
 {
   protected:
-	yy::location _loc;
+	CompactLocation _loc;
 
   public:
 	RetNode() = default;
@@ -445,7 +536,7 @@ class RetNode: public NaryAstNodeBase<1>
 	// Getters.
 	inline const AstPtr &expr() const { return get(0); }
 	inline AstPtr &expr_() { return get_(0); }
-	inline yy::location location() const { return _loc; }
+	inline yy::location location() const { return _loc.expand(); }
 };
 
 // FuncCallNode
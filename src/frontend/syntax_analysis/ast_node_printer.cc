@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "ast_node_printer.h"
 
 using std::endl;
@@ -57,6 +58,27 @@ void AstNodePrinter::operator() (const IdNodePtr &node)
 
 void AstNodePrinter::operator() (const InitializerNodePtr &node)
 {
+	if(node->is_flattened())
+	{
+		// Prints the elements in order, till the last one not implied to be 0.
+		const auto &flat = node->flat();
+		int len = flat.vals.size();
+		if(!flat.exprs.empty())
+			len = std::max(len, flat.exprs.back().first + 1);
+		out << '{';
+		auto expr_iter = flat.exprs.begin();
+		for(int i = 0; i < len; i++)
+		{
+			if(i > 0)
+				out << ", ";
+			if(expr_iter != flat.exprs.end() && expr_iter->first == i)
+				std::visit(*this, (expr_iter++)->second);
+			else
+				out << (i < (int)flat.vals.size()? flat.vals[i] : 0);
+		}
+		out << '}';
+		return;
+	}
 	out << '{';
 	for(int i = 0; i < node->children_cnt(); i++)
 	{
@@ -200,42 +222,67 @@ void AstNodePrinter::operator() (const FuncArgsNodePtr &node)
 
 }// namespace compiler::frontend
 
-std::ostream &operator << (std::ostream &out, const compiler::frontend::UnaryOpNode::OpType &op_type)
+namespace compiler::frontend
+{
+
+const char *op_type_str(UnaryOpNode::OpType op_type)
 {
-	using OpType = compiler::frontend::UnaryOpNode;
+	using OpType = UnaryOpNode;
 	switch(op_type)
 	{
-		case OpType::NEG: out << '-'; break;
-		case OpType::NOT: out << '!'; break;
-		case OpType::POINTER: out << '&'; break;
-		default: out << "?"; break;
+		case OpType::NEG: return "-";
+		case OpType::NOT: return "!";
+		case OpType::POINTER: return "&";
+		default: return "?";
 	}
-	return out;
 }
 
-std::ostream &operator << (std::ostream &out, const compiler::frontend::BinaryOpNode::OpType &op_type)
+const char *op_type_str(BinaryOpNode::OpType op_type)
 {
-	using OpType = compiler::frontend::BinaryOpNode;
+	using OpType = BinaryOpNode;
 	switch(op_type)
 	{
-		case OpType::ADD: out << '+'; break;
-		case OpType::SUB: out << '-'; break;
-		case OpType::MUL: out << '*'; break;
-		case OpType::DIV: out << '/'; break;
-		case OpType::MOD: out << '%'; break;
-		case OpType::OR: out << '|'; break;
-		case OpType::AND: out << '&'; break;
-		case OpType::GT: out << '>'; break;
-		case OpType::LT: out << '<'; break;
-		case OpType::GE: out << ">="; break;
-		case OpType::LE: out << "<="; break;
-		case OpType::EQ: out << "=="; break;
-		case OpType::NE: out << "!="; break;
-		case OpType::ASSIGN: out << "="; break;
-		case OpType::ACCESS: out << "@"; break;
-		default: out << '?'; break;
+		case OpType::ADD: return "+";
+		case OpType::SUB: return "-";
+		case OpType::MUL: return "*";
+		case OpType::DIV: return "/";
+		case OpType::MOD: return "%";
+		case OpType::OR: return "|";
+		case OpType::AND: return "&";
+		case OpType::GT: return ">";
+		case OpType::LT: return "<";
+		case OpType::GE: return ">=";
+		case OpType::LE: return "<=";
+		case OpType::EQ: return "==";
+		case OpType::NE: return "!=";
+		case OpType::ASSIGN: return "=";
+		case OpType::ACCESS: return "@";
+		default: return "?";
 	}
-	return out;
+}
+
+} // namespace compiler::frontend
+
+std::ostream &operator << (std::ostream &out, const compiler::frontend::UnaryOpNode::OpType &op_type)
+{
+	return out << compiler::frontend::op_type_str(op_type);
+}
+
+std::ostream &operator << (std::ostream &out, const compiler::frontend::BinaryOpNode::OpType &op_type)
+{
+	return out << compiler::frontend::op_type_str(op_type);
+}
+
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::frontend::UnaryOpNode::OpType &op_type)
+{
+	return out << compiler::frontend::op_type_str(op_type);
+}
+
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::frontend::BinaryOpNode::OpType &op_type)
+{
+	return out << compiler::frontend::op_type_str(op_type);
 }
 
 std::ostream &operator << (std::ostream &out, const compiler::frontend::AstNodePrinter::Indent &indent)
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <string>
 #include "exceptions.h"
+#include "output_writer.h"
 #include "ast_node.h"
 
 namespace compiler::frontend
@@ -46,10 +47,17 @@ struct AstNodePrinter
 	void operator() (const FuncArgsNodePtr &node);
 };
 
+const char *op_type_str(UnaryOpNode::OpType op_type);
+const char *op_type_str(BinaryOpNode::OpType op_type);
+
 } // namespace compiler::frontend
 
 std::ostream &operator << (std::ostream &out, const compiler::frontend::UnaryOpNode::OpType &op_type);
 std::ostream &operator << (std::ostream &out, const compiler::frontend::BinaryOpNode::OpType &op_type);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::frontend::UnaryOpNode::OpType &op_type);
+compiler::utils::OutputWriter &operator << (compiler::utils::OutputWriter &out,
+	const compiler::frontend::BinaryOpNode::OpType &op_type);
 std::ostream &operator << (std::ostream &out, const compiler::frontend::AstNodePrinter::Indent &indent);
 std::ostream &operator << (std::ostream &out, const compiler::frontend::AstPtr &node);
 
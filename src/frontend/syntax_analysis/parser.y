@@ -6,13 +6,20 @@
 %locations // Track token locations.
 %define api.location.file "../../utils/location.h"
 
-%parse-param {compiler::frontend::AstPtr &prog_node}
+// The parser is reentrant: every parse has its own scanner.
+%parse-param {yyscan_t scanner} {compiler::frontend::AstPtr &prog_node}
+%lex-param {yyscan_t scanner}
 
 %code requires
 {
+	#include <cstdio>
 	#include <memory>
 	#include "ast_node.h"
 	#include "type.h"
+	#include "symbol.h"
+	#include "exceptions.h"
+
+	typedef void *yyscan_t;
 }
 
 %code provides
@@ -24,8 +31,10 @@
 
 	extern "C"
 	{
-		int yylex(YYSTYPE *yylval,YYLTYPE *yylloc);
-		void set_input_file(const char *filename);
+		int yylex(YYSTYPE *yylval, YYLTYPE *yylloc, yyscan_t scanner);
+		// Creates a scanner reading from in, which is not closed by the scanner.
+		yyscan_t create_scanner(FILE *in);
+		void destroy_scanner(yyscan_t scanner);
 	}
 }
 
@@ -38,7 +47,7 @@
 			LSBRKT RSBRKT
 
 %token<int> UINT
-%token<std::string> ID
+%token<compiler::utils::Symbol> ID
 
 // The unused non-terminal retval type.
 %nterm<int> program
@@ -64,7 +73,7 @@
 %%
 
 program: // ProgramNode
-  %empty { prog_node = std::make_unique<compiler::frontend::ProgramNode>(); }
+  %empty { prog_node = compiler::frontend::make_node<compiler::frontend::ProgramNode>(); }
 | program var_decl
 		{
 			std::get<compiler::frontend::ProgramNodePtr>(prog_node)->push_back(
@@ -81,7 +90,7 @@ program: // ProgramNode
 var_decl: // VarDeclNode
   base_type var_decl_list SEMI
 		{
-			$$ = std::make_unique<compiler::frontend::VarDeclNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::VarDeclNode>(
 				std::move($base_type), std::move($var_decl_list)
 			);
 		}
@@ -105,23 +114,23 @@ var_decl_list: // vector<SingleVarDeclNode>
 // e.g. "a = b" or "b[3] = {a, 2 * a}"
 single_var_decl: // SingleVarDeclNode
   ID	{
-  			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-  			$$ = std::make_unique<compiler::frontend::SingleVarDeclNode>(std::move(id_node));
+  			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+  			$$ = compiler::frontend::make_node<compiler::frontend::SingleVarDeclNode>(std::move(id_node));
   		}
 | ID ASSIGN expr
 		{
-			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-			$$ = std::make_unique<compiler::frontend::SingleVarDeclNode>(
+			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+			$$ = compiler::frontend::make_node<compiler::frontend::SingleVarDeclNode>(
 				std::move(id_node), std::move($expr)
 			);
 		}
 | array_access
 		{
-			$$ = std::make_unique<compiler::frontend::SingleVarDeclNode>(std::move($array_access));
+			$$ = compiler::frontend::make_node<compiler::frontend::SingleVarDeclNode>(std::move($array_access));
 		}
 | array_access ASSIGN array_initializer
 		{
-			$$ = std::make_unique<compiler::frontend::SingleVarDeclNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::SingleVarDeclNode>(
 				std::move($array_access), std::move($array_initializer)
 			);
 		}
@@ -131,13 +140,13 @@ single_var_decl: // SingleVarDeclNode
 array_initializer: // InitializerNode
   LCBRKT array_initializer_list RCBRKT
   		{
-  			$$ = std::make_unique<compiler::frontend::InitializerNode>(
+  			$$ = compiler::frontend::make_node<compiler::frontend::InitializerNode>(
   				std::move($array_initializer_list), @array_initializer_list
   			);
   		}
 | LCBRKT RCBRKT
 		{
-			$$ = std::make_unique<compiler::frontend::InitializerNode>(@LCBRKT);
+			$$ = compiler::frontend::make_node<compiler::frontend::InitializerNode>(@LCBRKT);
 		}
 ;
 
@@ -170,16 +179,16 @@ array_initializer_list: // vector<IdNode|ConstIntNode|UnaryOpNode|BinaryOpNode|F
 func_def: // FuncDefNode
   base_type ID LBRKT func_def_params RBRKT block
   		{
-  			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-  			$$ = std::make_unique<compiler::frontend::FuncDefNode>(
+  			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+  			$$ = compiler::frontend::make_node<compiler::frontend::FuncDefNode>(
   				$base_type, std::move(id_node), std::move($func_def_params),
   				std::move($block)
   			);
   		}
 | base_type ID LBRKT RBRKT block
 		{
-			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-			$$ = std::make_unique<compiler::frontend::FuncDefNode>(
+			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+			$$ = compiler::frontend::make_node<compiler::frontend::FuncDefNode>(
 				$base_type, std::move(id_node), std::move($block)
 			);
 		}
@@ -195,7 +204,7 @@ func_def_params: // FuncParamsNode
   		}
 | func_def_param
 		{
-			$$ = std::make_unique<compiler::frontend::FuncParamsNode>();
+			$$ = compiler::frontend::make_node<compiler::frontend::FuncParamsNode>();
 			std::get<compiler::frontend::FuncParamsNodePtr>($$)->push_back(
 				std::move($func_def_param));
 		}
@@ -205,14 +214,14 @@ func_def_params: // FuncParamsNode
 func_def_param: // SingleFuncParamNode
   base_type ID
   		{
-  			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-  			$$ = std::make_unique<compiler::frontend::SingleFuncParamNode>(
+  			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+  			$$ = compiler::frontend::make_node<compiler::frontend::SingleFuncParamNode>(
   				$base_type, std::move(id_node)
   			);
   		}
 | base_type arr_param_decl
 		{
-			$$ = std::make_unique<compiler::frontend::SingleFuncParamNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::SingleFuncParamNode>(
 				$base_type, std::move($arr_param_decl)
 			);
 		}
@@ -222,15 +231,15 @@ func_def_param: // SingleFuncParamNode
 arr_param_decl: // BinaryOpNode(ACCESS only)|UnaryOpNode(POINTER only)
   ID LSBRKT RSBRKT
   		{
-  			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-  			$$ = std::make_unique<compiler::frontend::UnaryOpNode>(
+  			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+  			$$ = compiler::frontend::make_node<compiler::frontend::UnaryOpNode>(
   				compiler::frontend::UnaryOpNode::POINTER,
   				std::move(id_node), @LSBRKT
   			);
   		}
 | arr_param_decl[subdecl] LSBRKT expr RSBRKT
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::ACCESS,
 				std::move($subdecl), std::move($expr), @LSBRKT
 			);
@@ -240,9 +249,9 @@ arr_param_decl: // BinaryOpNode(ACCESS only)|UnaryOpNode(POINTER only)
 // e.g. "{ int a = 3; return a; }" or "{}"
 block: // BlockNode
   LCBRKT block_item_list RCBRKT
-  		{ $$ = std::make_unique<compiler::frontend::BlockNode>(std::move($block_item_list)); }
+  		{ $$ = compiler::frontend::make_node<compiler::frontend::BlockNode>(std::move($block_item_list)); }
 | LCBRKT RCBRKT
-		{ $$ = std::make_unique<compiler::frontend::BlockNode>(); }
+		{ $$ = compiler::frontend::make_node<compiler::frontend::BlockNode>(); }
 ;
 
 // e.g. "int a = 3; return a;"
@@ -289,15 +298,15 @@ statement: // IdNode|ConstIntNode|UnaryOpNode|BinaryOpNode|FuncCallNode|IfNode|W
 assign_statement: // BinaryOpNode
   ID ASSIGN expr SEMI
   		{
-  			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-  			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+  			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+  			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
   				compiler::frontend::BinaryOpNode::ASSIGN,
   				std::move(id_node), std::move($expr), @ASSIGN
   			);
   		}
 | array_access ASSIGN expr SEMI
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::ASSIGN,
 				std::move($array_access), std::move($expr), @ASSIGN
 			);
@@ -311,13 +320,13 @@ if_statement: // IfNode
    */
   IF LBRKT expr RBRKT statement %prec IF
   		{
-  			$$ = std::make_unique<compiler::frontend::IfNode>(
+  			$$ = compiler::frontend::make_node<compiler::frontend::IfNode>(
   				std::move($expr), std::move($statement)
   			);
   		}
 | IF LBRKT expr RBRKT statement[statement1] ELSE statement[statement2]
 		{
-			$$ = std::make_unique<compiler::frontend::IfNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::IfNode>(
 				std::move($expr), std::move($statement1), std::move($statement2)
 			);
 		}
@@ -326,7 +335,7 @@ if_statement: // IfNode
 while_statement: // WhileNode
   WHILE LBRKT expr RBRKT statement
   		{
-  			$$ = std::make_unique<compiler::frontend::WhileNode>(
+  			$$ = compiler::frontend::make_node<compiler::frontend::WhileNode>(
   				std::move($expr), std::move($statement)
   			);
   		}
@@ -334,19 +343,19 @@ while_statement: // WhileNode
 
 return_statement: // RetNode
   RET SEMI
-		{ $$ = std::make_unique<compiler::frontend::RetNode>(@RET); }
+		{ $$ = compiler::frontend::make_node<compiler::frontend::RetNode>(@RET); }
 | RET expr SEMI
-  		{ $$ = std::make_unique<compiler::frontend::RetNode>(std::move($expr), @RET); }
+  		{ $$ = compiler::frontend::make_node<compiler::frontend::RetNode>(std::move($expr), @RET); }
 ;
 
 break_statement: // BreakNode
   BREAK SEMI
-  		{ $$ = std::make_unique<compiler::frontend::BreakNode>(@BREAK); }
+  		{ $$ = compiler::frontend::make_node<compiler::frontend::BreakNode>(@BREAK); }
 ;
 
 cont_statement: // ContNode
   CONT SEMI
-  		{ $$ = std::make_unique<compiler::frontend::ContNode>(@CONT); }
+  		{ $$ = compiler::frontend::make_node<compiler::frontend::ContNode>(@CONT); }
 ;
 
 base_type: // TypePtr
@@ -361,91 +370,91 @@ base_type: // TypePtr
 expr: // IdNode|ConstIntNode|UnaryOpNode|BinaryOpNode|FuncCallNode
   expr[opr1] ADD expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::ADD,
 				std::move($opr1), std::move($opr2), @ADD
 			);
 		}
 | expr[opr1] SUB expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::SUB,
 				std::move($opr1), std::move($opr2), @SUB
 			);
 		}
 | expr[opr1] MUL expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::MUL,
 				std::move($opr1), std::move($opr2), @MUL
 			);
 		}
 | expr[opr1] DIV expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::DIV,
 				std::move($opr1), std::move($opr2), @DIV
 			);
 		}
 | expr[opr1] MOD expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::MOD,
 				std::move($opr1), std::move($opr2), @MOD
 			);
 		}
 | expr[opr1] OR expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::OR,
 				std::move($opr1), std::move($opr2), @OR
 			);
 		}
 | expr[opr1] AND expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::AND,
 				std::move($opr1), std::move($opr2), @AND
 			);
 		}
 | expr[opr1] GT expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::GT,
 				std::move($opr1), std::move($opr2), @GT
 			);
 		}
 | expr[opr1] LT expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::LT,
 				std::move($opr1), std::move($opr2), @LT
 			);
 		}
 | expr[opr1] GE expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::GE,
 				std::move($opr1), std::move($opr2), @GE
 			);
 		}
 | expr[opr1] LE expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::LE,
 				std::move($opr1), std::move($opr2), @LE
 			);
 		}
 | expr[opr1] EQ expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::EQ,
 				std::move($opr1), std::move($opr2), @EQ
 			);
 		}
 | expr[opr1] NE expr[opr2]
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::NE,
 				std::move($opr1), std::move($opr2), @NE
 			);
@@ -454,14 +463,14 @@ expr: // IdNode|ConstIntNode|UnaryOpNode|BinaryOpNode|FuncCallNode
 		{ $$ = std::move($opr); }
 | SUB expr[opr] %prec NEG
 		{
-			$$ = std::make_unique<compiler::frontend::UnaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::UnaryOpNode>(
 				compiler::frontend::UnaryOpNode::NEG,
 				std::move($opr), @SUB
 			);
 		}
 | NOT expr[opr]
 		{
-			$$ = std::make_unique<compiler::frontend::UnaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::UnaryOpNode>(
 				compiler::frontend::UnaryOpNode::NOT,
 				std::move($opr), @NOT
 			);
@@ -469,11 +478,11 @@ expr: // IdNode|ConstIntNode|UnaryOpNode|BinaryOpNode|FuncCallNode
 | LBRKT expr[opr] RBRKT
 		{ $$ = std::move($opr); }
 | UINT
-		{ $$ = std::make_unique<compiler::frontend::ConstIntNode>($UINT); }
+		{ $$ = compiler::frontend::make_node<compiler::frontend::ConstIntNode>($UINT); }
 | func_call
 		{ $$ = std::move($func_call); }
 | ID
-		{ $$ = std::make_unique<compiler::frontend::IdNode>($ID, @ID); }
+		{ $$ = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID); }
 | array_access
 		{ $$ = std::move($array_access); }
 ;
@@ -482,15 +491,15 @@ expr: // IdNode|ConstIntNode|UnaryOpNode|BinaryOpNode|FuncCallNode
 array_access: // BinaryOpNode(ACCESS only)
   ID LSBRKT expr RSBRKT
 		{
-			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::ACCESS,
 				std::move(id_node), std::move($expr), @LSBRKT
 			);
 		}
 | array_access[subarr] LSBRKT expr RSBRKT
 		{
-			$$ = std::make_unique<compiler::frontend::BinaryOpNode>(
+			$$ = compiler::frontend::make_node<compiler::frontend::BinaryOpNode>(
 				compiler::frontend::BinaryOpNode::ACCESS,
 				std::move($subarr), std::move($expr), @LSBRKT
 			);
@@ -504,33 +513,33 @@ func_call: // FuncCallNode
 			// #define starttime() _sysy_starttime(__LINE__)
 			// #define stoptime()  _sysy_stoptime(__LINE__)
 			
-			if($ID == "starttime" || $ID == "stoptime")
+			if($ID.str() == "starttime" || $ID.str() == "stoptime")
 			{
 				// First make an argument node, with lineno as its only argument.
-				auto arg_node = std::make_unique<compiler::frontend::FuncArgsNode>();
+				auto arg_node = compiler::frontend::make_node<compiler::frontend::FuncArgsNode>();
 				int lineno = @ID.begin.line;
-				arg_node->push_back(std::make_unique<compiler::frontend::ConstIntNode>(lineno));
+				arg_node->push_back(compiler::frontend::make_node<compiler::frontend::ConstIntNode>(lineno));
 
 				// Then make the corresponding function call.
 				compiler::frontend::IdNodePtr id_node;
-				if($ID == "starttime")
-					id_node = std::make_unique<compiler::frontend::IdNode>("_sysy_starttime", @ID);
+				if($ID.str() == "starttime")
+					id_node = compiler::frontend::make_node<compiler::frontend::IdNode>(compiler::utils::Symbol("_sysy_starttime"), @ID);
 				else // "stoptime"
-					id_node = std::make_unique<compiler::frontend::IdNode>("_sysy_stoptime", @ID);
-				$$ = std::make_unique<compiler::frontend::FuncCallNode>(
+					id_node = compiler::frontend::make_node<compiler::frontend::IdNode>(compiler::utils::Symbol("_sysy_stoptime"), @ID);
+				$$ = compiler::frontend::make_node<compiler::frontend::FuncCallNode>(
 					std::move(id_node), std::move(arg_node)
 				);
 			}
 			else
 			{
-				auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-  				$$ = std::make_unique<compiler::frontend::FuncCallNode>(std::move(id_node));
+				auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+  				$$ = compiler::frontend::make_node<compiler::frontend::FuncCallNode>(std::move(id_node));
 			}
   		}
 | ID LBRKT func_args RBRKT
 		{
-			auto id_node = std::make_unique<compiler::frontend::IdNode>($ID, @ID);
-			$$ = std::make_unique<compiler::frontend::FuncCallNode>(
+			auto id_node = compiler::frontend::make_node<compiler::frontend::IdNode>($ID, @ID);
+			$$ = compiler::frontend::make_node<compiler::frontend::FuncCallNode>(
 				std::move(id_node), std::move($func_args)
 			);
 		}
@@ -545,7 +554,7 @@ func_args: // FuncArgsNode
 		}
 | expr
 		{
-			$$ = std::make_unique<compiler::frontend::FuncArgsNode>();
+			$$ = compiler::frontend::make_node<compiler::frontend::FuncArgsNode>();
 			std::get<compiler::frontend::FuncArgsNodePtr>($$)->push_back(
 				std::move($expr));
 		}
@@ -557,6 +566,6 @@ namespace yy
 {
 	void parser::error(const location_type &loc, const std::string& msg)
 	{
-		std::cerr << "error at " << loc << ": " << msg << std::endl;
+		throw compiler::utils::SyntaxError(loc.begin, msg);
 	}
 }
\ No newline at end of file
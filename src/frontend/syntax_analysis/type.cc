@@ -1,4 +1,8 @@
+#include <map>
+#include <mutex>
+#include <unordered_map>
 #include "type.h"
+#include "arena.h"
 #include "exceptions.h"
 #include "visitor_helper.h"
 
@@ -7,6 +11,91 @@ using compiler::utils::LambdaVisitor;
 namespace compiler::frontend
 {
 
+namespace
+{
+
+// Interns all the types. Since the element types are interned before the
+// types built from them, a type is identified by the addresses of its
+// components, and only those are hashed and compared. The context is shared
+// by all the threads, the basic types are built in the constructor and the
+// others are built under a mutex.
+class TypeContext
+{
+  protected:
+	struct ArrayKeyHash
+	{
+		size_t operator() (const std::pair<const Type *, int> &key) const
+			{ return std::hash<const Type *>()(key.first) * 31 + key.second; }
+	};
+
+	std::mutex _mutex;
+	utils::Arena _arena;
+	TypePtr _void_type;
+	TypePtr _int_type;
+	TypePtr _const_int_type;
+	std::unordered_map<std::pair<const Type *, int>, ArrayTypePtr, ArrayKeyHash> _array_types;
+	std::unordered_map<const Type *, PointerTypePtr> _pointer_types;
+	// Keyed by the return value type followed by the argument types.
+	std::map<std::vector<const Type *>, FuncTypePtr> _func_types;
+
+	static const Type *_addr_of(const TypePtr &type)
+	{
+		static LambdaVisitor addr_getter = {
+			[](const std::monostate &) -> const Type * { return nullptr; },
+			[](const auto &t) -> const Type * { return t.get(); }
+		};
+		return std::visit(addr_getter, type);
+	}
+
+  public:
+	TypeContext()
+	  : _void_type(VoidTypePtr(_arena.make<VoidType>())),
+		_int_type(IntTypePtr(_arena.make<IntType>(false))),
+		_const_int_type(IntTypePtr(_arena.make<IntType>(true))) {}
+
+	inline const TypePtr &void_type() const { return _void_type; }
+	inline const TypePtr &int_type(bool is_const) const
+		{ return is_const? _const_int_type : _int_type; }
+
+	ArrayTypePtr array_type(const TypePtr &ele_type, int len)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto [iter, inserted] = _array_types.try_emplace({_addr_of(ele_type), len});
+		if(inserted)
+			iter->second = ArrayTypePtr(_arena.make<ArrayType>(ele_type, len));
+		return iter->second;
+	}
+
+	PointerTypePtr pointer_type(const TypePtr &base_type)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto [iter, inserted] = _pointer_types.try_emplace(_addr_of(base_type));
+		if(inserted)
+			iter->second = PointerTypePtr(_arena.make<PointerType>(base_type));
+		return iter->second;
+	}
+
+	FuncTypePtr func_type(const TypePtr &retval_type, const TypePtrVec &arg_types)
+	{
+		std::vector<const Type *> key{_addr_of(retval_type)};
+		for(const auto &arg_type : arg_types)
+			key.push_back(_addr_of(arg_type));
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto [iter, inserted] = _func_types.try_emplace(std::move(key));
+		if(inserted)
+			iter->second = FuncTypePtr(_arena.make<FuncType>(retval_type, arg_types));
+		return iter->second;
+	}
+
+	static TypeContext &global()
+	{
+		static TypeContext context;
+		return context;
+	}
+};
+
+} // namespace
+
 bool is_const(const TypePtr &type)
 {
 	static LambdaVisitor const_checker = {
@@ -28,22 +117,6 @@ bool is_basic(const TypePtr &type)
 	return std::visit(basic_checker, type);
 }
 
-bool same_type(const TypePtr &type1, const TypePtr &type2)
-{
-	static LambdaVisitor type_checker = {
-		[](const VoidTypePtr &t1, const VoidTypePtr &t2) { return true; },
-		[](const IntTypePtr &t1, const IntTypePtr &t2)
-			{ return t1->is_const() == t2->is_const(); },
-		[](const ArrayTypePtr &t1, const ArrayTypePtr &t2)
-			{ return t1->len() == t2->len()
-				&& same_type(t1->element_type(), t2->element_type()); },
-		[](const PointerTypePtr &t1, const PointerTypePtr &t2)
-			{ return same_type(t1->base_type(), t2->base_type()); },
-		[](const auto &t1, const auto &t2) { return false; }
-	};
-	return std::visit(type_checker, type1, type2);
-}
-
 bool accept_type(const TypePtr &req_type, const TypePtr &prov_type)
 {
 	static LambdaVisitor type_checker = {
@@ -84,8 +157,7 @@ int get_size(const TypePtr &type)
 {
 	static LambdaVisitor type_calculator = {
 		[](const std::monostate &t) { return 0; },
-		[](const auto &t)
-			{ return std::static_pointer_cast<const Type>(t)->size(); }
+		[](const auto &t) { return t->size(); }
 	};
 	return std::visit(type_calculator, type);
 }
@@ -100,45 +172,47 @@ int ArrayType::element_size() const
 	return std::visit(size_calculator, element_type());
 }
 
-ArrayType::ArrayType(TypePtr base_type, std::vector<int> dim_size)
-  : ArrayType(base_type, dim_size.begin(), dim_size.end())
+ArrayType::ArrayType(TypePtr ele_type, int len)
+  : _len(len), _ele_type(ele_type)
 { _size = _len * element_size(); }
 
-ArrayType::ArrayType(TypePtr base_type, std::vector<int>::iterator dim_begin,
-		std::vector<int>::iterator dim_end)
-{
-	if(dim_begin >= dim_end)
-		INTERNAL_ERROR("empty dimension array provided for ArrayType constructor");
-	if(!is_basic(base_type))
-		INTERNAL_ERROR("non-basic type provided for ArrayType constructor");
-	
-	_len = *dim_begin;
-	++dim_begin;
-	if(dim_begin != dim_end)
-		_ele_type = std::make_shared<ArrayType>(base_type, dim_begin, dim_end);
-	else
-		_ele_type = base_type;
-	_size = _len * element_size();
-}
-
 TypePtr make_null()
 {
-	static const auto NULL_TYPE_PTR = TypePtr(std::monostate());
-	return NULL_TYPE_PTR;
+	return TypePtr(std::monostate());
 }
 
 TypePtr make_void()
 {
-	static const auto VOID_TYPE_PTR = TypePtr(std::make_shared<VoidType>());
-			// the global void type pointers points to this pointer
-	return VOID_TYPE_PTR;
+	return TypeContext::global().void_type();
 }
 
 TypePtr make_int(bool is_const)
 {
-	static const auto CONST_INT_TYPE_PTR = TypePtr(std::make_shared<IntType>(true));
-	static const auto INT_TYPE_PTR = TypePtr(std::make_shared<IntType>(false));
-	return is_const? CONST_INT_TYPE_PTR : INT_TYPE_PTR;
+	return TypeContext::global().int_type(is_const);
+}
+
+TypePtr make_array(const TypePtr &base_type, const std::vector<int> &dim_size)
+{
+	if(dim_size.empty())
+		INTERNAL_ERROR("empty dimension array provided for make_array");
+	if(!is_basic(base_type))
+		INTERNAL_ERROR("non-basic type provided for make_array");
+
+	// Build from the innermost dimension.
+	TypePtr res = base_type;
+	for(auto iter = dim_size.rbegin(); iter != dim_size.rend(); ++iter)
+		res = TypeContext::global().array_type(res, *iter);
+	return res;
+}
+
+TypePtr make_pointer(const TypePtr &base_type)
+{
+	return TypeContext::global().pointer_type(base_type);
+}
+
+TypePtr make_func(const TypePtr &retval_type, const TypePtrVec &arg_types)
+{
+	return TypeContext::global().func_type(retval_type, arg_types);
 }
 
 void TypePrinter::operator() (const std::monostate &t)
@@ -2,7 +2,6 @@
 #define TYPE_H
 
 #include <iostream>
-#include <memory>
 #include <vector>
 #include <variant>
 
@@ -19,13 +18,33 @@ class ArrayType;
 class PointerType;
 class FuncType;
 
+// A handle of an interned type. Every distinct type is built only once by
+// the make_xxx functions below and is never freed, so handles are trivially
+// copyable, and two types are the same iff their handles are equal.
+template<class T>
+class TypeHandle
+{
+  protected:
+	const T *_ptr;
+
+  public:
+	TypeHandle(): _ptr(nullptr) {}
+	explicit TypeHandle(const T *ptr): _ptr(ptr) {}
+
+	inline const T *get() const { return _ptr; }
+	inline const T *operator -> () const { return _ptr; }
+	inline const T &operator * () const { return *_ptr; }
+	inline explicit operator bool () const { return _ptr != nullptr; }
+	inline bool operator == (const TypeHandle &other) const { return _ptr == other._ptr; }
+	inline bool operator != (const TypeHandle &other) const { return _ptr != other._ptr; }
+};
+
 // Type pointers.
-// They are std::shared_ptr's of the corresponding type classes.
-using VoidTypePtr = std::shared_ptr<VoidType>;
-using IntTypePtr = std::shared_ptr<IntType>;
-using ArrayTypePtr = std::shared_ptr<ArrayType>;
-using PointerTypePtr = std::shared_ptr<PointerType>;
-using FuncTypePtr = std::shared_ptr<FuncType>;
+using VoidTypePtr = TypeHandle<VoidType>;
+using IntTypePtr = TypeHandle<IntType>;
+using ArrayTypePtr = TypeHandle<ArrayType>;
+using PointerTypePtr = TypeHandle<PointerType>;
+using FuncTypePtr = TypeHandle<FuncType>;
 
 // The universal type pointer.
 using TypePtr = std::variant
@@ -41,16 +60,20 @@ using TypePtrVec = std::vector<TypePtr>;
 
 bool is_const(const TypePtr &type);
 bool is_basic(const TypePtr &type);
-bool same_type(const TypePtr &type1, const TypePtr &type2);
+inline bool same_type(const TypePtr &type1, const TypePtr &type2) { return type1 == type2; }
 bool accept_type(const TypePtr &req_type, const TypePtr &prov_type);
 bool can_operate(const TypePtr &type1, const TypePtr &type2);
 TypePtr common_type(const TypePtr &type1, const TypePtr &type2);
 int get_size(const TypePtr &type);
 
-// Handy constructors.
+// Handy constructors, returning the interned types.
 TypePtr make_null();
 TypePtr make_void();
 TypePtr make_int(bool is_const=false);
+// Array of base_type with the size of all dimensions, the outermost first.
+TypePtr make_array(const TypePtr &base_type, const std::vector<int> &dim_size);
+TypePtr make_pointer(const TypePtr &base_type);
+TypePtr make_func(const TypePtr &retval_type, const TypePtrVec &arg_types);
 
 class Type
 {
@@ -90,18 +113,13 @@ class ArrayType: public Type
   public:
 	int element_size() const;
 
-	// Build a array type given the size of all dimensions and a base_type.
-	ArrayType(TypePtr base_type, std::vector<int> dim_size);
-	ArrayType(TypePtr base_type, std::vector<int>::iterator dim_begin,
-		std::vector<int>::iterator dim_end);
+	// Use make_array() instead, which interns the type.
+	ArrayType(TypePtr ele_type, int len);
 
 	// Getters.
 	inline const TypePtr &element_type() const { return _ele_type; }
 	inline int len() const { return _len; }
 	inline bool is_1d_arr() const { return is_basic(element_type()); }
-
-	// Length setter.
-	inline void set_len(int len) { _len = len; }
 };
 
 /*
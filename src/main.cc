@@ -1,14 +1,25 @@
 #include <iostream>
 #include <fstream>
+#include <cstdio>
 #include <cstring>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
 #include "parser.tab.h"
 #include "semantic_checker.h"
 #include "ast_node_printer.h"
 #include "eeyore_gen.h"
 #include "eeyore_printer.h"
+#include "eeyore_interp.h"
 #include "tigger_gen.h"
 #include "tigger_printer.h"
 #include "riscv_printer.h"
+#include "output_writer.h"
+#include "thread_pool.h"
+#include "time_report.h"
 
 using namespace compiler;
 using namespace std;
@@ -17,107 +28,275 @@ using namespace std;
 
 enum class GenType
 {
-	EEYORE, TIGGER, RISCV
+	EEYORE, TIGGER, RISCV, RUN
 };
 struct MainArg
 {
 	GenType type;
 	char *input_filename;
 	char *output_filename;
+	char *batch_filename; // Batch mode, each line is "input_filename output_filename".
+	int thread_cnt; // Files in batch mode, or functions of the input otherwise.
+	bool time_report; // Print the time of each phase to stderr.
+	bool mem_report; // Also report the memory of each phase.
+	char *time_report_json_filename; // Write the time of each phase as json.
+	bool exec_report; // Print the dynamic statement counts in run mode.
 };
 
 MainArg parse_args(int argc, char *argv[])
 {
-	MainArg ret = {GenType::RISCV, nullptr, nullptr};
+	MainArg ret = {GenType::RISCV, nullptr, nullptr, nullptr, utils::ThreadPool::default_thread_cnt(),
+		false, false, nullptr, false};
 	for(int i = 1; i < argc; i++)
 	{
 		if(strcmp(argv[i], "-e") == 0) // eeyore mode
 			ret.type = GenType::EEYORE;
 		else if(strcmp(argv[i], "-t") == 0) // tigger mode
 			ret.type = GenType::TIGGER;
+		else if(strcmp(argv[i], "-r") == 0) // run the eeyore code
+			ret.type = GenType::RUN;
 		else if(strcmp(argv[i], "-o") == 0 && i < argc - 1) // set output file
 		{
 			ret.output_filename = argv[i + 1];
 			i++;
 		}
+		else if(strcmp(argv[i], "-b") == 0 && i < argc - 1) // set batch list file
+		{
+			ret.batch_filename = argv[i + 1];
+			i++;
+		}
+		else if(strcmp(argv[i], "-j") == 0 && i < argc - 1) // set thread count
+		{
+			ret.thread_cnt = max(atoi(argv[i + 1]), 1);
+			i++;
+		}
+		else if(strcmp(argv[i], "-ftime-report") == 0) // print phase times
+			ret.time_report = true;
+		else if(strcmp(argv[i], "-fmem-report") == 0) // print phase times and memory
+			ret.mem_report = true;
+		else if(strcmp(argv[i], "-ftime-report-json") == 0 && i < argc - 1) // write phase times
+		{
+			ret.time_report_json_filename = argv[i + 1];
+			i++;
+		}
+		else if(strcmp(argv[i], "-fexec-report") == 0) // print dynamic counts of run mode
+			ret.exec_report = true;
 		else // set input file
 			ret.input_filename = argv[i];
 	}
 	return ret;
 }
 
-int main(int argc, char *argv[])
+// Opens the output file, or stdout if no output file is given.
+unique_ptr<utils::OutputWriter> open_output(const char *output_filename)
 {
-	MainArg args = parse_args(argc, argv);
-	if(args.input_filename != nullptr)
-		set_input_file(args.input_filename);
+	if(output_filename == nullptr)
+		return make_unique<utils::OutputWriter>(1);
+	return make_unique<utils::OutputWriter>(output_filename);
+}
 
+// Compiles one input file (stdin if input_filename is nullptr). Nothing is
+// shared with the other compilations, so it can run on any thread. The
+// functions are compiled in parallel on pool, if it is not nullptr.
+// In run mode, the eeyore code is run on stdin, writing to the output file,
+// and the return value of main is stored in exit_code.
+// Returns the error message, or an empty string if succeeded.
+string compile(GenType type, const char *input_filename, const char *output_filename,
+	utils::ThreadPool *pool, int *exit_code = nullptr, bool exec_report = false)
+{
+	FILE *in = stdin;
+	if(input_filename != nullptr && (in = fopen(input_filename, "r")) == nullptr)
+		return string("cannot open input file ") + input_filename + "\n";
+	yyscan_t scanner = create_scanner(in);
+
+	string err;
 	try
 	{
-		// Syntax analysis.
+		// Syntax analysis. All the AST nodes live in ast_arena.
+		frontend::AstArena ast_arena;
 		frontend::AstPtr prog_node;
-		auto parser = yy::parser(prog_node);
-		parser.parse();
+		{
+			utils::TimeScope time_scope("parse");
+			auto parser = yy::parser(scanner, prog_node);
+			parser.parse();
+			utils::TimeReport::add_size("ast nodes", ast_arena.object_cnt());
+			utils::TimeReport::add_size("ast bytes", ast_arena.chunk_bytes());
+		}
 
 		// Semantic analysis.
-		frontend::SemanticChecker checker;
-		visit(checker, prog_node);
+		{
+			utils::TimeScope time_scope("semantic check");
+			frontend::SemanticChecker checker;
+			visit(checker, prog_node);
+		}
 		// cout << "after semantic analysis: " << endl;
 		// cout << prog_node << endl << endl;
 
 		// Eeyore generation.
 		backend::eeyore::EeyoreGenerator eeyore_gen;
+		// The phases below share objects, so each of them ends when the next
+		// one is emplaced.
+		std::optional<utils::TimeScope> time_scope(std::in_place, "eeyore gen");
 		const auto &eeyore_code = eeyore_gen.generate_eeyore(prog_node);
+		utils::TimeReport::add_size("eeyore statements", eeyore_code.size());
 
-		if(args.type == GenType::EEYORE)
+		if(type == GenType::EEYORE)
 		{
-			if(args.output_filename == nullptr)
-				cout << eeyore_code;
-			else
-			{
-				fstream outf(args.output_filename, fstream::out);
-				outf << eeyore_code;
-			}
-			return 0;
+			time_scope.emplace("print");
+			auto out = open_output(output_filename);
+			*out << eeyore_code;
+			out->flush();
 		}
-
-		backend::tigger::TiggerGenerator tigger_gen(eeyore_code, std::move(eeyore_gen.all_defined_vars()));
-		const auto &tigger_code = tigger_gen.generate_tigger();
-
-		if(args.output_filename == nullptr)
+		else if(type == GenType::RUN)
 		{
-			if(args.type == GenType::RISCV)
-				cout << riscv_mode;
-			else
-				cout << tigger_mode;
-			cout << tigger_code;
+			time_scope.emplace("run");
+			auto out = open_output(output_filename);
+			backend::eeyore::EeyoreInterpreter interpreter(eeyore_code, cin, *out);
+			int retval = interpreter.run();
+			out->flush();
+			if(exit_code != nullptr)
+				*exit_code = retval & 0xff;
+			interpreter.print_timers(cerr);
+			if(exec_report)
+				interpreter.print_stats(cerr);
 		}
 		else
 		{
-			fstream outf(args.output_filename, fstream::out);
-			if(args.type == GenType::RISCV)
-				outf << riscv_mode;
+			time_scope.emplace("tigger gen");
+			backend::tigger::TiggerGenerator tigger_gen(eeyore_code,
+				eeyore_gen.generated_funcs(), pool);
+			const auto &tigger_code = tigger_gen.generate_tigger();
+			utils::TimeReport::add_size("tigger statements", tigger_code.size());
+
+			time_scope.emplace("print");
+			auto out = open_output(output_filename);
+			if(type == GenType::RISCV)
+				backend::riscv::print_riscv(*out, tigger_code, pool);
 			else
-				outf << tigger_mode;
-			outf << tigger_code;
+				backend::tigger::print_tigger(*out, tigger_code, pool);
+			out->flush();
 		}
 	}
 	catch(utils::InternalError &e)
 	{
-		cerr << "error occurred!" << endl;
-		cerr << e.what() << endl;
-		return 1;
+		err = "error occurred!\n" + e.what() + "\n";
+	}
+	catch(utils::SyntaxError &e)
+	{
+		err = "syntax error!\n" + e.what() + "\n";
 	}
 	catch(frontend::SemanticChecker::SemanticError &e)
 	{
-		cerr << "semantic error!" << endl;
-		cerr << e.what() << endl;
-		return 1;
+		err = "semantic error!\n" + e.what() + "\n";
+	}
+	catch(backend::eeyore::EeyoreInterpreter::RuntimeError &e)
+	{
+		err = e.what() + "\n";
+	}
+	catch(utils::OutputWriter::OpenError &e)
+	{
+		err = e.what() + "\n";
 	}
 	catch(std::bad_optional_access &e)
 	{
-		cerr << e.what() << endl;
+		err = string(e.what()) + "\n";
+	}
+
+	destroy_scanner(scanner);
+	if(in != stdin)
+		fclose(in);
+	return err;
+}
+
+// Compiles all the files listed in the batch file on a thread pool, and
+// reports the errors in order and the aggregate throughput. The files are
+// already compiled in parallel, so each of them is compiled sequentially.
+int compile_batch(const MainArg &args)
+{
+	vector<pair<string, string>> jobs; // (input, output)
+	ifstream fin(args.batch_filename);
+	if(!fin)
+	{
+		cerr << "cannot open batch file " << args.batch_filename << endl;
 		return 1;
 	}
-	return 0;
+	for(string input, output; fin >> input >> output; )
+		jobs.emplace_back(move(input), move(output));
+
+	size_t input_size = 0;
+	for(const auto &job : jobs)
+	{
+		struct stat st;
+		if(stat(job.first.c_str(), &st) == 0)
+			input_size += st.st_size;
+	}
+
+	vector<string> errs(jobs.size());
+	auto start_time = chrono::steady_clock::now();
+	utils::ThreadPool pool(args.thread_cnt);
+	pool.parallel_for(jobs.size(), [&](int i) {
+		errs[i] = compile(args.type, jobs[i].first.c_str(), jobs[i].second.c_str(), nullptr);
+	});
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+
+	int fail_cnt = 0;
+	for(size_t i = 0; i < jobs.size(); i++)
+		if(!errs[i].empty())
+		{
+			cerr << jobs[i].first << ": " << errs[i];
+			fail_cnt++;
+		}
+	cerr << "compiled " << jobs.size() << " files (" << fail_cnt << " failed) with "
+		<< pool.thread_cnt() << " threads in " << seconds << " s: "
+		<< jobs.size() / seconds << " files/s, "
+		<< input_size / seconds / (1 << 20) << " MiB/s" << endl;
+	return fail_cnt == 0? 0 : 1;
+}
+
+// Prints the time report to stderr and/or the json file, if required.
+void print_time_report(const MainArg &args)
+{
+	if(args.time_report || args.mem_report)
+		utils::TimeReport::global().print(cerr);
+	if(args.time_report_json_filename != nullptr)
+	{
+		ofstream fout(args.time_report_json_filename);
+		if(!fout)
+			cerr << "cannot open time report file " << args.time_report_json_filename << endl;
+		else
+			utils::TimeReport::global().print_json(fout);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	MainArg args = parse_args(argc, argv);
+	if(args.mem_report)
+		utils::TimeReport::enable_mem();
+	else if(args.time_report || args.time_report_json_filename != nullptr)
+		utils::TimeReport::enable();
+
+	int ret = 0;
+	if(args.batch_filename != nullptr && args.type == GenType::RUN)
+	{
+		cerr << "cannot run the files of a batch" << endl;
+		ret = 1;
+	}
+	else if(args.batch_filename != nullptr)
+		ret = compile_batch(args);
+	else
+	{
+		unique_ptr<utils::ThreadPool> pool;
+		if(args.thread_cnt > 1)
+			pool = make_unique<utils::ThreadPool>(args.thread_cnt);
+		string err = compile(args.type, args.input_filename, args.output_filename, pool.get(),
+			&ret, args.exec_report);
+		if(!err.empty())
+		{
+			cerr << err;
+			ret = 1;
+		}
+	}
+	print_time_report(args);
+	return ret;
 }
@@ -0,0 +1,76 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace compiler::utils
+{
+
+// A bump allocator. Objects are allocated in large chunks and freed all
+// together when the arena is destroyed, when the destructors of the
+// non-trivially destructible ones are called in reverse order of creation.
+class Arena
+{
+  public:
+	static constexpr size_t CHUNK_SIZE = 64 << 10;
+
+  protected:
+	std::vector<std::unique_ptr<std::byte[]>> _chunks;
+	std::byte *_curr = nullptr;
+	size_t _remain = 0;
+	std::vector<std::pair<void *, void (*)(void *)>> _dtors;
+	size_t _object_cnt = 0;
+	size_t _chunk_bytes = 0;
+
+	void *_allocate(size_t size, size_t align)
+	{
+		size_t padding = (align - reinterpret_cast<uintptr_t>(_curr) % align) % align;
+		if(padding + size > _remain)
+		{
+			size_t chunk_size = std::max(CHUNK_SIZE, size + align);
+			_chunks.emplace_back(new std::byte[chunk_size]);
+			_chunk_bytes += chunk_size;
+			_curr = _chunks.back().get();
+			_remain = chunk_size;
+			padding = (align - reinterpret_cast<uintptr_t>(_curr) % align) % align;
+		}
+		void *res = _curr + padding;
+		_curr += padding + size;
+		_remain -= padding + size;
+		return res;
+	}
+
+  public:
+	Arena() = default;
+	Arena(const Arena &other) = delete;
+	Arena &operator = (const Arena &other) = delete;
+	~Arena()
+	{
+		for(auto iter = _dtors.rbegin(); iter != _dtors.rend(); ++iter)
+			iter->second(iter->first);
+	}
+
+	template<class T, class... Ts>
+	T *make(Ts&&... ts)
+	{
+		T *res = new(_allocate(sizeof(T), alignof(T))) T(std::forward<Ts>(ts)...);
+		if constexpr(!std::is_trivially_destructible_v<T>)
+			_dtors.emplace_back(res, [](void *ptr) { static_cast<T *>(ptr)->~T(); });
+		_object_cnt++;
+		return res;
+	}
+
+	inline size_t object_cnt() const { return _object_cnt; }
+	inline size_t chunk_bytes() const { return _chunk_bytes; }
+};
+
+} // namespace compiler::utils
+
+#endif
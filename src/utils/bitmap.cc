@@ -1,9 +1,244 @@
 #include "bitmap.h"
 #include "exceptions.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BITMAP_HAS_AVX2_PATH
+#endif
+
+namespace
+{
+
+using Word = compiler::utils::Bitmap::Word;
+
+// Kernels of the bulk operations. All of them work on n words.
+struct BitmapKernels
+{
+	size_t (*cnt)(const Word *src, size_t n);
+	bool (*any)(const Word *src, size_t n);
+	bool (*union_with)(Word *dst, const Word *src, size_t n);
+	void (*intersect_with)(Word *dst, const Word *src, size_t n);
+	void (*diff_with)(Word *dst, const Word *src, size_t n);
+	bool (*assign_transfer)(Word *dst, const Word *gen, const Word *in,
+		const Word *kill, size_t n);
+};
+
+// scalar kernels
+
+size_t cnt_scalar(const Word *src, size_t n)
+{
+	size_t res = 0;
+	for(size_t i = 0; i < n; i++)
+		res += __builtin_popcountll(src[i]);
+	return res;
+}
+
+bool any_scalar(const Word *src, size_t n)
+{
+	Word res = 0;
+	for(size_t i = 0; i < n; i++)
+		res |= src[i];
+	return res != 0;
+}
+
+bool union_with_scalar(Word *dst, const Word *src, size_t n)
+{
+	Word changed = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		Word data = dst[i] | src[i];
+		changed |= data ^ dst[i];
+		dst[i] = data;
+	}
+	return changed != 0;
+}
+
+void intersect_with_scalar(Word *dst, const Word *src, size_t n)
+{
+	for(size_t i = 0; i < n; i++)
+		dst[i] &= src[i];
+}
+
+void diff_with_scalar(Word *dst, const Word *src, size_t n)
+{
+	for(size_t i = 0; i < n; i++)
+		dst[i] &= ~src[i];
+}
+
+bool assign_transfer_scalar(Word *dst, const Word *gen, const Word *in,
+	const Word *kill, size_t n)
+{
+	Word changed = 0;
+	for(size_t i = 0; i < n; i++)
+	{
+		Word data = gen[i] | (in[i] & ~kill[i]);
+		changed |= data ^ dst[i];
+		dst[i] = data;
+	}
+	return changed != 0;
+}
+
+const BitmapKernels SCALAR_KERNELS = {
+	cnt_scalar, any_scalar, union_with_scalar, intersect_with_scalar,
+	diff_with_scalar, assign_transfer_scalar
+};
+
+#ifdef BITMAP_HAS_AVX2_PATH
+
+// AVX2 kernels. Each of them handles 4 words at a time, and falls back to the
+// scalar kernel for the remaining words.
+
+#define AVX2_TARGET __attribute__((target("avx2,popcnt")))
+
+AVX2_TARGET size_t cnt_avx2(const Word *src, size_t n)
+{
+	// There is no vector popcount in AVX2, but the popcnt instruction is
+	// available on every cpu that supports AVX2.
+	size_t res0 = 0, res1 = 0, res2 = 0, res3 = 0, i = 0;
+	for( ; i + 4 <= n; i += 4)
+	{
+		res0 += __builtin_popcountll(src[i]);
+		res1 += __builtin_popcountll(src[i + 1]);
+		res2 += __builtin_popcountll(src[i + 2]);
+		res3 += __builtin_popcountll(src[i + 3]);
+	}
+	for( ; i < n; i++)
+		res0 += __builtin_popcountll(src[i]);
+	return res0 + res1 + res2 + res3;
+}
+
+AVX2_TARGET bool any_avx2(const Word *src, size_t n)
+{
+	size_t i = 0;
+	__m256i res = _mm256_setzero_si256();
+	for( ; i + 4 <= n; i += 4)
+		res = _mm256_or_si256(res,
+			_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)));
+	return !_mm256_testz_si256(res, res) || any_scalar(src + i, n - i);
+}
+
+AVX2_TARGET bool union_with_avx2(Word *dst, const Word *src, size_t n)
+{
+	size_t i = 0;
+	__m256i changed = _mm256_setzero_si256();
+	for( ; i + 4 <= n; i += 4)
+	{
+		auto dst_ptr = reinterpret_cast<__m256i *>(dst + i);
+		__m256i prev = _mm256_loadu_si256(dst_ptr);
+		__m256i data = _mm256_or_si256(prev,
+			_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)));
+		changed = _mm256_or_si256(changed, _mm256_xor_si256(data, prev));
+		_mm256_storeu_si256(dst_ptr, data);
+	}
+	bool tail_changed = union_with_scalar(dst + i, src + i, n - i);
+	return !_mm256_testz_si256(changed, changed) || tail_changed;
+}
+
+AVX2_TARGET void intersect_with_avx2(Word *dst, const Word *src, size_t n)
+{
+	size_t i = 0;
+	for( ; i + 4 <= n; i += 4)
+	{
+		auto dst_ptr = reinterpret_cast<__m256i *>(dst + i);
+		_mm256_storeu_si256(dst_ptr, _mm256_and_si256(_mm256_loadu_si256(dst_ptr),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i))));
+	}
+	intersect_with_scalar(dst + i, src + i, n - i);
+}
+
+AVX2_TARGET void diff_with_avx2(Word *dst, const Word *src, size_t n)
+{
+	size_t i = 0;
+	for( ; i + 4 <= n; i += 4)
+	{
+		auto dst_ptr = reinterpret_cast<__m256i *>(dst + i);
+		// andnot(a, b) = ~a & b
+		_mm256_storeu_si256(dst_ptr, _mm256_andnot_si256(
+			_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i)),
+			_mm256_loadu_si256(dst_ptr)));
+	}
+	diff_with_scalar(dst + i, src + i, n - i);
+}
+
+AVX2_TARGET bool assign_transfer_avx2(Word *dst, const Word *gen, const Word *in,
+	const Word *kill, size_t n)
+{
+	size_t i = 0;
+	__m256i changed = _mm256_setzero_si256();
+	for( ; i + 4 <= n; i += 4)
+	{
+		auto dst_ptr = reinterpret_cast<__m256i *>(dst + i);
+		__m256i live = _mm256_andnot_si256(
+			_mm256_loadu_si256(reinterpret_cast<const __m256i *>(kill + i)),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)));
+		__m256i data = _mm256_or_si256(live,
+			_mm256_loadu_si256(reinterpret_cast<const __m256i *>(gen + i)));
+		changed = _mm256_or_si256(changed,
+			_mm256_xor_si256(data, _mm256_loadu_si256(dst_ptr)));
+		_mm256_storeu_si256(dst_ptr, data);
+	}
+	bool tail_changed = assign_transfer_scalar(dst + i, gen + i, in + i, kill + i, n - i);
+	return !_mm256_testz_si256(changed, changed) || tail_changed;
+}
+
+#undef AVX2_TARGET
+
+const BitmapKernels AVX2_KERNELS = {
+	cnt_avx2, any_avx2, union_with_avx2, intersect_with_avx2,
+	diff_with_avx2, assign_transfer_avx2
+};
+
+#endif // BITMAP_HAS_AVX2_PATH
+
+using Isa = compiler::utils::Bitmap::Isa;
+
+Isa best_isa()
+{
+#ifdef BITMAP_HAS_AVX2_PATH
+	__builtin_cpu_init(); // Required since this runs in static initialization.
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt"))
+		return Isa::AVX2;
+#endif
+	return Isa::SCALAR;
+}
+
+const BitmapKernels *kernels_of(Isa isa)
+{
+#ifdef BITMAP_HAS_AVX2_PATH
+	if(isa == Isa::AVX2)
+		return &AVX2_KERNELS;
+#endif
+	return &SCALAR_KERNELS;
+}
+
+Isa curr_isa = best_isa();
+const BitmapKernels *kernels = kernels_of(curr_isa);
+
+} // namespace
+
 namespace compiler::utils
 {
 
+Bitmap::Isa Bitmap::isa() { return curr_isa; }
+
+bool Bitmap::isa_supported(Isa isa)
+{
+	return isa == Isa::SCALAR || best_isa() == Isa::AVX2;
+}
+
+void Bitmap::set_isa(Isa isa)
+{
+	INTERNAL_ASSERT(isa_supported(isa), "setting bitmap isa to an unsupported one");
+	curr_isa = isa;
+	kernels = kernels_of(isa);
+}
+
+void Bitmap::_clear_tail()
+{
+	if(_size & 63)
+		_bits.back() &= _bit_of(_size) - 1;
+}
+
 void Bitmap::clear()
 {
 	for(auto &data : _bits)
@@ -12,40 +247,45 @@ void Bitmap::clear()
 
 size_t Bitmap::cnt() const
 {
-	size_t res = 0;
-	for(int i = 0; i < _size; i++)
-		res += get(i);
-	return res;
+	return kernels->cnt(_bits.data(), _bits.size());
+}
+
+bool Bitmap::any() const
+{
+	return kernels->any(_bits.data(), _bits.size());
 }
 
 void Bitmap::flip_all()
 {
 	for(auto &data : _bits)
 		data = ~data;
+	_clear_tail();
 }
 
-void Bitmap::union_with(const Bitmap &other)
+bool Bitmap::union_with(const Bitmap &other)
 {
 	INTERNAL_ASSERT(other.size() == size(), "invalid union operation on different sized bitmap");
-	size_t data_cnt = _bits.size();
-	for(size_t i = 0; i < data_cnt; i++)
-		_bits.at(i) |= other._bits.at(i);
+	return kernels->union_with(_bits.data(), other._bits.data(), _bits.size());
 }
 
 void Bitmap::intersect_with(const Bitmap &other)
 {
-	INTERNAL_ASSERT(other.size() == size(), "invalid union operation on different sized bitmap");
-	size_t data_cnt = _bits.size();
-	for(size_t i = 0; i < data_cnt; i++)
-		_bits.at(i) &= other._bits.at(i);
+	INTERNAL_ASSERT(other.size() == size(), "invalid intersect operation on different sized bitmap");
+	kernels->intersect_with(_bits.data(), other._bits.data(), _bits.size());
 }
 
 void Bitmap::diff_with(const Bitmap &other)
 {
-	INTERNAL_ASSERT(other.size() == size(), "invalid union operation on different sized bitmap");
-	size_t data_cnt = _bits.size();
-	for(size_t i = 0; i < data_cnt; i++)
-		_bits.at(i) &= ~(other._bits.at(i));
+	INTERNAL_ASSERT(other.size() == size(), "invalid diff operation on different sized bitmap");
+	kernels->diff_with(_bits.data(), other._bits.data(), _bits.size());
 }
 
-}
\ No newline at end of file
+bool Bitmap::assign_transfer(const Bitmap &gen, const Bitmap &in, const Bitmap &kill)
+{
+	INTERNAL_ASSERT(gen.size() == size() && in.size() == size() && kill.size() == size(),
+		"invalid transfer operation on different sized bitmap");
+	return kernels->assign_transfer(_bits.data(), gen._bits.data(), in._bits.data(),
+		kill._bits.data(), _bits.size());
+}
+
+}
@@ -1,6 +1,7 @@
 #ifndef BITMAP_H
 #define BITMAP_H
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <unordered_map>
@@ -8,46 +9,75 @@
 namespace compiler::utils
 {
 
+// A fixed-size bitset stored in 64-bit words. Bulk operations are dispatched
+// at runtime to an AVX2 implementation when the cpu supports it, otherwise a
+// scalar implementation is used. Bits beyond size() in the last word are
+// always kept 0, so that cnt() and the iteration functions need no masking.
 class Bitmap
 {
+  public:
+	using Word = uint64_t;
+
+	// The instruction set used by the bulk operations.
+	enum class Isa { SCALAR, AVX2 };
+	static Isa isa();
+	static bool isa_supported(Isa isa);
+	static void set_isa(Isa isa); // Mainly for benchmarking.
+
   protected:
-	std::vector<uint32_t> _bits;
+	std::vector<Word> _bits;
 	size_t _size;
 
-	inline static size_t _ceil_div32(size_t x) { return (x + 31) >> 5; }
-	inline static size_t _div32(size_t x) { return x >> 5; }
-	inline static int _remain_div32(size_t x) { return static_cast<int>(x & 31); }
+	inline static size_t _ceil_div64(size_t x) { return (x + 63) >> 6; }
+	inline static size_t _div64(size_t x) { return x >> 6; }
+	inline static Word _bit_of(size_t x) { return Word(1) << (x & 63); }
+	void _clear_tail();
 
   public:
-	Bitmap() = default;
+	Bitmap(): _size(0) {}
 	Bitmap(int size)
-	  : _bits(_ceil_div32(size), 0), _size(size) {}
+	  : _bits(_ceil_div64(size), 0), _size(size) {}
 
 	inline size_t size() const { return _size; }
-	inline void resize(size_t size) // Note: we do not set the newly added bits to 0.
-		{ _bits.resize(_ceil_div32(size)); _size = size; }
+	inline size_t bytes() const { return _bits.capacity() * sizeof(Word); }
+	inline void resize(size_t size) // Newly added bits are set to 0.
+		{ _bits.resize(_ceil_div64(size), 0); _size = size; _clear_tail(); }
 
 	// getters & setters
 	inline bool get(size_t idx) const
-		{ return (_bits.at(_div32(idx)) >> _remain_div32(idx)) & 1; }
+		{ return (_bits[_div64(idx)] & _bit_of(idx)) != 0; }
 	inline void set(size_t idx)
-		{ _bits.at(_div32(idx)) |= 1 << _remain_div32(idx); }
+		{ _bits[_div64(idx)] |= _bit_of(idx); }
 	inline void reset(size_t idx)
-		{ _bits.at(_div32(idx)) &= ~(1 << _remain_div32(idx)); }
+		{ _bits[_div64(idx)] &= ~_bit_of(idx); }
 	inline void set(size_t idx, bool val)
 		{ val? set(idx): reset(idx); }
-	
+
 	// unary operations
 	void clear();
 	size_t cnt() const;
+	bool any() const;
 	inline void flip(size_t idx)
-		{ _bits.at(_div32(idx)) ^= 1 << _remain_div32(idx); }
+		{ _bits[_div64(idx)] ^= _bit_of(idx); }
 	void flip_all();
 
 	// binary operations
-	void union_with(const Bitmap &other);
+	bool union_with(const Bitmap &other); // Returns if any bit is changed.
 	void intersect_with(const Bitmap &other);
 	void diff_with(const Bitmap &other);
+
+	// Fused dataflow transfer function: *this = gen | (in & ~kill).
+	// Returns if any bit is changed.
+	bool assign_transfer(const Bitmap &gen, const Bitmap &in, const Bitmap &kill);
+
+	// Calls func(idx) for each set bit, in increasing order of idx.
+	template<class Func>
+	void for_each_set_bit(Func &&func) const
+	{
+		for(size_t i = 0; i < _bits.size(); i++)
+			for(Word data = _bits[i]; data != 0; data &= data - 1)
+				func((i << 6) + __builtin_ctzll(data));
+	}
 };
 
 // For simplicity, Key cannot be size_t type, otherwise it cannot compile.
@@ -69,13 +99,24 @@ class NamedBitmap: public Bitmap
 	// For simplicity, a NamedBitmap cannot change its size after constructed.
 	inline void resize(size_t size) = delete;
 
+	using Bitmap::get;
+	using Bitmap::set;
+	using Bitmap::reset;
+
 	// Getters & setters can be indexed using a key.
 	inline bool get(const Key &key) const { return get(_key_to_idx.at(key)); }
 	inline void set(const Key &key) { set(_key_to_idx.at(key)); }
 	inline void reset(const Key &key) { reset(_key_to_idx.at(key)); }
 	inline void set(const Key &key, bool val) { set(_key_to_idx.at(key), val); }
+
+	inline const Key &key(size_t idx) const { return _keys[idx]; }
+
+	// Calls func(key) for each set bit, in increasing order of index.
+	template<class Func>
+	void for_each_set_key(Func &&func) const
+		{ for_each_set_bit([&, this](size_t idx) { func(_keys[idx]); }); }
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -49,10 +49,10 @@ class CompilerErrorBase
 };
 
 // const char _LEXICAL_ERROR_NAME[] = "Lexical error";
-// const char _SYNTAX_ERROR_NAME[] = "Syntax error";
+inline const char _SYNTAX_ERROR_NAME[] = "Syntax error";
 
 // using LexicalError = CompilerErrorBase<_LEXICAL_ERROR_NAME>; // lexer error
-// using SyntaxError = CompilerErrorBase<_SYNTAX_ERROR_NAME>; // parser error
+using SyntaxError = CompilerErrorBase<_SYNTAX_ERROR_NAME>; // parser error
 
 } // namespace compiler::utils
 
@@ -0,0 +1,96 @@
+#include <cstdlib>
+#include <new>
+#include <malloc.h>
+#include <sys/resource.h>
+#include "mem_report.h"
+
+namespace
+{
+
+// Zero-initialized and trivial, so that it can be used by operator new
+// before anything is constructed.
+thread_local compiler::utils::AllocCounters counters;
+
+} // namespace
+
+namespace compiler::utils
+{
+
+bool alloc_counting_enabled()
+{
+#ifdef MEM_REPORT
+	return true;
+#else
+	return false;
+#endif
+}
+
+AllocCounters &thread_alloc_counters()
+{
+	return counters;
+}
+
+size_t peak_rss_bytes()
+{
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return size_t(usage.ru_maxrss) * 1024; // In KiB on Linux.
+}
+
+} // namespace compiler::utils
+
+#ifdef MEM_REPORT
+
+// Only the basic forms are replaced, the others (array, nothrow and sized)
+// of the standard library call these.
+
+namespace
+{
+
+inline void *count_alloc(void *ptr)
+{
+	if(ptr == nullptr)
+		throw std::bad_alloc();
+	int64_t size = malloc_usable_size(ptr);
+	counters.alloc_cnt++;
+	counters.alloc_bytes += size;
+	counters.live_bytes += size;
+	if(counters.live_bytes > counters.peak_live_bytes)
+		counters.peak_live_bytes = counters.live_bytes;
+	return ptr;
+}
+
+inline void count_free(void *ptr)
+{
+	if(ptr == nullptr)
+		return;
+	counters.live_bytes -= malloc_usable_size(ptr);
+	std::free(ptr);
+}
+
+} // namespace
+
+void *operator new(size_t size)
+{
+	return count_alloc(std::malloc(size == 0? 1 : size));
+}
+
+void *operator new(size_t size, std::align_val_t align)
+{
+	// The size of aligned_alloc must be a multiple of the alignment.
+	size_t align_val = static_cast<size_t>(align);
+	size = (size + align_val - 1) / align_val * align_val;
+	return count_alloc(std::aligned_alloc(align_val, size == 0? align_val : size));
+}
+
+void operator delete(void *ptr) noexcept
+{
+	count_free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t align) noexcept
+{
+	count_free(ptr);
+}
+
+#endif
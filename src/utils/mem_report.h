@@ -0,0 +1,33 @@
+#ifndef MEM_REPORT_H
+#define MEM_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace compiler::utils
+{
+
+// The allocations made by a thread, counted by the global operator new and
+// delete when built with MEM_REPORT (make MEM_REPORT=1). The bytes are the
+// usable sizes of the malloc blocks. Memory freed by another thread is
+// subtracted from the live bytes of that thread, so only the sums over all
+// threads are exact.
+struct AllocCounters
+{
+	uint64_t alloc_cnt;
+	uint64_t alloc_bytes;
+	int64_t live_bytes;
+	int64_t peak_live_bytes; // The maximum of live_bytes since it is last
+							 // lowered by the reader.
+};
+
+// Whether the allocations are counted, i.e. built with MEM_REPORT.
+bool alloc_counting_enabled();
+AllocCounters &thread_alloc_counters();
+
+// The maximum resident set size of the process so far.
+size_t peak_rss_bytes();
+
+} // namespace compiler::utils
+
+#endif
@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include "output_writer.h"
+#include "exceptions.h"
+
+namespace compiler::utils
+{
+
+OutputWriter::OutputWriter()
+  : _fd(-1), _own_fd(false), _buf(INITIAL_MEMORY_SIZE), _len(0) {}
+
+OutputWriter::OutputWriter(int fd)
+  : _fd(fd), _own_fd(false), _buf(BUFFER_SIZE), _len(0) {}
+
+OutputWriter::OutputWriter(const char *filename)
+  : _own_fd(true), _buf(BUFFER_SIZE), _len(0)
+{
+	_fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(_fd == -1)
+		throw OpenError(std::string("cannot open output file ") + filename + ": " + std::strerror(errno));
+}
+
+OutputWriter::~OutputWriter()
+{
+	// Errors can not be reported here, call flush() explicitly to check them.
+	try { flush(); } catch(...) {}
+	if(_own_fd)
+		close(_fd);
+}
+
+// Writes all the data to _fd, retrying on partial writes.
+void OutputWriter::_write_fd(const char *data, size_t size)
+{
+	while(size > 0)
+	{
+		ssize_t res = write(_fd, data, size);
+		if(res == -1 && errno == EINTR)
+			continue;
+		INTERNAL_ASSERT(res != -1, "failed to write the output");
+		data += res;
+		size -= res;
+	}
+}
+
+void OutputWriter::_append_slow(const char *data, size_t size)
+{
+	if(_fd == -1) // In-memory writer, simply grow the buffer.
+	{
+		_buf.resize(std::max(_buf.size() * 2, _len + size));
+		std::memcpy(_buf.data() + _len, data, size);
+		_len += size;
+		return;
+	}
+
+	// Write the buffer and the new data together by a single writev call,
+	// so that the data is never copied into the buffer.
+	iovec iov[2] = {{_buf.data(), _len}, {const_cast<char *>(data), size}};
+	ssize_t res;
+	do
+		res = writev(_fd, iov, 2);
+	while(res == -1 && errno == EINTR);
+	INTERNAL_ASSERT(res != -1, "failed to write the output");
+
+	// Partial write, write the rest one by one.
+	size_t written = res;
+	if(written < _len)
+	{
+		_write_fd(_buf.data() + written, _len - written);
+		written = _len;
+	}
+	_write_fd(data + (written - _len), size - (written - _len));
+	_len = 0;
+}
+
+void OutputWriter::flush()
+{
+	if(_fd == -1 || _len == 0)
+		return;
+	_write_fd(_buf.data(), _len);
+	_len = 0;
+}
+
+} // namespace compiler::utils
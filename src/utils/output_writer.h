@@ -0,0 +1,97 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace compiler::utils
+{
+
+// A buffered writer for the generated code, which replaces std::ostream in
+// the printers. Numbers are formatted by std::to_chars, and the buffer is
+// written to the file descriptor by a single write/writev call only when it
+// is full, or when flush() is called (also by the destructor).
+// A writer constructed without file descriptor keeps everything in memory,
+// which can be read by view().
+class OutputWriter
+{
+  public:
+	// The output file cannot be opened, a user error rather than an internal one.
+	class OpenError
+	{
+	  protected:
+		std::string _what;
+
+	  public:
+		OpenError(const std::string &what_arg): _what(what_arg) {}
+		std::string what() const { return _what; }
+	};
+
+	static constexpr size_t BUFFER_SIZE = 1 << 20;
+	static constexpr size_t INITIAL_MEMORY_SIZE = 256;
+
+  protected:
+	int _fd; // -1 for in-memory writer.
+	bool _own_fd;
+	std::vector<char> _buf;
+	size_t _len;
+
+	void _write_fd(const char *data, size_t size);
+	void _append_slow(const char *data, size_t size);
+	inline void _append(const char *data, size_t size)
+	{
+		if(_len + size > _buf.size())
+			_append_slow(data, size);
+		else
+		{
+			std::memcpy(_buf.data() + _len, data, size);
+			_len += size;
+		}
+	}
+	template<class Int>
+	inline void _append_int(Int val)
+	{
+		char str[24];
+		auto res = std::to_chars(str, str + sizeof(str), val);
+		_append(str, res.ptr - str);
+	}
+
+  public:
+	OutputWriter(); // In-memory writer.
+	OutputWriter(int fd); // Does not close fd.
+	OutputWriter(const char *filename); // Opens (and truncates) the file, throws OpenError.
+	OutputWriter(const OutputWriter &other) = delete;
+	OutputWriter &operator = (const OutputWriter &other) = delete;
+	~OutputWriter();
+
+	void flush();
+	inline std::string_view view() const { return std::string_view(_buf.data(), _len); }
+
+	inline OutputWriter &operator << (char ch)
+	{
+		if(_len == _buf.size())
+			_append_slow(&ch, 1);
+		else
+			_buf[_len++] = ch;
+		return *this;
+	}
+	inline OutputWriter &operator << (std::string_view str)
+		{ _append(str.data(), str.size()); return *this; }
+	inline OutputWriter &operator << (const char *str)
+		{ _append(str, std::strlen(str)); return *this; }
+	inline OutputWriter &operator << (const std::string &str)
+		{ _append(str.data(), str.size()); return *this; }
+	inline OutputWriter &operator << (int val)
+		{ _append_int(val); return *this; }
+	inline OutputWriter &operator << (long val)
+		{ _append_int(val); return *this; }
+	inline OutputWriter &operator << (unsigned long val)
+		{ _append_int(val); return *this; }
+};
+
+} // namespace compiler::utils
+
+#endif
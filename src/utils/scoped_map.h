@@ -0,0 +1,116 @@
+#ifndef SCOPED_MAP_H
+#define SCOPED_MAP_H
+
+#include <unordered_map>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "exceptions.h"
+
+namespace compiler::utils
+{
+
+// Base class of symbol table. A map with nested blocks, where a key inserted
+// in an inner block shadows the same key in the outer ones.
+//
+// Every key is hashed only once into a slot, which points to the innermost
+// entry of the key. Each entry links to the entry it shadows, so the lookup
+// is a single hash probe regardless of the nesting depth. The entries are
+// stored in insertion order, which doubles as the undo log: end_block() pops
+// the entries of the block and restores what they shadowed.
+template<class TKey, class TVal>
+class ScopedMap
+{
+  protected:
+	struct Entry
+	{
+		TVal val;
+		int slot;
+		int shadowed; // The entry shadowed by this one, -1 if none.
+		int depth; // The block that contains this entry.
+	};
+
+	std::unordered_map<TKey, int> _slot_of_key;
+	std::vector<int> _innermost; // Innermost entry of each slot, -1 if none.
+	std::vector<Entry> _entries;
+	std::vector<int> _block_begin; // Entry count when each block begins.
+
+	int _slot_of(const TKey &key)
+	{
+		auto [iter, inserted] = _slot_of_key.try_emplace(key, _innermost.size());
+		if(inserted)
+			_innermost.push_back(-1);
+		return iter->second;
+	}
+	inline int _depth() const { return static_cast<int>(_block_begin.size()) - 1; }
+
+  public:
+	ScopedMap() { new_block(); }
+
+	// Empty is an invalid state for ScopedMap, since the insertion operation
+	// requires at least one block.
+	inline bool empty() const { return _block_begin.empty(); }
+
+	// Adding & removing a block at the end.
+	inline void new_block() { _block_begin.push_back(_entries.size()); }
+	void end_block()
+	{
+		if(empty())
+			INTERNAL_ERROR("no block to end for scoped map");
+		for(int i = _entries.size() - 1; i >= _block_begin.back(); i--)
+			_innermost[_entries[i].slot] = _entries[i].shadowed;
+		_entries.erase(_entries.begin() + _block_begin.back(), _entries.end());
+		_block_begin.pop_back();
+	}
+
+	// Searching & inserting operations.
+	const TVal *basic_find(const TKey &key) const
+	{
+		auto iter = _slot_of_key.find(key);
+		if(iter == _slot_of_key.end() || _innermost[iter->second] == -1)
+			return nullptr;
+		return &_entries[_innermost[iter->second]].val;
+	}
+	TVal *basic_find(const TKey &key)
+	{
+		return const_cast<TVal *>(std::as_const(*this).basic_find(key));
+	}
+
+	std::optional<TVal> find(const TKey &key) const
+	{
+		const TVal *find_res = basic_find(key);
+		if(find_res != nullptr)
+			return *find_res;
+		else
+			return std::nullopt;
+	}
+
+	// Returns: the inserted value (or the existing one in the current block)
+	// + whether the insertion is successful. The pointer is only valid until
+	// the next insertion.
+	std::pair<TVal *, bool> basic_insert(const TKey &key, TVal val)
+	{
+		if(empty())
+			INTERNAL_ERROR("cannot insert element to an empty scoped map");
+		int slot = _slot_of(key);
+		int shadowed = _innermost[slot];
+		if(shadowed != -1 && _entries[shadowed].depth == _depth())
+			return {&_entries[shadowed].val, false};
+		_innermost[slot] = _entries.size();
+		_entries.push_back(Entry{std::move(val), slot, shadowed, _depth()});
+		return {&_entries.back().val, true};
+	}
+	inline std::pair<TVal *, bool> basic_insert(const std::pair<TKey, TVal> &key_val_pair)
+	{
+		return basic_insert(key_val_pair.first, key_val_pair.second);
+	}
+
+	inline bool insert(const TKey &key, TVal val)
+	{
+		return basic_insert(key, std::move(val)).second;
+	}
+};
+
+} // namespace compiler::utils
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef STMT_LIST_H
+#define STMT_LIST_H
+
+#include <iterator>
+#include <vector>
+#include "exceptions.h"
+
+namespace compiler::utils
+{
+
+// A list of statements stored contiguously in a vector. The order of the
+// statements is kept by index links, so insertion and erasure at any position
+// is O(1) and never invalidates iterators of other statements. An erased
+// statement is only unlinked and left as a tombstone until compact().
+//
+// The list is compact if its statements are stored in order without
+// tombstones, which is the case if it is only appended. Then the index of a
+// statement is its position in the list, and is used as the statement id.
+template<class T>
+class StmtList
+{
+  protected:
+	static constexpr int NIL = -1; // The link of the first/last statement.
+	static constexpr int DEAD = -2; // The links of a tombstone.
+
+	std::vector<T> _stmts;
+	std::vector<int> _prev;
+	std::vector<int> _next;
+	int _head;
+	int _tail;
+	int _size;
+	bool _compact; // Whether the statements are stored in order, without tombstones.
+
+	// Links the last stored statement before pos.
+	int _link_before(int pos)
+	{
+		int idx = _stmts.size() - 1;
+		if(pos != NIL)
+			_compact = false;
+		int prev = pos == NIL? _tail : _prev[pos];
+		_prev.push_back(prev);
+		_next.push_back(pos);
+		if(prev == NIL)
+			_head = idx;
+		else
+			_next[prev] = idx;
+		if(pos == NIL)
+			_tail = idx;
+		else
+			_prev[pos] = idx;
+		++_size;
+		return idx;
+	}
+
+	template<class List, class Ref>
+	class Iterator
+	{
+	  protected:
+		List *_list;
+		int _idx; // NIL for end().
+
+	  public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::remove_reference_t<Ref> *;
+		using reference = Ref;
+
+		Iterator(): _list(nullptr), _idx(NIL) {}
+		Iterator(List *list, int idx): _list(list), _idx(idx) {}
+		// iterator -> const_iterator
+		template<class OtherList, class OtherRef>
+		Iterator(const Iterator<OtherList, OtherRef> &other)
+		  : _list(other.list()), _idx(other.idx()) {}
+
+		inline List *list() const { return _list; }
+		inline int idx() const { return _idx; }
+
+		inline Ref operator * () const { return _list->_stmts[_idx]; }
+		inline pointer operator -> () const { return &_list->_stmts[_idx]; }
+		inline Iterator &operator ++ () { _idx = _list->_next[_idx]; return *this; }
+		inline Iterator &operator -- ()
+		{
+			_idx = _idx == NIL? _list->_tail : _list->_prev[_idx];
+			return *this;
+		}
+		inline Iterator operator ++ (int) { Iterator res = *this; ++*this; return res; }
+		inline Iterator operator -- (int) { Iterator res = *this; --*this; return res; }
+		inline bool operator == (const Iterator &other) const { return _idx == other._idx; }
+		inline bool operator != (const Iterator &other) const { return _idx != other._idx; }
+	};
+
+  public:
+	using value_type = T;
+	using iterator = Iterator<StmtList, T &>;
+	using const_iterator = Iterator<const StmtList, const T &>;
+
+	StmtList(): _head(NIL), _tail(NIL), _size(0), _compact(true) {}
+
+	inline int size() const { return _size; }
+	inline bool empty() const { return _size == 0; }
+	inline bool is_compact() const { return _compact; }
+
+	inline iterator begin() { return iterator(this, _head); }
+	inline iterator end() { return iterator(this, NIL); }
+	inline const_iterator begin() const { return const_iterator(this, _head); }
+	inline const_iterator end() const { return const_iterator(this, NIL); }
+	inline const_iterator cbegin() const { return begin(); }
+	inline const_iterator cend() const { return end(); }
+	inline T &front() { return _stmts[_head]; }
+	inline T &back() { return _stmts[_tail]; }
+	inline const T &front() const { return _stmts[_head]; }
+	inline const T &back() const { return _stmts[_tail]; }
+
+	// Access by statement id, only valid if the list is compact.
+	inline const T &operator [] (int id) const { return _stmts[id]; }
+	inline T &operator [] (int id) { return _stmts[id]; }
+	inline int id_of(const_iterator iter) const
+	{
+		INTERNAL_ASSERT(is_compact(), "statement id of a non-compact list");
+		return iter.idx() == NIL? _size : iter.idx();
+	}
+
+	void reserve(size_t size)
+	{
+		_stmts.reserve(size);
+		_prev.reserve(size);
+		_next.reserve(size);
+	}
+
+	void clear()
+	{
+		_stmts.clear();
+		_prev.clear();
+		_next.clear();
+		_head = _tail = NIL;
+		_size = 0;
+		_compact = true;
+	}
+
+	template<class... Ts>
+	inline T &emplace_back(Ts&&... ts)
+	{
+		_stmts.emplace_back(std::forward<Ts>(ts)...);
+		return _stmts[_link_before(NIL)];
+	}
+	inline void push_back(const T &stmt) { emplace_back(stmt); }
+	inline void push_back(T &&stmt) { emplace_back(std::move(stmt)); }
+
+	// Inserts a statement before pos, returns the iterator of it.
+	template<class... Ts>
+	iterator emplace(const_iterator pos, Ts&&... ts)
+	{
+		_stmts.emplace_back(std::forward<Ts>(ts)...);
+		return iterator(this, _link_before(pos.idx()));
+	}
+	inline iterator insert(const_iterator pos, const T &stmt) { return emplace(pos, stmt); }
+	inline iterator insert(const_iterator pos, T &&stmt) { return emplace(pos, std::move(stmt)); }
+
+	// Unlinks the statement at pos, returns the iterator of the next one.
+	iterator erase(const_iterator pos)
+	{
+		int idx = pos.idx();
+		INTERNAL_ASSERT(idx >= 0 && _next[idx] != DEAD, "erasing an invalid statement");
+		int prev = _prev[idx], next = _next[idx];
+		if(prev == NIL)
+			_head = next;
+		else
+			_next[prev] = next;
+		if(next == NIL)
+			_tail = prev;
+		else
+			_prev[next] = prev;
+		_prev[idx] = _next[idx] = DEAD;
+		--_size;
+		_compact = false;
+		return iterator(this, next);
+	}
+
+	// Moves all the statements of other before pos.
+	void splice(const_iterator pos, StmtList &other)
+	{
+		for(auto &stmt : other)
+			emplace(pos, std::move(stmt));
+		other.clear();
+	}
+
+	// Stores the statements in order and drops the tombstones, so that
+	// statement ids are dense again. Invalidates all the iterators.
+	void compact()
+	{
+		if(_compact)
+			return;
+		std::vector<T> stmts;
+		stmts.reserve(_size);
+		for(int idx = _head; idx != NIL; idx = _next[idx])
+			stmts.push_back(std::move(_stmts[idx]));
+		_stmts = std::move(stmts);
+		_prev.resize(_size);
+		_next.resize(_size);
+		for(int i = 0; i < _size; i++)
+		{
+			_prev[i] = i - 1;
+			_next[i] = i + 1 == _size? NIL : i + 1;
+		}
+		_head = _size == 0? NIL : 0;
+		_tail = _size - 1;
+		_compact = true;
+	}
+};
+
+} // namespace compiler::utils
+
+#endif
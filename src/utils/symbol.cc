@@ -0,0 +1,44 @@
+#include "symbol.h"
+#include "exceptions.h"
+
+namespace compiler::utils
+{
+
+Interner::Interner(): _size(0)
+{
+	intern(""); // Id 0, the default symbol.
+}
+
+uint32_t Interner::intern(std::string_view str)
+{
+	// Identifiers repeat a lot in a program, so most of them are found here
+	// without locking. The keys point to the strings stored in _chunks.
+	thread_local std::unordered_map<std::string_view, uint32_t> cache;
+	auto cache_iter = cache.find(str);
+	if(cache_iter != cache.end())
+		return cache_iter->second;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto iter = _id_of_str.find(str);
+	if(iter == _id_of_str.end())
+	{
+		uint32_t id = _size;
+		INTERNAL_ASSERT((id >> CHUNK_BITS) < MAX_CHUNK_CNT, "too many symbols");
+		auto &chunk = _chunks[id >> CHUNK_BITS];
+		if(chunk == nullptr)
+			chunk.reset(new std::string[CHUNK_SIZE]);
+		chunk[id & (CHUNK_SIZE - 1)] = str;
+		iter = _id_of_str.emplace(chunk[id & (CHUNK_SIZE - 1)], id).first;
+		_size++;
+	}
+	cache.emplace(iter->first, iter->second);
+	return iter->second;
+}
+
+Interner &Interner::global()
+{
+	static Interner interner;
+	return interner;
+}
+
+} // namespace compiler::utils
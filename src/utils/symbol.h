@@ -0,0 +1,82 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "output_writer.h"
+
+namespace compiler::utils
+{
+
+// Stores each distinct string once, and numbers them densely from 0 in the
+// order they are interned. It is shared by all the threads: interning is
+// serialized by a mutex (behind a per-thread cache of the strings seen), and
+// the stored strings never move, so str() is lock-free.
+class Interner
+{
+  public:
+	static constexpr int CHUNK_BITS = 12;
+	static constexpr uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+	static constexpr int MAX_CHUNK_CNT = 1 << 12;
+
+  protected:
+	// The chunk table is never resized, so it is safe to read a chunk while
+	// another one is being added.
+	std::unique_ptr<std::string[]> _chunks[MAX_CHUNK_CNT];
+	uint32_t _size;
+	std::unordered_map<std::string_view, uint32_t> _id_of_str;
+	std::mutex _mutex;
+
+	Interner();
+
+  public:
+	Interner(const Interner &other) = delete;
+	Interner &operator = (const Interner &other) = delete;
+
+	uint32_t intern(std::string_view str);
+	inline const std::string &str(uint32_t id) const
+		{ return _chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)]; }
+
+	static Interner &global();
+};
+
+// An interned identifier. The lexer interns every identifier once, so the
+// later stages compare and hash the 32-bit ids instead of the strings.
+class Symbol
+{
+  protected:
+	uint32_t _id;
+
+  public:
+	Symbol(): _id(0) {} // The empty string, which is always interned first.
+	explicit Symbol(std::string_view str): _id(Interner::global().intern(str)) {}
+
+	inline uint32_t id() const { return _id; }
+	inline const std::string &str() const { return Interner::global().str(_id); }
+
+	inline bool operator == (Symbol other) const { return _id == other._id; }
+	inline bool operator != (Symbol other) const { return _id != other._id; }
+
+	// Friends only found by ADL, so that they do not hide the operators of
+	// the enclosing namespaces.
+	friend inline OutputWriter &operator << (OutputWriter &out, Symbol sym)
+		{ return out << sym.str(); }
+	friend inline std::ostream &operator << (std::ostream &out, Symbol sym)
+		{ return out << sym.str(); }
+};
+
+} // namespace compiler::utils
+
+template<>
+struct std::hash<compiler::utils::Symbol>
+{
+	inline size_t operator () (compiler::utils::Symbol sym) const { return sym.id(); }
+};
+
+#endif
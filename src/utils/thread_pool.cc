@@ -0,0 +1,94 @@
+#include <utility>
+#include "thread_pool.h"
+
+namespace compiler::utils
+{
+
+ThreadPool::ThreadPool(int thread_cnt)
+  : _loop_id(0), _stopping(false), _body(nullptr), _iter_cnt(0), _next_iter(0), _busy_cnt(0)
+{
+	for(int i = 1; i < thread_cnt; i++)
+		_workers.emplace_back(&ThreadPool::_run_worker, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_start_cv.notify_all();
+	for(auto &worker : _workers)
+		worker.join();
+}
+
+void ThreadPool::_run_iters()
+{
+	for(int i = _next_iter++; i < _iter_cnt; i = _next_iter++)
+	{
+		try
+		{
+			(*_body)(i);
+		}
+		catch(...)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_error == nullptr)
+				_error = std::current_exception();
+		}
+	}
+}
+
+void ThreadPool::_run_worker()
+{
+	uint64_t last_loop_id = 0;
+	while(true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_start_cv.wait(lock, [&]() { return _stopping || _loop_id != last_loop_id; });
+			if(_stopping)
+				return;
+			last_loop_id = _loop_id;
+		}
+
+		{
+			TimePathScope time_scope(_time_path);
+			_run_iters();
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if(--_busy_cnt == 0)
+			_done_cv.notify_one();
+	}
+}
+
+void ThreadPool::parallel_for(int iter_cnt, const std::function<void(int)> &body)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_body = &body;
+		_iter_cnt = iter_cnt;
+		_next_iter = 0;
+		_busy_cnt = _workers.size();
+		_error = nullptr;
+		_time_path = TimeReport::current_path();
+		_loop_id++;
+	}
+	_start_cv.notify_all();
+
+	_run_iters();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_done_cv.wait(lock, [&]() { return _busy_cnt == 0; });
+	if(_error != nullptr)
+		std::rethrow_exception(std::exchange(_error, nullptr));
+}
+
+int ThreadPool::default_thread_cnt()
+{
+	int cnt = std::thread::hardware_concurrency();
+	return cnt > 0? cnt : 1;
+}
+
+} // namespace compiler::utils
@@ -0,0 +1,63 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "time_report.h"
+
+namespace compiler::utils
+{
+
+// A fixed set of worker threads running parallel loops. The calling thread
+// also runs iterations, so a pool of n threads has n - 1 workers, and a pool
+// of 1 thread runs everything in the caller.
+class ThreadPool
+{
+  protected:
+	std::vector<std::thread> _workers;
+
+	std::mutex _mutex;
+	std::condition_variable _start_cv;
+	std::condition_variable _done_cv;
+	uint64_t _loop_id; // Increased for every loop, to wake up the workers.
+	bool _stopping;
+
+	// The running loop.
+	const std::function<void(int)> *_body;
+	int _iter_cnt;
+	std::atomic<int> _next_iter;
+	int _busy_cnt; // The workers that have not finished the loop.
+	std::exception_ptr _error; // The first exception thrown by the body.
+	TimeReport::Path _time_path; // The time scope of the caller, also used by the workers.
+
+	void _run_iters();
+	void _run_worker();
+
+  public:
+	explicit ThreadPool(int thread_cnt);
+	ThreadPool(const ThreadPool &other) = delete;
+	ThreadPool &operator = (const ThreadPool &other) = delete;
+	~ThreadPool();
+
+	inline int thread_cnt() const { return _workers.size() + 1; }
+
+	// Runs body(0), ..., body(iter_cnt - 1) on all the threads, and returns
+	// when all of them are finished. Iterations are handed out one by one in
+	// increasing order. If any of them throws, the first exception is
+	// rethrown here after the loop. Must not be called by the body itself.
+	// The time scopes of the body are reported under the scope of the caller.
+	void parallel_for(int iter_cnt, const std::function<void(int)> &body);
+
+	// The number of hardware threads, at least 1.
+	static int default_thread_cnt();
+};
+
+} // namespace compiler::utils
+
+#endif
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include "time_report.h"
+
+namespace
+{
+
+double thread_cpu_sec()
+{
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+using Node = compiler::utils::TimeReport::Node;
+
+void merge_into(Node &dst, const Node &src)
+{
+	for(const auto &[name, value] : src.sizes)
+		dst.add_size(name, value);
+	for(const auto &src_child : src.children)
+	{
+		Node *dst_child = dst.child(src_child->name);
+		dst_child->count += src_child->count;
+		dst_child->wall_sec += src_child->wall_sec;
+		dst_child->cpu_sec += src_child->cpu_sec;
+		dst_child->alloc_cnt += src_child->alloc_cnt;
+		dst_child->alloc_bytes += src_child->alloc_bytes;
+		dst_child->live_bytes += src_child->live_bytes;
+		dst_child->peak_live_bytes = std::max(dst_child->peak_live_bytes, src_child->peak_live_bytes);
+		dst_child->peak_rss_bytes = std::max(dst_child->peak_rss_bytes, src_child->peak_rss_bytes);
+		merge_into(*dst_child, *src_child);
+	}
+}
+
+inline int64_t to_kib(int64_t bytes)
+{
+	return bytes / 1024;
+}
+
+// Prints the phases under node as the rows of the table. The allocation
+// columns are printed only if allocs, and the rss column only if mem.
+void print_node(std::ostream &out, const Node &node, int depth, bool mem, bool allocs)
+{
+	for(const auto &[name, value] : node.sizes)
+		out << std::string(depth * 2, ' ') << "- " << name << ": " << value << '\n';
+	for(const auto &child : node.children)
+	{
+		out << std::string(depth * 2, ' ') << std::left << std::setw(40 - depth * 2) << child->name
+			<< std::right << std::setw(8) << child->count
+			<< std::setw(12) << child->wall_sec
+			<< std::setw(12) << child->cpu_sec;
+		if(allocs)
+			out << std::setw(10) << child->alloc_cnt
+				<< std::setw(14) << to_kib(child->alloc_bytes)
+				<< std::setw(14) << to_kib(child->live_bytes)
+				<< std::setw(14) << to_kib(child->peak_live_bytes);
+		if(mem)
+			out << std::setw(14) << to_kib(child->peak_rss_bytes);
+		out << '\n';
+		print_node(out, *child, depth + 1, mem, allocs);
+	}
+}
+
+void print_sizes_json(std::ostream &out, const Node &node)
+{
+	out << '{';
+	for(size_t i = 0; i < node.sizes.size(); i++)
+		out << (i == 0? "" : ", ") << '"' << node.sizes[i].first << "\": " << node.sizes[i].second;
+	out << '}';
+}
+
+void print_node_json(std::ostream &out, const Node &node, bool mem)
+{
+	out << '[';
+	for(size_t i = 0; i < node.children.size(); i++)
+	{
+		const Node &child = *node.children[i];
+		if(i != 0)
+			out << ", ";
+		out << "{\"name\": \"" << child.name << "\", \"count\": " << child.count
+			<< ", \"wall_sec\": " << child.wall_sec << ", \"cpu_sec\": " << child.cpu_sec;
+		if(mem)
+			out << ", \"allocs\": " << child.alloc_cnt << ", \"alloc_bytes\": " << child.alloc_bytes
+				<< ", \"live_bytes\": " << child.live_bytes
+				<< ", \"peak_live_bytes\": " << child.peak_live_bytes
+				<< ", \"peak_rss_bytes\": " << child.peak_rss_bytes;
+		out << ", \"sizes\": ";
+		print_sizes_json(out, child);
+		out << ", \"children\": ";
+		print_node_json(out, child, mem);
+		out << '}';
+	}
+	out << ']';
+}
+
+} // namespace
+
+namespace compiler::utils
+{
+
+TimeReport::Node *TimeReport::Node::child(const char *child_name)
+{
+	for(const auto &node : children)
+		if(node->name == child_name || std::strcmp(node->name, child_name) == 0)
+			return node.get();
+	children.push_back(std::make_unique<Node>(child_name, this));
+	return children.back().get();
+}
+
+void TimeReport::Node::add_size(const char *size_name, uint64_t value)
+{
+	for(auto &size : sizes)
+		if(size.first == size_name || std::strcmp(size.first, size_name) == 0)
+		{
+			size.second += value;
+			return;
+		}
+	sizes.emplace_back(size_name, value);
+}
+
+TimeReport &TimeReport::global()
+{
+	static TimeReport report;
+	return report;
+}
+
+TimeReport::Node *&TimeReport::current()
+{
+	thread_local Node *node = nullptr;
+	if(node == nullptr)
+	{
+		// The roots are owned by the report, since a worker thread may exit
+		// before the report is printed.
+		TimeReport &report = global();
+		std::lock_guard<std::mutex> lock(report._mutex);
+		report._thread_roots.push_back(std::make_unique<Node>("total", nullptr));
+		node = report._thread_roots.back().get();
+	}
+	return node;
+}
+
+TimeReport::Path TimeReport::current_path()
+{
+	Path path;
+	if(!enabled())
+		return path;
+	for(Node *node = current(); node->parent != nullptr; node = node->parent)
+		path.push_back(node->name);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+TimeReport::Node TimeReport::_merge()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Node root("total", nullptr);
+	for(const auto &thread_root : _thread_roots)
+		merge_into(root, *thread_root);
+	return root;
+}
+
+void TimeReport::print(std::ostream &out)
+{
+	Node root = _merge();
+	bool allocs = _mem_enabled && alloc_counting_enabled();
+	auto flags = out.flags();
+	out << std::fixed << std::setprecision(6);
+	out << std::left << std::setw(40) << "phase" << std::right << std::setw(8) << "count"
+		<< std::setw(12) << "wall(s)" << std::setw(12) << "cpu(s)";
+	if(allocs)
+		out << std::setw(10) << "allocs" << std::setw(14) << "alloc(KiB)"
+			<< std::setw(14) << "live(KiB)" << std::setw(14) << "peak(KiB)";
+	if(_mem_enabled)
+		out << std::setw(14) << "rss(KiB)";
+	out << '\n';
+	print_node(out, root, 0, _mem_enabled, allocs);
+	if(_mem_enabled && !alloc_counting_enabled())
+		out << "(allocations are not counted, build with MEM_REPORT=1)\n";
+	out.flags(flags);
+}
+
+void TimeReport::print_json(std::ostream &out)
+{
+	Node root = _merge();
+	auto flags = out.flags();
+	out << std::fixed << std::setprecision(9);
+	out << "{\"alloc_counting\": " << (_mem_enabled && alloc_counting_enabled()? "true" : "false")
+		<< ", \"sizes\": ";
+	print_sizes_json(out, root);
+	out << ", \"phases\": ";
+	print_node_json(out, root, _mem_enabled);
+	out << "}\n";
+	out.flags(flags);
+}
+
+void TimeScope::_start(const char *name)
+{
+	auto &current = TimeReport::current();
+	_node = current->child(name);
+	current = _node;
+	if(TimeReport::mem_enabled())
+	{
+		// Lower the peak, to find the peak inside this scope. The outer one
+		// is restored when the scope stops.
+		auto &counters = thread_alloc_counters();
+		_alloc_start = counters;
+		counters.peak_live_bytes = counters.live_bytes;
+	}
+	_wall_start = std::chrono::steady_clock::now();
+	_cpu_start = thread_cpu_sec();
+}
+
+void TimeScope::_stop()
+{
+	_node->cpu_sec += thread_cpu_sec() - _cpu_start;
+	_node->wall_sec += std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - _wall_start).count();
+	_node->count++;
+	if(TimeReport::mem_enabled())
+	{
+		auto &counters = thread_alloc_counters();
+		_node->alloc_cnt += counters.alloc_cnt - _alloc_start.alloc_cnt;
+		_node->alloc_bytes += counters.alloc_bytes - _alloc_start.alloc_bytes;
+		_node->live_bytes += counters.live_bytes - _alloc_start.live_bytes;
+		_node->peak_live_bytes = std::max(_node->peak_live_bytes,
+			counters.peak_live_bytes - _alloc_start.live_bytes);
+		_node->peak_rss_bytes = std::max(_node->peak_rss_bytes, peak_rss_bytes());
+		counters.peak_live_bytes = std::max(counters.peak_live_bytes,
+			_alloc_start.peak_live_bytes);
+	}
+	TimeReport::current() = _node->parent;
+}
+
+TimePathScope::TimePathScope(const TimeReport::Path &path): _saved(nullptr)
+{
+	if(!TimeReport::enabled())
+		return;
+	auto &current = TimeReport::current();
+	_saved = current;
+	TimeReport::Node *node = current;
+	while(node->parent != nullptr)
+		node = node->parent;
+	for(const char *name : path)
+		node = node->child(name);
+	current = node;
+}
+
+TimePathScope::~TimePathScope()
+{
+	if(_saved != nullptr)
+		TimeReport::current() = _saved;
+}
+
+} // namespace compiler::utils
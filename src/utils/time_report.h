@@ -0,0 +1,141 @@
+#ifndef TIME_REPORT_H
+#define TIME_REPORT_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "mem_report.h"
+
+namespace compiler::utils
+{
+
+// Wall and CPU time of the compiler phases, like gcc's -ftime-report. The
+// phases are TimeScopes, which nest into a tree by their names. Each thread
+// records into its own tree without locking, and the trees are merged by
+// the scope names when reported, so the times of a phase run on several
+// threads are summed.
+// With memory enabled (-fmem-report), each phase also records the counters
+// of mem_report.h and the peak RSS, and the phases can report the sizes of
+// their data structures.
+// Disabled by default, in which case a TimeScope only checks a flag.
+class TimeReport
+{
+  public:
+	struct Node
+	{
+		const char *name; // Must be a string literal.
+		Node *parent;
+		int count; // Times the scope is entered.
+		double wall_sec;
+		double cpu_sec;
+
+		// Memory, only recorded if enabled. Peaks are the maxima over all
+		// the runs, the others are summed.
+		uint64_t alloc_cnt;
+		uint64_t alloc_bytes;
+		int64_t live_bytes; // Allocated but not freed in the scope.
+		int64_t peak_live_bytes; // The peak of live bytes above the start.
+		size_t peak_rss_bytes; // The peak RSS of the process at the end.
+		std::vector<std::pair<const char *, uint64_t>> sizes; // Summed by name.
+
+		std::vector<std::unique_ptr<Node>> children; // In the order of creation.
+
+		Node(const char *_name, Node *_parent)
+		  : name(_name), parent(_parent), count(0), wall_sec(0), cpu_sec(0),
+			alloc_cnt(0), alloc_bytes(0), live_bytes(0), peak_live_bytes(0),
+			peak_rss_bytes(0) {}
+
+		Node *child(const char *child_name);
+		void add_size(const char *size_name, uint64_t value);
+	};
+
+	// The names of the scopes from the outermost one to the current one.
+	using Path = std::vector<const char *>;
+
+  protected:
+	inline static bool _enabled = false;
+	inline static bool _mem_enabled = false;
+
+	std::mutex _mutex;
+	std::vector<std::unique_ptr<Node>> _thread_roots;
+
+	TimeReport() = default;
+	Node _merge();
+
+  public:
+	TimeReport(const TimeReport &other) = delete;
+	TimeReport &operator = (const TimeReport &other) = delete;
+
+	// Must be called before any scope is entered.
+	static inline void enable() { _enabled = true; }
+	static inline void enable_mem() { _enabled = _mem_enabled = true; }
+	static inline bool enabled() { return _enabled; }
+	static inline bool mem_enabled() { return _mem_enabled; }
+	static TimeReport &global();
+
+	// Adds to a size of the data structures (e.g. statement count) of the
+	// innermost scope of this thread.
+	static inline void add_size(const char *name, uint64_t value)
+	{
+		if(_enabled)
+			current()->add_size(name, value);
+	}
+
+	// The innermost scope of this thread, which is a root if there is none.
+	static Node *&current();
+	static Path current_path();
+
+	// Must be called when no scope is running on any thread.
+	void print(std::ostream &out);
+	void print_json(std::ostream &out);
+};
+
+// Times the enclosing block as a child of the innermost scope of this thread.
+class TimeScope
+{
+  protected:
+	TimeReport::Node *_node;
+	std::chrono::steady_clock::time_point _wall_start;
+	double _cpu_start;
+	AllocCounters _alloc_start;
+
+	void _start(const char *name);
+	void _stop();
+
+  public:
+	explicit TimeScope(const char *name): _node(nullptr)
+	{
+		if(TimeReport::enabled())
+			_start(name);
+	}
+	TimeScope(const TimeScope &other) = delete;
+	TimeScope &operator = (const TimeScope &other) = delete;
+	~TimeScope()
+	{
+		if(_node != nullptr)
+			_stop();
+	}
+};
+
+// Makes the scopes of this thread children of a path taken from another
+// thread, so that the work handed to a worker is reported under the scope
+// that started it.
+class TimePathScope
+{
+  protected:
+	TimeReport::Node *_saved;
+
+  public:
+	explicit TimePathScope(const TimeReport::Path &path);
+	TimePathScope(const TimePathScope &other) = delete;
+	TimePathScope &operator = (const TimePathScope &other) = delete;
+	~TimePathScope();
+};
+
+} // namespace compiler::utils
+
+#endif